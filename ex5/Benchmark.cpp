@@ -0,0 +1,755 @@
+
+// ------------------------------ includes ------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include "Matrix.h"
+#include "MatrixIO.h"
+#include "MatrixMultiply.h"
+#include "Filters.h"
+#include "FilterPipeline.h"
+#include "FrameStream.h"
+#include "ParallelFor.h"
+
+// ------------------------------ const & macros -----------------------------
+
+/**
+ * usage message
+ */
+#define BENCH_USAGE \
+    "Usage: benchmark [--json FILE] [--quick] [--only NAME] [--max-size N] [--max-matmul N]\n" \
+    "       benchmark --compare BASE.json NEW.json [--threshold PERCENT]\n" \
+    "       benchmark --check-multiply\n"
+/**
+ * error - a results file could not be read
+ */
+#define BENCH_CANNOT_READ "Cannot read benchmark results: "
+/**
+ * smallest image / matrix edge benchmarked
+ */
+#define BENCH_MIN_SIZE 64
+/**
+ * default largest image edge (filters, element-wise ops, copies)
+ */
+#define BENCH_MAX_SIZE 8192
+/**
+ * default largest matrix multiplication edge (an 8192 multiplication takes minutes)
+ */
+#define BENCH_MAX_MATMUL 2048
+/**
+ * largest edge for text stream io (text is ~10 bytes per element)
+ */
+#define BENCH_MAX_TEXT_IO 2048
+/**
+ * every benchmark repeats until it ran this long (seconds)...
+ */
+#define BENCH_MIN_SECONDS 0.3
+/**
+ * ...or this many times, and always at least BENCH_MIN_REPS times
+ */
+#define BENCH_MAX_REPS 50
+/**
+ * see BENCH_MAX_REPS
+ */
+#define BENCH_MIN_REPS 3
+/**
+ * --quick: shorter runs, sizes up to this edge
+ */
+#define BENCH_QUICK_MAX_SIZE 1024
+/**
+ * default slowdown (percent) reported as a regression by --compare
+ */
+#define BENCH_DEFAULT_THRESHOLD 5.0
+/**
+ * float unit roundoff, for the multiply() error bounds
+ */
+#define FLOAT_UNIT_ROUNDOFF 5.9604644775390625e-8
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * one measurement
+ */
+struct BenchResult
+{
+    std::string name;
+    int size;
+    /**
+     * median seconds per run
+     */
+    double seconds;
+    /**
+     * floating point operations per run (0 - not reported)
+     */
+    double flops;
+    /**
+     * pixels per run (0 - not reported)
+     */
+    double pixels;
+    /**
+     * bytes read and written per run (the compulsory traffic)
+     */
+    double bytes;
+};
+
+/**
+ * options of a run
+ */
+struct BenchOptions
+{
+    std::string only;
+    int maxSize = BENCH_MAX_SIZE;
+    int maxMatmul = BENCH_MAX_MATMUL;
+    double minSeconds = BENCH_MIN_SECONDS;
+};
+
+/**
+ * results are read back so the work can not be optimized away
+ */
+static volatile float benchSink;
+
+/**
+ * median seconds of body(), run until minSeconds passed (after one warm up run)
+ * @param body
+ * @param minSeconds
+ * @return
+ */
+static double timeMedian(const std::function<void()> &body, double minSeconds)
+{
+    typedef std::chrono::steady_clock Clock;
+    body();
+    std::vector<double> samples;
+    double total = 0;
+    while (samples.size() < BENCH_MIN_REPS || (total < minSeconds && samples.size() < BENCH_MAX_REPS))
+    {
+        Clock::time_point start = Clock::now();
+        body();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        samples.push_back(seconds);
+        total += seconds;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+/**
+ * matrix of uniform random values in [low, high)
+ */
+template<typename T>
+static BasicMatrix<T> randomMatrix(int rows, int cols, float low, float high, std::mt19937 &gen)
+{
+    std::uniform_real_distribution<float> dist(low, high);
+    BasicMatrix<T> m(rows, cols, MatrixInit::Uninitialized);
+    for (int i = 0; i < rows; ++i)
+    {
+        T *row = m.row_ptr(i);
+        for (int j = 0; j < cols; ++j)
+        {
+            row[j] = static_cast<T>(dist(gen));
+        }
+    }
+    return m;
+}
+
+/**
+ * @return the edges BENCH_MIN_SIZE, 2 * BENCH_MIN_SIZE ... up to max
+ */
+static std::vector<int> sizesUpTo(int max)
+{
+    std::vector<int> sizes;
+    for (int n = BENCH_MIN_SIZE; n <= max; n *= 2)
+    {
+        sizes.push_back(n);
+    }
+    return sizes;
+}
+
+/**
+ * prints one result as a table row
+ */
+static void printResult(const BenchResult &r)
+{
+    std::cout << std::left << std::setw(20) << r.name << std::right << std::setw(6) << r.size
+              << std::setw(14) << std::scientific << std::setprecision(3) << r.seconds << std::fixed
+              << std::setprecision(2);
+    std::cout << std::setw(10) << (r.flops > 0 ? r.flops / r.seconds * 1e-9 : 0.0);
+    std::cout << std::setw(12) << (r.pixels > 0 ? r.pixels / r.seconds * 1e-6 : 0.0);
+    std::cout << std::setw(10) << r.bytes / r.seconds * 1e-9 << std::endl;
+}
+
+/**
+ * all the benchmarks, in run order
+ */
+class BenchSuite
+{
+private:
+
+    BenchOptions _options;
+    std::vector<BenchResult> _results;
+    std::mt19937 _gen;
+
+    /**
+     * times body and records the result (if name passes --only)
+     */
+    void _run(const std::string &name, int size, double flops, double pixels, double bytes,
+              const std::function<void()> &body)
+    {
+        if (!_options.only.empty() && name.find(_options.only) == std::string::npos)
+        {
+            return;
+        }
+        BenchResult r{name, size, timeMedian(body, _options.minSeconds), flops, pixels, bytes};
+        printResult(r);
+        _results.push_back(r);
+    }
+
+    /**
+     * true if some benchmark of the group would run
+     */
+    bool _wanted(const std::vector<std::string> &names) const
+    {
+        return _options.only.empty() || std::any_of(names.begin(), names.end(), [this](const std::string &n)
+        {
+            return n.find(_options.only) != std::string::npos;
+        });
+    }
+
+public:
+    /**
+     * Constructor
+     * @param options
+     */
+    explicit BenchSuite(const BenchOptions &options) : _options(options), _gen(2024)
+    {
+    }
+
+    /**
+     * Matrix::operator* - GFLOPS vs size
+     */
+    void multiplication()
+    {
+        for (int n : sizesUpTo(std::min(_options.maxSize, _options.maxMatmul)))
+        {
+            if (!_wanted({"matmul"}))
+            {
+                return;
+            }
+            Matrix a = randomMatrix<float>(n, n, -1, 1, _gen), b = randomMatrix<float>(n, n, -1, 1, _gen);
+            double n2 = static_cast<double>(n) * n;
+            _run("matmul", n, 2 * n2 * n, 0, 3 * n2 * sizeof(float), [&]()
+            {
+                benchSink = (a * b)(0, 0);
+            });
+        }
+    }
+
+    /**
+     * element-wise operators, copy construction and assignment
+     */
+    void elementWise()
+    {
+        for (int n : sizesUpTo(_options.maxSize))
+        {
+            if (!_wanted({"add", "scalar_mul", "add_assign", "copy", "assign"}))
+            {
+                return;
+            }
+            Matrix a = randomMatrix<float>(n, n, -1, 1, _gen), b = randomMatrix<float>(n, n, -1, 1, _gen);
+            Matrix c(n, n);
+            double n2 = static_cast<double>(n) * n, bytes = n2 * sizeof(float);
+            _run("add", n, n2, 0, 3 * bytes, [&]()
+            {
+                benchSink = (a + b)(0, 0);
+            });
+            _run("scalar_mul", n, n2, 0, 2 * bytes, [&]()
+            {
+                benchSink = (a * 1.5f)(0, 0);
+            });
+            _run("add_assign", n, n2, 0, 3 * bytes, [&]()
+            {
+                c += b;
+                benchSink = c(0, 0);
+            });
+            _run("copy", n, 0, 0, 2 * bytes, [&]()
+            {
+                Matrix copy(a);
+                benchSink = copy(0, 0);
+            });
+            _run("assign", n, 0, 0, 2 * bytes, [&]()
+            {
+                c = a;
+                benchSink = c(0, 0);
+            });
+        }
+    }
+
+    /**
+     * operator<< / operator>> (text) and the binary format, through string streams
+     */
+    void streamIO()
+    {
+        for (int n : sizesUpTo(_options.maxSize))
+        {
+            if (!_wanted({"text_write", "text_read", "binary_write", "binary_read"}))
+            {
+                return;
+            }
+            Matrix a = randomMatrix<float>(n, n, 0, 255, _gen);
+            double n2 = static_cast<double>(n) * n;
+            if (n <= BENCH_MAX_TEXT_IO)
+            {
+                std::ostringstream text;
+                text << a;
+                std::string written = text.str();
+                _run("text_write", n, 0, n2, static_cast<double>(written.size()), [&]()
+                {
+                    std::ostringstream os;
+                    os << a;
+                    benchSink = static_cast<float>(os.tellp());
+                });
+                _run("text_read", n, 0, n2, static_cast<double>(written.size()), [&]()
+                {
+                    std::istringstream is(written);
+                    Matrix m(n, n, MatrixInit::Uninitialized);
+                    is >> m;
+                    benchSink = m(0, 0);
+                });
+            }
+            std::ostringstream binary;
+            writeBinary(binary, a);
+            std::string written = binary.str();
+            _run("binary_write", n, 0, n2, static_cast<double>(written.size()), [&]()
+            {
+                std::ostringstream os;
+                writeBinary(os, a);
+                benchSink = static_cast<float>(os.tellp());
+            });
+            _run("binary_read", n, 0, n2, static_cast<double>(written.size()), [&]()
+            {
+                std::istringstream is(written);
+                benchSink = readBinary<float>(is)(0, 0);
+            });
+        }
+    }
+
+    /**
+     * blur, sobel, quantization, a 5x5 convolution, 51x51 mean / variance filters, 15x15
+     * erosion / median and pyramid / resize halving on float and 8 bit images, and the blur ->
+     * sobel -> quantization chain as separate calls, as a FilterPipeline and streamed through a
+     * FrameStream (binary frames in and out of memory) - MPixel/s
+     */
+    void filters()
+    {
+        Matrix kernel(5, 5);
+        for (int i = 0; i < 5; ++i)
+        {
+            for (int j = 0; j < 5; ++j)
+            {
+                kernel(i, j) = 1.0f / 25;
+            }
+        }
+        FilterPipeline pipeline;
+        pipeline.blur().sobel().quantization(8);
+        for (int n : sizesUpTo(_options.maxSize))
+        {
+            if (!_wanted({"blur", "sobel", "quantization", "convolution5", "chain", "pipeline", "stream", "mean51",
+                           "variance51", "erode15", "median15", "pyramid_down", "resize"}))
+            {
+                return;
+            }
+            Matrix image = randomMatrix<float>(n, n, 0, 255, _gen);
+            ByteMatrix bytes = randomMatrix<uint8_t>(n, n, 0, 255, _gen);
+            double px = static_cast<double>(n) * n;
+            // 3x3 filters read each pixel once from cache and write once
+            _run("blur", n, 18 * px, px, 2 * px * sizeof(float), [&]()
+            {
+                benchSink = blur(image)(0, 0);
+            });
+            _run("blur_u8", n, 18 * px, px, 2 * px, [&]()
+            {
+                benchSink = blur(bytes)(0, 0);
+            });
+            _run("sobel", n, 36 * px, px, 2 * px * sizeof(float), [&]()
+            {
+                benchSink = sobel(image)(0, 0);
+            });
+            _run("sobel_u8", n, 36 * px, px, 2 * px, [&]()
+            {
+                benchSink = sobel(bytes)(0, 0);
+            });
+            _run("quantization", n, 0, px, 2 * px * sizeof(float), [&]()
+            {
+                benchSink = quantization(image, 8)(0, 0);
+            });
+            _run("quantization_u8", n, 0, px, 2 * px, [&]()
+            {
+                benchSink = quantization(bytes, 8)(0, 0);
+            });
+            _run("convolution5", n, 50 * px, px, 2 * px * sizeof(float), [&]()
+            {
+                benchSink = convolution(image, kernel)(0, 0);
+            });
+            _run("convolution5_u8", n, 50 * px, px, 2 * px, [&]()
+            {
+                benchSink = convolution(bytes, kernel)(0, 0);
+            });
+            // integral images: O(1) per pixel whatever the window
+            _run("mean51_u8", n, 4 * px, px, 2 * px * sizeof(double), [&]()
+            {
+                benchSink = meanFilter(bytes, 51, 51)(0, 0);
+            });
+            _run("variance51_u8", n, 12 * px, px, 4 * px * sizeof(double), [&]()
+            {
+                benchSink = varianceFilter(bytes, 51, 51)(0, 0);
+            });
+            // van Herk / Gil-Werman and Perreault - Hebert: cost independent of the window
+            _run("erode15_u8", n, 6 * px, px, 2 * px, [&]()
+            {
+                benchSink = erode(bytes, 15, 15)(0, 0);
+            });
+            _run("median15_u8", n, 0, px, 2 * px, [&]()
+            {
+                benchSink = medianFilter(bytes, 15, 15)(0, 0);
+            });
+            // blur fused with the 2x decimation: only the kept quarter of the pixels is filtered
+            _run("pyramid_down_u8", n, 4.5 * px, px, 1.25 * px, [&]()
+            {
+                benchSink = pyramidDown(bytes)(0, 0);
+            });
+            _run("resize_bilinear_u8", n, 3 * px, px, 1.25 * px, [&]()
+            {
+                benchSink = resize(bytes, (n + 1) / 2, (n + 1) / 2)(0, 0);
+            });
+            _run("resize_area_u8", n, 4 * px, px, 1.25 * px, [&]()
+            {
+                benchSink = resize(bytes, (n + 1) / 2, (n + 1) / 2, Interpolation::Area)(0, 0);
+            });
+            // the chain writes and reads back two intermediate images, the pipeline none
+            _run("chain_u8", n, 54 * px, px, 6 * px, [&]()
+            {
+                benchSink = quantization(sobel(blur(bytes)), 8)(0, 0);
+            });
+            _run("pipeline_u8", n, 54 * px, px, 2 * px, [&]()
+            {
+                benchSink = pipeline.run(bytes)(0, 0);
+            });
+            const int frames = 8;
+            std::ostringstream encoded;
+            for (int f = 0; f < frames; ++f)
+            {
+                writeBinary(encoded, bytes);
+            }
+            const std::string stream = encoded.str();
+            FrameStream frameStream(n, n);
+            _run("stream_u8", n, 54 * px * frames, px * frames, 2 * px * frames, [&]()
+            {
+                std::istringstream is(stream);
+                benchSink = frameStream.run(binaryFrameReader(is), pipeline, [](const ConstByteMatrixView &frame)
+                {
+                    benchSink = frame(0, 0);
+                }).frames;
+            });
+        }
+    }
+
+    /**
+     * @return the results so far
+     */
+    const std::vector<BenchResult> &results() const
+    {
+        return _results;
+    }
+};
+
+/**
+ * writes the results as JSON - one result object per line, so --compare (and diff) can read them
+ * @param path
+ * @param results
+ */
+static void writeJson(const std::string &path, const std::vector<BenchResult> &results)
+{
+    std::ofstream os(path);
+    os << std::setprecision(9);
+    os << "{\n  \"threads\": " << defaultThreadCount() << ",\n";
+#ifdef __VERSION__
+    os << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+    os << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult &r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"seconds\": " << r.seconds
+           << ", \"gflops\": " << (r.flops > 0 ? r.flops / r.seconds * 1e-9 : 0.0)
+           << ", \"mpixels_per_s\": " << (r.pixels > 0 ? r.pixels / r.seconds * 1e-6 : 0.0)
+           << ", \"gb_per_s\": " << r.bytes / r.seconds * 1e-9 << "}" << (i + 1 < results.size() ? "," : "")
+           << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+/**
+ * value following "key": on a result line
+ */
+static std::string jsonField(const std::string &line, const std::string &key)
+{
+    size_t at = line.find("\"" + key + "\":");
+    if (at == std::string::npos)
+    {
+        return "";
+    }
+    at += key.size() + 3;
+    while (at < line.size() && (line[at] == ' ' || line[at] == '"'))
+    {
+        ++at;
+    }
+    size_t end = line.find_first_of("\",}", at);
+    return line.substr(at, end - at);
+}
+
+/**
+ * reads the results written by writeJson: (name, size) -> seconds
+ * @param path
+ * @param out
+ * @return false if the file can not be read
+ */
+static bool readJson(const std::string &path, std::map<std::pair<std::string, int>, double> &out)
+{
+    std::ifstream is(path);
+    if (!is)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(is, line))
+    {
+        std::string name = jsonField(line, "name");
+        if (!name.empty())
+        {
+            out[{name, std::atoi(jsonField(line, "size").c_str())}] = std::atof(jsonField(line, "seconds").c_str());
+        }
+    }
+    return true;
+}
+
+/**
+ * compares two result files
+ * @param basePath
+ * @param newPath
+ * @param threshold slowdown in percent reported as a regression
+ * @return exit code - 1 if any benchmark regressed
+ */
+static int compare(const std::string &basePath, const std::string &newPath, double threshold)
+{
+    std::map<std::pair<std::string, int>, double> base, current;
+    if (!readJson(basePath, base))
+    {
+        std::cerr << BENCH_CANNOT_READ << basePath << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!readJson(newPath, current))
+    {
+        std::cerr << BENCH_CANNOT_READ << newPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    int regressions = 0;
+    std::cout << std::left << std::setw(20) << "name" << std::right << std::setw(6) << "size" << std::setw(14)
+              << "base s" << std::setw(14) << "new s" << std::setw(10) << "speedup" << std::endl;
+    for (const auto &entry : current)
+    {
+        auto match = base.find(entry.first);
+        if (match == base.end() || entry.second <= 0)
+        {
+            continue;
+        }
+        double speedup = match->second / entry.second;
+        bool regressed = speedup < 1.0 / (1.0 + threshold / 100);
+        regressions += regressed;
+        std::cout << std::left << std::setw(20) << entry.first.first << std::right << std::setw(6)
+                  << entry.first.second << std::scientific << std::setprecision(3) << std::setw(14) << match->second
+                  << std::setw(14) << entry.second << std::fixed << std::setprecision(2) << std::setw(10) << speedup
+                  << (regressed ? "  REGRESSION" : "") << std::endl;
+    }
+    std::cout << regressions << " regression(s) over " << threshold << "%" << std::endl;
+    return regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * multiply() of float matrices against a double reference: the classical result must meet its
+ * elementwise bound n u |A||B| and the strassen one its normwise bound
+ * [(n/n0)^log2(18) (n0^2 + 6 n0) - 6n] u ||A|| ||B|| (see MatrixMultiply.h), with n the padded size
+ * and n0 the size the recursion stops at. sizes that pad and cutoffs down to 8 (many levels) are
+ * included. the reference's own error (n 2^-53 |A||B|) is allowed on top.
+ * @return exit code - 1 if a bound is exceeded
+ */
+static int checkMultiply()
+{
+    std::mt19937 gen(2024);
+    int failures = 0;
+    std::cout << std::left << std::setw(12) << "algorithm" << std::right << std::setw(6) << "size" << std::setw(8)
+              << "cutoff" << std::setw(14) << "max error" << std::setw(14) << "error/bound" << std::endl;
+    for (int n : {64, 200, 256, 300, 512})
+    {
+        Matrix a = randomMatrix<float>(n, n, -1, 1, gen), b = randomMatrix<float>(n, n, -1, 1, gen);
+        DoubleMatrix da(n, n), db(n, n), absA(n, n), absB(n, n);
+        double maxA = 0, maxB = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                da(i, j) = a(i, j);
+                db(i, j) = b(i, j);
+                absA(i, j) = std::fabs(da(i, j));
+                absB(i, j) = std::fabs(db(i, j));
+                maxA = std::max(maxA, absA(i, j));
+                maxB = std::max(maxB, absB(i, j));
+            }
+        }
+        DoubleMatrix exact = multiply(da, db, MultiplicationAlgorithm::Classical);
+        DoubleMatrix magnitude = multiply(absA, absB, MultiplicationAlgorithm::Classical);
+        const double referenceError = n * std::ldexp(1.0, -53);
+        auto report = [&](const char *name, int cutoff, double error, double ratio)
+        {
+            bool failed = !(ratio <= 1);
+            failures += failed;
+            std::cout << std::left << std::setw(12) << name << std::right << std::setw(6) << n << std::setw(8)
+                      << cutoff << std::scientific << std::setprecision(3) << std::setw(14) << error << std::setw(14)
+                      << ratio << (failed ? "  FAILED" : "") << std::endl;
+        };
+
+        // classical: every element within n u (|A||B|)ij - the worst element's error / bound is reported
+        Matrix classical = multiply(a, b, MultiplicationAlgorithm::Classical);
+        const double gamma = n * FLOAT_UNIT_ROUNDOFF / (1 - n * FLOAT_UNIT_ROUNDOFF);
+        double worst = 0, maxError = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                double error = std::fabs(classical(i, j) - exact(i, j));
+                maxError = std::max(maxError, error);
+                worst = std::max(worst, error / ((gamma + referenceError) * magnitude(i, j)));
+            }
+        }
+        report("classical", 0, maxError, worst);
+
+        for (int cutoff : {8, 32, 128})
+        {
+            if (n <= cutoff)
+            {
+                continue;
+            }
+            int levels = 0, base = n;
+            while (base > cutoff)
+            {
+                base = (base + 1) / 2;
+                ++levels;
+            }
+            const double padded = static_cast<double>(base) * (1 << levels), n0 = base;
+            const double bound = ((std::pow(padded / n0, std::log2(18.0)) * (n0 * n0 + 6 * n0) - 6 * padded) *
+                                  FLOAT_UNIT_ROUNDOFF + referenceError * n) * maxA * maxB;
+            Matrix fast = multiply(a, b, MultiplicationAlgorithm::Strassen, cutoff);
+            double error = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                for (int j = 0; j < n; ++j)
+                {
+                    error = std::max(error, std::fabs(fast(i, j) - exact(i, j)));
+                }
+            }
+            report("strassen", cutoff, error, error / bound);
+        }
+    }
+    std::cout << failures << " bound(s) exceeded" << std::endl;
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// ------------------------------ main -----------------------------
+
+/**
+ * runs the benchmarks, compares two result files, or checks multiply() against its error bounds
+ * build (from ex5): g++ -std=c++17 -O3 -march=native -pthread -I. *.cpp -o benchmark
+ * @param argc
+ * @param argv
+ * @return 0 on success, 1 on bad usage, (--compare) when something regressed or (--check-multiply) when
+ * a bound is exceeded
+ */
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    std::string jsonPath;
+    double threshold = BENCH_DEFAULT_THRESHOLD;
+    std::vector<std::string> compareFiles;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--json" && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--only" && hasValue)
+        {
+            options.only = argv[++i];
+        }
+        else if (arg == "--max-size" && hasValue)
+        {
+            options.maxSize = std::atoi(argv[++i]);
+        }
+        else if (arg == "--max-matmul" && hasValue)
+        {
+            options.maxMatmul = std::atoi(argv[++i]);
+        }
+        else if (arg == "--threshold" && hasValue)
+        {
+            threshold = std::atof(argv[++i]);
+        }
+        else if (arg == "--quick")
+        {
+            options.maxSize = std::min(options.maxSize, BENCH_QUICK_MAX_SIZE);
+            options.minSeconds = BENCH_MIN_SECONDS / 10;
+        }
+        else if (arg == "--check-multiply")
+        {
+            return checkMultiply();
+        }
+        else if (arg == "--compare" && i + 2 < argc)
+        {
+            compareFiles = {argv[i + 1], argv[i + 2]};
+            i += 2;
+        }
+        else
+        {
+            std::cerr << BENCH_USAGE;
+            return EXIT_FAILURE;
+        }
+    }
+    if (!compareFiles.empty())
+    {
+        return compare(compareFiles[0], compareFiles[1], threshold);
+    }
+
+    std::cout << "threads: " << defaultThreadCount() << std::endl;
+    std::cout << std::left << std::setw(20) << "name" << std::right << std::setw(6) << "size" << std::setw(14)
+              << "median s" << std::setw(10) << "GFLOPS" << std::setw(12) << "MPixel/s" << std::setw(10) << "GB/s"
+              << std::endl;
+    BenchSuite suite(options);
+    suite.multiplication();
+    suite.elementWise();
+    suite.streamIO();
+    suite.filters();
+    if (!jsonPath.empty())
+    {
+        writeJson(jsonPath, suite.results());
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+
+// ------------------------------ includes ------------------------------
+#include "BufferPool.h"
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// ------------------------------ const & macros -----------------------------
+
+/**
+ * number of size classes up to BUFFER_POOL_MAX_BYTES (1 + 4 per power of two above the minimum)
+ */
+#define BUFFER_POOL_CLASSES (1 + 4 * (31 - 6))
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * size class of a request
+ * @param bytes
+ * @param index set to the index of the class
+ * @return size of the class
+ */
+static size_t classOf(size_t bytes, int &index)
+{
+    if (bytes <= BUFFER_POOL_MIN_BYTES)
+    {
+        index = 0;
+        return BUFFER_POOL_MIN_BYTES;
+    }
+    // 2^k < bytes <= 2^(k+1), k >= 6
+    int k = 0;
+    while ((size_t(2) << k) < bytes)
+    {
+        ++k;
+    }
+    size_t step = size_t(1) << (k - 2);
+    size_t sub = (bytes - 1 - (size_t(1) << k)) / step;
+    index = (k - 6) * 4 + static_cast<int>(sub) + 1;
+    return (size_t(1) << k) + (sub + 1) * step;
+}
+
+/**
+ * aligned system allocation
+ */
+static void *systemAllocate(size_t bytes)
+{
+    return ::operator new(bytes, std::align_val_t(BUFFER_POOL_ALIGNMENT));
+}
+
+/**
+ * aligned system free
+ */
+static void systemFree(void *buffer)
+{
+    ::operator delete(buffer, std::align_val_t(BUFFER_POOL_ALIGNMENT));
+}
+
+/**
+ *  the process wide pool: a free list per size class and the statistics, under one mutex
+ *  (allocations are per matrix, not per element, so the lock is not contended).
+ */
+struct BufferPool
+{
+    std::mutex lock;
+    std::vector<void *> freeLists[BUFFER_POOL_CLASSES];
+    BufferPoolStats stats{};
+
+    /**
+     * frees the cached buffers at exit
+     */
+    ~BufferPool()
+    {
+        for (std::vector<void *> &list : this->freeLists)
+        {
+            for (void *buffer : list)
+            {
+                systemFree(buffer);
+            }
+        }
+    }
+};
+
+/**
+ * @return the pool (created on first use)
+ */
+static BufferPool &pool()
+{
+    static BufferPool instance;
+    return instance;
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * @param bytes
+ * @return bytes actually reserved for a request of `bytes`
+ */
+size_t bufferPoolClassSize(size_t bytes)
+{
+    int index;
+    return bytes > BUFFER_POOL_MAX_BYTES ? bytes : classOf(bytes, index);
+}
+
+/**
+ * returns an aligned buffer of at least `bytes` bytes
+ * @param bytes
+ * @return buffer
+ */
+void *bufferPoolAllocate(size_t bytes)
+{
+    BufferPool &p = pool();
+    int index = -1;
+    size_t size = bytes > BUFFER_POOL_MAX_BYTES ? bytes : classOf(bytes, index);
+    {
+        std::lock_guard<std::mutex> guard(p.lock);
+        ++p.stats.allocations;
+        p.stats.bytesInUse += size;
+        p.stats.peakBytesInUse = std::max(p.stats.peakBytesInUse, p.stats.bytesInUse);
+        if (index >= 0 && !p.freeLists[index].empty())
+        {
+            void *buffer = p.freeLists[index].back();
+            p.freeLists[index].pop_back();
+            p.stats.bytesCached -= size;
+            ++p.stats.reused;
+            return buffer;
+        }
+        ++p.stats.systemAllocations;
+    }
+    try
+    {
+        return systemAllocate(size);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> guard(p.lock);
+        p.stats.bytesInUse -= size;
+        throw;
+    }
+}
+
+/**
+ * gives a buffer back to the pool
+ * @param buffer
+ * @param bytes
+ */
+void bufferPoolRelease(void *buffer, size_t bytes)
+{
+    if (buffer == nullptr)
+    {
+        return;
+    }
+    BufferPool &p = pool();
+    int index = -1;
+    size_t size = bytes > BUFFER_POOL_MAX_BYTES ? bytes : classOf(bytes, index);
+    {
+        std::lock_guard<std::mutex> guard(p.lock);
+        ++p.stats.releases;
+        p.stats.bytesInUse -= size;
+        if (index >= 0 && p.stats.bytesCached + size <= BUFFER_POOL_MAX_CACHED_BYTES)
+        {
+            try
+            {
+                p.freeLists[index].push_back(buffer);
+                p.stats.bytesCached += size;
+                return;
+            }
+            catch (const std::bad_alloc &)
+            {
+                // no room to remember it - free it below
+            }
+        }
+    }
+    systemFree(buffer);
+}
+
+/**
+ * @return a snapshot of the allocator statistics
+ */
+BufferPoolStats bufferPoolStats()
+{
+    BufferPool &p = pool();
+    std::lock_guard<std::mutex> guard(p.lock);
+    return p.stats;
+}
+
+/**
+ * frees every cached buffer
+ */
+void bufferPoolTrim()
+{
+    BufferPool &p = pool();
+    std::vector<void *> buffers;
+    {
+        std::lock_guard<std::mutex> guard(p.lock);
+        for (std::vector<void *> &list : p.freeLists)
+        {
+            buffers.insert(buffers.end(), list.begin(), list.end());
+            list.clear();
+            list.shrink_to_fit();
+        }
+        p.stats.bytesCached = 0;
+    }
+    for (void *buffer : buffers)
+    {
+        systemFree(buffer);
+    }
+}
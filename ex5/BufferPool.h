@@ -0,0 +1,100 @@
+
+
+#ifndef EX5_BUFFERPOOL_H
+
+// ------------------------------ includes ------------------------------
+
+#include <cstddef>
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_BUFFERPOOL_H
+/**
+ * alignment of every pooled buffer (a cache line, and the widest vector register)
+ */
+#define BUFFER_POOL_ALIGNMENT 64
+/**
+ * smallest size class
+ */
+#define BUFFER_POOL_MIN_BYTES 64
+/**
+ * larger requests bypass the pool (allocated and freed directly, still aligned)
+ */
+#define BUFFER_POOL_MAX_BYTES (size_t(1) << 31)
+/**
+ * released buffers are kept for reuse up to this many bytes in total, beyond that they are freed
+ */
+#define BUFFER_POOL_MAX_CACHED_BYTES (size_t(1) << 30)
+
+// ------------------------------ functions -----------------------------
+
+/**
+ *  allocator statistics, see bufferPoolStats()
+ */
+struct BufferPoolStats
+{
+    /**
+     * calls to bufferPoolAllocate
+     */
+    long allocations;
+    /**
+     * allocations served from a cached buffer (no malloc)
+     */
+    long reused;
+    /**
+     * allocations that went to the system allocator
+     */
+    long systemAllocations;
+    /**
+     * calls to bufferPoolRelease
+     */
+    long releases;
+    /**
+     * bytes handed out and not released yet (size class bytes)
+     */
+    size_t bytesInUse;
+    /**
+     * highest bytesInUse seen
+     */
+    size_t peakBytesInUse;
+    /**
+     * bytes held by released buffers waiting for reuse
+     */
+    size_t bytesCached;
+};
+
+/**
+ * size classes: 64 bytes, then 4 classes per power of two (e.g 160, 192, 224, 256), so a buffer
+ * is at most 25% larger than asked for and same sized matrices always share a class.
+ * @param bytes
+ * @return bytes actually reserved for a request of `bytes`
+ */
+size_t bufferPoolClassSize(size_t bytes);
+
+/**
+ * returns a BUFFER_POOL_ALIGNMENT aligned buffer of at least `bytes` bytes (contents undefined).
+ * a buffer of the same size class released before is reused, so steady state loops that keep
+ * allocating the same sizes do not reach malloc. thread safe.
+ * @param bytes
+ * @return buffer, throws std::bad_alloc when out of memory
+ */
+void *bufferPoolAllocate(size_t bytes);
+
+/**
+ * gives a buffer back to the pool.
+ * @param buffer from bufferPoolAllocate (nullptr is ignored)
+ * @param bytes the size it was allocated with
+ */
+void bufferPoolRelease(void *buffer, size_t bytes);
+
+/**
+ * @return a snapshot of the allocator statistics
+ */
+BufferPoolStats bufferPoolStats();
+
+/**
+ * frees every cached buffer (buffers in use are not affected)
+ */
+void bufferPoolTrim();
+
+#endif //EX5_BUFFERPOOL_H
@@ -0,0 +1,249 @@
+
+// ------------------------------ includes ------------------------------
+#include "FFT.h"
+#include "Matrix.h"
+#include <cmath>
+
+// ------------------------------ const & macros -----------------------------
+
+/**
+ * pi
+ */
+#define FFT_PI 3.14159265358979323846
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * complex product without the inf / nan recovery of std::complex's operator* (which the compiler
+ * turns into a library call per product)
+ */
+static inline std::complex<double> mul(const std::complex<double> &a, const std::complex<double> &b)
+{
+    return std::complex<double>(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+/**
+ * -i * a
+ */
+static inline std::complex<double> mulMinusI(const std::complex<double> &a)
+{
+    return std::complex<double>(a.imag(), -a.real());
+}
+
+// ------------------------------ class FFTPlan -----------------------------
+
+/**
+ * Constructor
+ * factors n (4s first, then 2, 3, 5 and the remaining primes) and computes the n twiddles.
+ * @param n
+ */
+FFTPlan::FFTPlan(int n) : _n(n)
+{
+    if (n <= 0)
+    {
+        matrixError<std::invalid_argument>(INVALID_FFT_SIZE);
+    }
+    int rest = n;
+    while (rest % 4 == 0)
+    {
+        _factors.push_back(4);
+        rest /= 4;
+    }
+    for (int p = 2; rest > 1; ++p)
+    {
+        while (rest % p == 0)
+        {
+            _factors.push_back(p);
+            rest /= p;
+        }
+    }
+    _twiddles.resize(n);
+    for (int k = 0; k < n; ++k)
+    {
+        double angle = -2 * FFT_PI * k / n;
+        _twiddles[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+}
+
+/**
+ * @return transform size
+ */
+int FFTPlan::size() const
+{
+    return _n;
+}
+
+/**
+ * decimation in time: the p sub sequences in[q], in[q + p], ... (q < p) are transformed into
+ * consecutive blocks of out, then combined by p point butterflies.
+ */
+void FFTPlan::_transform(const std::complex<double> *in, std::complex<double> *out, int n, int stride,
+                         int level) const
+{
+    typedef std::complex<double> Complex;
+    if (n == 1)
+    {
+        out[0] = in[0];
+        return;
+    }
+    const int p = _factors[level];
+    const int m = n / p;
+    for (int q = 0; q < p; ++q)
+    {
+        if (m == 1)
+        {
+            out[q] = in[q * stride];
+        }
+        else
+        {
+            _transform(in + q * stride, out + q * m, m, stride * p, level + 1);
+        }
+    }
+    // twiddle w_n^j = _twiddles[j * step]
+    const int step = _n / n;
+    if (p == 2)
+    {
+        for (int k = 0; k < m; ++k)
+        {
+            Complex a = out[k], b = mul(out[k + m], _twiddles[k * step]);
+            out[k] = a + b;
+            out[k + m] = a - b;
+        }
+    }
+    else if (p == 4)
+    {
+        for (int k = 0; k < m; ++k)
+        {
+            Complex a = out[k];
+            Complex b = mul(out[k + m], _twiddles[k * step]);
+            Complex c = mul(out[k + 2 * m], _twiddles[2 * k * step]);
+            Complex d = mul(out[k + 3 * m], _twiddles[3 * k * step]);
+            Complex ac = a + c, a_c = a - c, bd = b + d;
+            Complex b_d = b - d;
+            Complex jb_d = mulMinusI(b_d);
+            out[k] = ac + bd;
+            out[k + m] = a_c + jb_d;
+            out[k + 2 * m] = ac - bd;
+            out[k + 3 * m] = a_c - jb_d;
+        }
+    }
+    else if (p == 3)
+    {
+        // w = e^(-2 pi i / 3): X1 = a - (b + c) / 2 - i sin(pi / 3) (b - c), X2 conjugate sign
+        const double s = std::sqrt(3.0) / 2;
+        for (int k = 0; k < m; ++k)
+        {
+            Complex a = out[k];
+            Complex b = mul(out[k + m], _twiddles[k * step]);
+            Complex c = mul(out[k + 2 * m], _twiddles[2 * k * step]);
+            Complex sum = b + c, diff = b - c;
+            Complex mid = a - 0.5 * sum;
+            Complex rot = mulMinusI(s * diff);
+            out[k] = a + sum;
+            out[k + m] = mid + rot;
+            out[k + 2 * m] = mid - rot;
+        }
+    }
+    else if (p == 5)
+    {
+        // cos / sin of 2 pi / 5 and 4 pi / 5
+        const double c1 = 0.30901699437494742, c2 = -0.80901699437494742;
+        const double s1 = 0.95105651629515357, s2 = 0.58778525229247313;
+        for (int k = 0; k < m; ++k)
+        {
+            Complex a = out[k];
+            Complex b = mul(out[k + m], _twiddles[k * step]);
+            Complex c = mul(out[k + 2 * m], _twiddles[2 * k * step]);
+            Complex d = mul(out[k + 3 * m], _twiddles[3 * k * step]);
+            Complex e = mul(out[k + 4 * m], _twiddles[4 * k * step]);
+            Complex be = b + e, cd = c + d, b_e = b - e, c_d = c - d;
+            Complex real1 = a + c1 * be + c2 * cd, real2 = a + c2 * be + c1 * cd;
+            Complex imag1 = mulMinusI(s1 * b_e + s2 * c_d), imag2 = mulMinusI(s2 * b_e - s1 * c_d);
+            out[k] = a + be + cd;
+            out[k + m] = real1 + imag1;
+            out[k + 4 * m] = real1 - imag1;
+            out[k + 2 * m] = real2 + imag2;
+            out[k + 3 * m] = real2 - imag2;
+        }
+    }
+    else
+    {
+        // generic p point butterfly (primes above 5), w_p^j = _twiddles[j * (_n / p)]
+        Complex local[8];
+        std::vector<Complex> big(p > 8 ? p : 0);
+        Complex *x = p > 8 ? big.data() : local;
+        const int root = _n / p;
+        for (int k = 0; k < m; ++k)
+        {
+            x[0] = out[k];
+            for (int q = 1; q < p; ++q)
+            {
+                x[q] = mul(out[k + q * m], _twiddles[q * k * step]);
+            }
+            for (int s = 0; s < p; ++s)
+            {
+                Complex sum = x[0];
+                for (int q = 1, qs = s; q < p; ++q, qs = (qs + s) % p)
+                {
+                    sum += mul(x[q], _twiddles[qs * root]);
+                }
+                out[k + s * m] = sum;
+            }
+        }
+    }
+}
+
+/**
+ * in place forward transform
+ * @param data
+ * @param scratch
+ */
+void FFTPlan::forward(std::complex<double> *data, std::complex<double> *scratch) const
+{
+    std::copy(data, data + _n, scratch);
+    _transform(scratch, data, _n, 1, 0);
+}
+
+/**
+ * in place inverse transform (not normalized) - conj(forward(conj(x)))
+ * @param data
+ * @param scratch
+ */
+void FFTPlan::inverse(std::complex<double> *data, std::complex<double> *scratch) const
+{
+    for (int i = 0; i < _n; ++i)
+    {
+        scratch[i] = std::conj(data[i]);
+    }
+    _transform(scratch, data, _n, 1, 0);
+    for (int i = 0; i < _n; ++i)
+    {
+        data[i] = std::conj(data[i]);
+    }
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * smallest 2^a 3^b 5^c >= n
+ * @param n
+ * @return
+ */
+int fftSize(int n)
+{
+    for (int candidate = std::max(n, 1);; ++candidate)
+    {
+        int rest = candidate;
+        for (int p : {2, 3, 5})
+        {
+            while (rest % p == 0)
+            {
+                rest /= p;
+            }
+        }
+        if (rest == 1)
+        {
+            return candidate;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+
+
+#ifndef EX5_FFT_H
+
+// ------------------------------ includes ------------------------------
+
+#include <complex>
+#include <vector>
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_FFT_H
+/**
+ * error - transform sizes are positive
+ */
+#define INVALID_FFT_SIZE "Invalid FFT size.\n"
+
+// ------------------------------ class FFTPlan -----------------------------
+
+/**
+ *  complex discrete fourier transform of one size, in double precision.
+ *  mixed radix cooley-tukey: the size is split into its prime factors, 2, 3, 4 and 5 have
+ *  dedicated butterflies and any other prime runs a direct O(p^2) butterfly - so sizes of the form
+ *  2^a 3^b 5^c (see fftSize) are fast. the twiddle factors are computed once, in the constructor;
+ *  a plan is then read only and can be shared between threads.
+ */
+class FFTPlan
+{
+private:
+
+    int _n;
+    std::vector<int> _factors;
+    std::vector<std::complex<double>> _twiddles;
+
+    /**
+     * one level of the recursion: out[0 .. n) = DFT of in[0], in[stride], ... in[(n - 1) * stride]
+     */
+    void _transform(const std::complex<double> *in, std::complex<double> *out, int n, int stride,
+                    int level) const;
+
+public:
+    /**
+     * Constructor
+     * Check n > 0.
+     * @param n transform size
+     */
+    explicit FFTPlan(int n);
+
+    /**
+     * @return transform size
+     */
+    int size() const;
+
+    /**
+     * in place forward transform: X[k] = sum x[j] e^(-2 pi i jk / n)
+     * @param data n values
+     * @param scratch n values of work space (contents are overwritten)
+     */
+    void forward(std::complex<double> *data, std::complex<double> *scratch) const;
+
+    /**
+     * in place inverse transform, not normalized: x[j] = sum X[k] e^(2 pi i jk / n)
+     * (forward then inverse multiplies by n)
+     * @param data n values
+     * @param scratch n values of work space
+     */
+    void inverse(std::complex<double> *data, std::complex<double> *scratch) const;
+};
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * smallest n' >= n whose only prime factors are 2, 3 and 5 - the fast sizes of FFTPlan.
+ * padding to these is much tighter than to powers of two (e.g 135 instead of 256).
+ * @param n
+ * @return
+ */
+int fftSize(int n);
+
+#endif //EX5_FFT_H
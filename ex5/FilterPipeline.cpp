@@ -0,0 +1,412 @@
+
+// ------------------------------ includes ------------------------------
+#include "FilterPipeline.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * a rectangle of a tile buffer, rows [r0, r1) and cols [c0, c1)
+ */
+struct TileRegion
+{
+    int r0, r1, c0, c1;
+};
+
+/**
+ * std::rint (round half to even) without the library call: below 2^23 adding and subtracting 2^23
+ * leaves the rounded magnitude, larger floats are integers already. vectorizes.
+ */
+static inline float roundEven(float x)
+{
+    const float magic = 8388608.0f;
+    float magnitude = std::fabs(x);
+    return magnitude < magic ? std::copysign((magnitude + magic) - magic, x) : x;
+}
+
+/**
+ * blur stage: the [1 2 1] / 4 row pass, then the column pass, rounded and clamped to [0,255] - in
+ * the order convolutionSeparable adds the taps, so the results are identical.
+ * @param in tile buffer, valid (or zero) one pixel around the region
+ * @param out tile buffer
+ * @param stride buffer row length
+ * @param region
+ * @param scratch at least (rows + 2) * cols floats
+ */
+static void blurTile(const float *in, float *out, int stride, const TileRegion &region, float *scratch)
+{
+    const float t0 = GAUSSIAN_BLUR_ROW(0, 0), t1 = GAUSSIAN_BLUR_ROW(0, 1), t2 = GAUSSIAN_BLUR_ROW(0, 2);
+    const float v0 = GAUSSIAN_BLUR_COLUMN(0, 0), v1 = GAUSSIAN_BLUR_COLUMN(1, 0), v2 = GAUSSIAN_BLUR_COLUMN(2, 0);
+    const int width = region.c1 - region.c0;
+    for (int r = region.r0 - 1; r <= region.r1; ++r)
+    {
+        const float *src = in + static_cast<size_t>(r) * stride + region.c0;
+        float *dst = scratch + static_cast<size_t>(r - region.r0 + 1) * width;
+        for (int c = 0; c < width; ++c)
+        {
+            dst[c] = t0 * src[c - 1] + t1 * src[c] + t2 * src[c + 1];
+        }
+    }
+    for (int r = region.r0; r < region.r1; ++r)
+    {
+        const float *up = scratch + static_cast<size_t>(r - region.r0) * width;
+        const float *mid = up + width, *down = mid + width;
+        float *dst = out + static_cast<size_t>(r) * stride + region.c0;
+        for (int c = 0; c < width; ++c)
+        {
+            float sum = roundEven(v0 * up[c] + v1 * mid[c] + v2 * down[c]);
+            dst[c] = std::min(255.0f, std::max(0.0f, sum));
+        }
+    }
+}
+
+/**
+ * sobel stages: gx and gy as in sobelSweep, stored as the clamped sum of their rounded values
+ * (StageKind::Sobel) or as their norm.
+ * @param in tile buffer, valid (or zero) one pixel around the region
+ * @param out tile buffer
+ * @param stride buffer row length
+ * @param region
+ * @param stage
+ * @param scratch at least 4 * (cols + 2) floats
+ */
+static void sobelTile(const float *in, float *out, int stride, const TileRegion &region,
+                      const FilterPipeline::Stage &stage, float *scratch)
+{
+    const int width = region.c1 - region.c0;
+    float *smooth = scratch + 1, *diff = smooth + width + 2;
+    float *gx = diff + width + 1, *gy = gx + width;
+    for (int r = region.r0; r < region.r1; ++r)
+    {
+        const float *mid = in + static_cast<size_t>(r) * stride + region.c0;
+        const float *up = mid - stride, *down = mid + stride;
+        for (int c = -1; c <= width; ++c)
+        {
+            smooth[c] = up[c] + 2 * mid[c] + down[c];
+            diff[c] = up[c] - down[c];
+        }
+        for (int c = 0; c < width; ++c)
+        {
+            gx[c] = (smooth[c - 1] - smooth[c + 1]) * float(1 / 8.0);
+            gy[c] = (diff[c - 1] + 2 * diff[c] + diff[c + 1]) * float(1 / 8.0);
+        }
+        float *dst = out + static_cast<size_t>(r) * stride + region.c0;
+        if (stage.kind == FilterPipeline::StageKind::Sobel)
+        {
+            for (int c = 0; c < width; ++c)
+            {
+                dst[c] = std::min(255.0f, std::max(0.0f, roundEven(gx[c]) + roundEven(gy[c])));
+            }
+        }
+        else if (stage.norm == GradientNorm::L1)
+        {
+            for (int c = 0; c < width; ++c)
+            {
+                dst[c] = std::min(255.0f, roundEven(std::fabs(gx[c]) + std::fabs(gy[c])));
+            }
+        }
+        else
+        {
+            for (int c = 0; c < width; ++c)
+            {
+                dst[c] = std::min(255.0f, roundEven(std::sqrt(gx[c] * gx[c] + gy[c] * gy[c])));
+            }
+        }
+    }
+}
+
+/**
+ * per pixel stages, in place
+ * @param data tile buffer
+ * @param stride
+ * @param region
+ * @param stage
+ */
+static void pointTile(float *data, int stride, const TileRegion &region, const FilterPipeline::Stage &stage)
+{
+    const float scale = stage.levels / 256.0f;
+    const float *levelValues = stage.levelValues.data();
+    for (int r = region.r0; r < region.r1; ++r)
+    {
+        float *row = data + static_cast<size_t>(r) * stride;
+        if (stage.kind == FilterPipeline::StageKind::Clamp)
+        {
+            for (int c = region.c0; c < region.c1; ++c)
+            {
+                row[c] = std::min(255.0f, std::max(0.0f, row[c]));
+            }
+        }
+        else
+        {
+            for (int c = region.c0; c < region.c1; ++c)
+            {
+                float level = std::floor(row[c] * scale);
+                int idx = static_cast<int>(std::min(static_cast<float>(stage.levels - 1), std::max(0.0f, level)));
+                row[c] = levelValues[idx];
+            }
+        }
+    }
+}
+
+// ------------------------------ class FilterPipeline -----------------------------
+
+/**
+ * Constructor
+ * @param tileRows
+ * @param tileCols
+ */
+FilterPipeline::FilterPipeline(int tileRows, int tileCols) : _tileRows(0), _tileCols(0)
+{
+    setTileSize(tileRows, tileCols);
+}
+
+/**
+ * adds a stage of the given kind
+ */
+FilterPipeline &FilterPipeline::_add(StageKind kind)
+{
+    Stage stage;
+    stage.kind = kind;
+    stage.norm = GradientNorm::L2;
+    stage.levels = 0;
+    _stages.push_back(stage);
+    return *this;
+}
+
+/**
+ * adds a blur() stage
+ * @return
+ */
+FilterPipeline &FilterPipeline::blur()
+{
+    return _add(StageKind::Blur);
+}
+
+/**
+ * adds a sobel() stage
+ * @return
+ */
+FilterPipeline &FilterPipeline::sobel()
+{
+    return _add(StageKind::Sobel);
+}
+
+/**
+ * adds a sobelMagnitude() stage
+ * @param norm
+ * @return
+ */
+FilterPipeline &FilterPipeline::sobelMagnitude(GradientNorm norm)
+{
+    _add(StageKind::SobelMagnitude);
+    _stages.back().norm = norm;
+    return *this;
+}
+
+/**
+ * adds a quantization() stage - level i maps to the table value of its first pixel
+ * @param levels
+ * @return
+ */
+FilterPipeline &FilterPipeline::quantization(int levels)
+{
+    LookupTable table = quantizationTable(levels);
+    Stage stage;
+    stage.kind = StageKind::Quantization;
+    stage.norm = GradientNorm::L2;
+    stage.levels = levels;
+    for (int i = 0; i < levels; ++i)
+    {
+        stage.levelValues.push_back(table[(256 * i + levels - 1) / levels]);
+    }
+    _stages.push_back(stage);
+    return *this;
+}
+
+/**
+ * adds a makeMatrixInBounds() stage
+ * @return
+ */
+FilterPipeline &FilterPipeline::makeInBounds()
+{
+    return _add(StageKind::Clamp);
+}
+
+/**
+ * @return the stages
+ */
+const std::vector<FilterPipeline::Stage> &FilterPipeline::stages() const
+{
+    return _stages;
+}
+
+/**
+ * @return pixels around a tile the stages read
+ */
+int FilterPipeline::halo() const
+{
+    int halo = 0;
+    for (const Stage &stage : _stages)
+    {
+        if (stage.kind == StageKind::Blur || stage.kind == StageKind::Sobel || stage.kind == StageKind::SobelMagnitude)
+        {
+            ++halo;
+        }
+    }
+    return halo;
+}
+
+/**
+ * changes the tile size
+ * @param tileRows
+ * @param tileCols
+ */
+void FilterPipeline::setTileSize(int tileRows, int tileCols)
+{
+    if (tileRows <= 0 || tileCols <= 0)
+    {
+        matrixError<std::invalid_argument>(INVALID_PIPELINE_TILE);
+    }
+    _tileRows = tileRows;
+    _tileCols = tileCols;
+}
+
+/**
+ * runs the stages tile by tile. a tile's buffers cover the tile plus the whole halo; stage s
+ * computes the tile grown by the halo of the stages after it (clipped to the image), reading one
+ * pixel further. buffer pixels past the image are zero and never written.
+ * @param image
+ * @param res
+ * @param threads
+ */
+template<typename R, typename T>
+void FilterPipeline::_run(const BasicMatrixView<const T> &image, const BasicMatrixView<R> &res, int threads) const
+{
+    if (image.getRows() != res.getRows() || image.getCols() != res.getCols())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    const int rows = image.getRows(), cols = image.getCols();
+    const int halo = this->halo();
+    const int gridRows = (rows + _tileRows - 1) / _tileRows, gridCols = (cols + _tileCols - 1) / _tileCols;
+    const int stride = _tileCols + 2 * halo;
+    const size_t frameSize = static_cast<size_t>(_tileRows + 2 * halo) * stride;
+    long work = static_cast<long>(rows) * cols * (1 + 8 * static_cast<long>(_stages.size()));
+    parallelFor(0, gridRows * gridCols, resolveThreadCount(threads, work), [&](int begin, int end)
+    {
+        std::vector<float> bufferA(frameSize), bufferB(frameSize);
+        std::vector<float> scratch(std::max(frameSize + 2 * static_cast<size_t>(stride), 4 * static_cast<size_t>(stride + 2)));
+        for (int t = begin; t < end; ++t)
+        {
+            // image coordinates of the tile and of the buffers' first pixel
+            const int tileR0 = (t / gridCols) * _tileRows, tileC0 = (t % gridCols) * _tileCols;
+            const int tileR1 = std::min(rows, tileR0 + _tileRows), tileC1 = std::min(cols, tileC0 + _tileCols);
+            const int frameR0 = tileR0 - halo, frameC0 = tileC0 - halo;
+            float *in = bufferA.data(), *out = bufferB.data();
+            if (frameR0 < 0 || frameC0 < 0 || tileR1 + halo > rows || tileC1 + halo > cols)
+            {
+                std::fill(bufferA.begin(), bufferA.end(), 0.0f);
+                std::fill(bufferB.begin(), bufferB.end(), 0.0f);
+            }
+            // buffer region of the tile grown by `grow`, clipped to the image
+            auto regionFor = [&](int grow)
+            {
+                TileRegion region;
+                region.r0 = std::max(0, tileR0 - grow) - frameR0;
+                region.r1 = std::min(rows, tileR1 + grow) - frameR0;
+                region.c0 = std::max(0, tileC0 - grow) - frameC0;
+                region.c1 = std::min(cols, tileC1 + grow) - frameC0;
+                return region;
+            };
+            TileRegion loaded = regionFor(halo);
+            for (int r = loaded.r0; r < loaded.r1; ++r)
+            {
+                const T *src = image.row_ptr(r + frameR0) + frameC0;
+                float *dst = in + static_cast<size_t>(r) * stride;
+                for (int c = loaded.c0; c < loaded.c1; ++c)
+                {
+                    dst[c] = static_cast<float>(src[c]);
+                }
+            }
+            int remaining = halo;
+            for (const Stage &stage : _stages)
+            {
+                if (stage.kind == StageKind::Quantization || stage.kind == StageKind::Clamp)
+                {
+                    pointTile(in, stride, regionFor(remaining), stage);
+                    continue;
+                }
+                --remaining;
+                if (stage.kind == StageKind::Blur)
+                {
+                    blurTile(in, out, stride, regionFor(remaining), scratch.data());
+                }
+                else
+                {
+                    sobelTile(in, out, stride, regionFor(remaining), stage, scratch.data());
+                }
+                std::swap(in, out);
+            }
+            for (int r = tileR0; r < tileR1; ++r)
+            {
+                const float *src = in + static_cast<size_t>(r - frameR0) * stride - frameC0;
+                R *dst = res.row_ptr(r);
+                // 8 bit inputs stay whole numbers in [0,255] through every stage
+                for (int c = tileC0; c < tileC1; ++c)
+                {
+                    dst[c] = static_cast<R>(src[c]);
+                }
+            }
+        }
+    });
+}
+
+/**
+ * runs the pipeline
+ * @param image
+ * @param threads
+ * @return
+ */
+Matrix FilterPipeline::run(const ConstMatrixView &image, int threads) const
+{
+    Matrix res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    _run(image, res.view(), threads);
+    return res;
+}
+
+/**
+ * runs the pipeline on an 8 bit image
+ * @param image
+ * @param threads
+ * @return
+ */
+ByteMatrix FilterPipeline::run(const ConstByteMatrixView &image, int threads) const
+{
+    ByteMatrix res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    _run(image, res.view(), threads);
+    return res;
+}
+
+/**
+ * runs the pipeline into res
+ * @param image
+ * @param res
+ * @param threads
+ */
+void FilterPipeline::run(const ConstMatrixView &image, const MatrixView &res, int threads) const
+{
+    _run(image, res, threads);
+}
+
+/**
+ * runs the pipeline on an 8 bit image into res
+ * @param image
+ * @param res
+ * @param threads
+ */
+void FilterPipeline::run(const ConstByteMatrixView &image, const ByteMatrixView &res, int threads) const
+{
+    _run(image, res, threads);
+}
@@ -0,0 +1,202 @@
+
+
+#ifndef EX5_FILTERPIPELINE_H
+
+// ------------------------------ includes ------------------------------
+
+#include <vector>
+#include "Matrix.h"
+#include "Filters.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_FILTERPIPELINE_H
+/**
+ * default tile edge - the two float working tiles of 128 x 128 (plus halo) are 128KB, inside L2
+ */
+#define FILTER_PIPELINE_TILE 128
+/**
+ * error - tiles are at least 1 x 1
+ */
+#define INVALID_PIPELINE_TILE "Invalid pipeline tile size.\n"
+
+// ------------------------------ class FilterPipeline -----------------------------
+
+/**
+ *  a chain of filters run tile by tile.
+ *  stages are declared in order (pipeline.blur().sobel().quantization(4)) and run() gives the
+ *  same image as calling the filters one after the other - blur(), sobel(), sobelMagnitude(),
+ *  quantization(), makeMatrixInBounds() - but without an intermediate image per stage: the image
+ *  is cut into tiles, and each tile, grown by the halo the stages need (one pixel per 3x3 stage),
+ *  is read once, goes through every stage in two small float buffers and is written once.
+ *  pixels past the image edges are zero for every stage, like the stand alone filters, so the
+ *  tiles fit together exactly. tiles are split between threads.
+ *  a pipeline is read only while running and can be shared between threads.
+ */
+class FilterPipeline
+{
+public:
+    /**
+     * kind of a stage
+     */
+    enum class StageKind
+    {
+        /**
+         * blur(): the 3x3 gaussian
+         */
+        Blur,
+        /**
+         * sobel(): the clamped sum of the two sobel responses
+         */
+        Sobel,
+        /**
+         * sobelMagnitude(): the gradient norm
+         */
+        SobelMagnitude,
+        /**
+         * quantization()
+         */
+        Quantization,
+        /**
+         * makeMatrixInBounds(): clamps to [0,255]
+         */
+        Clamp
+    };
+
+    /**
+     * one stage: its kind and parameters
+     */
+    struct Stage
+    {
+        /**
+         * what the stage does
+         */
+        StageKind kind;
+        /**
+         * norm of a SobelMagnitude stage
+         */
+        GradientNorm norm;
+        /**
+         * levels of a Quantization stage
+         */
+        int levels;
+        /**
+         * middle value of every level of a Quantization stage
+         */
+        std::vector<float> levelValues;
+    };
+
+private:
+
+    std::vector<Stage> _stages;
+    int _tileRows, _tileCols;
+
+    /**
+     * adds a stage of the given kind
+     */
+    FilterPipeline &_add(StageKind kind);
+
+    /**
+     * runs the stages on image into res (same sizes)
+     */
+    template<typename R, typename T>
+    void _run(const BasicMatrixView<const T> &image, const BasicMatrixView<R> &res, int threads) const;
+
+public:
+    /**
+     * Constructor
+     * an empty pipeline (run() copies the image)
+     * @param tileRows
+     * @param tileCols
+     */
+    explicit FilterPipeline(int tileRows = FILTER_PIPELINE_TILE, int tileCols = FILTER_PIPELINE_TILE);
+
+    /**
+     * adds a blur() stage
+     * @return this pipeline, for chaining
+     */
+    FilterPipeline &blur();
+
+    /**
+     * adds a sobel() stage
+     * @return this pipeline, for chaining
+     */
+    FilterPipeline &sobel();
+
+    /**
+     * adds a sobelMagnitude() stage
+     * @param norm
+     * @return this pipeline, for chaining
+     */
+    FilterPipeline &sobelMagnitude(GradientNorm norm = GradientNorm::L2);
+
+    /**
+     * adds a quantization() stage
+     * throws std::invalid_argument unless 1 <= levels <= 256.
+     * @param levels
+     * @return this pipeline, for chaining
+     */
+    FilterPipeline &quantization(int levels);
+
+    /**
+     * adds a makeMatrixInBounds() stage
+     * @return this pipeline, for chaining
+     */
+    FilterPipeline &makeInBounds();
+
+    /**
+     * @return the stages, in order
+     */
+    const std::vector<Stage> &stages() const;
+
+    /**
+     * @return pixels around a tile the stages read (one per neighbourhood stage)
+     */
+    int halo() const;
+
+    /**
+     * changes the tile size
+     * Check both are positive.
+     * @param tileRows
+     * @param tileCols
+     */
+    void setTileSize(int tileRows, int tileCols);
+
+    /**
+     * runs the pipeline
+     * @param image
+     * @param threads 0 - defaultThreadCount()
+     * @return the filtered image
+     */
+    Matrix run(const ConstMatrixView &image, int threads = 0) const;
+
+    /**
+     * runs the pipeline on an 8 bit image (every stage's output is rounded to 8 bits, as when the
+     * 8 bit filters are chained)
+     * @param image
+     * @param threads 0 - defaultThreadCount()
+     * @return the filtered image
+     */
+    ByteMatrix run(const ConstByteMatrixView &image, int threads = 0) const;
+
+    /**
+     * runs the pipeline into an existing image (or view) of the same size, which must not overlap
+     * the input. nothing is allocated besides the per thread tile buffers.
+     * Check dimensions valid for operation.
+     * @param image
+     * @param res
+     * @param threads 0 - defaultThreadCount()
+     */
+    void run(const ConstMatrixView &image, const MatrixView &res, int threads = 0) const;
+
+    /**
+     * runs the pipeline on an 8 bit image into an existing one of the same size
+     * Check dimensions valid for operation.
+     * @param image
+     * @param res
+     * @param threads 0 - defaultThreadCount()
+     */
+    void run(const ConstByteMatrixView &image, const ByteMatrixView &res, int threads = 0) const;
+};
+
+#endif //EX5_FILTERPIPELINE_H
@@ -1,195 +1,2272 @@
-
-#include <iostream>
-#include "Matrix.h"
-
-/**
- * helper for convolution
- * @param small
- * @param smallMiddleX
- * @param smallMiddleY
- * @param r
- * @param c
- * @param image
- * @param res
- */
-void
-calcConvVal(const Matrix &small, int smallMiddleX, int smallMiddleY, int r, int c, const Matrix &image, Matrix &res)
-{
-    for (int rs = 0; rs < small.getRows(); ++rs)  // go over rows of small
-    {
-        // i-1,j-1 ->i+1,j+1 image. 0,0->2,2
-
-        int rowBound = small.getRows() - 1 - rs;  // row bound index
-        for (int cs = 0; cs < small.getCols(); ++cs) // go over cols of small
-        {
-            int colBound = small.getCols() - 1 - cs;  // col bound index
-            int iNew = r + (smallMiddleY - rowBound); // row index new (to check bounds)
-            int jNew = c + (smallMiddleX - colBound); // col index new (to check bounds)
-            // only if new index in bound - add:
-            if (iNew >= 0 && jNew >= 0 && iNew < image.getRows() && jNew < image.getCols())
-            {
-                res(r, c) += (image(iNew, jNew) * small(rs, cs));
-            }
-        }
-    }
-}
-
-/**
- * this func does the convolution process
- * @param image
- * @param small
- * @return matrix after convolution
- */
-Matrix convolution(const Matrix &image, const Matrix &small)
-{
-    // create result matrix :
-    Matrix res(image.getRows(), image.getCols());
-    // find center of small:
-    int smallMiddleX = small.getCols() / 2;
-    int smallMiddleY = small.getRows() / 2;
-    for (int r = 0; r < image.getRows(); ++r)  //go over rows of image
-    {
-        for (int c = 0; c < image.getCols(); ++c)  // go over cols of image
-        {
-            calcConvVal(small, smallMiddleX, smallMiddleY, r, c, image, res);
-            res(r, c) = rintf(res(r, c));
-        }
-    }
-    return res;
-}
-
-/**
- * Operator Quantization
- * Performs quantization on the input image by the given number of levels.
- * Returns new matrix which is the result of running the operator on the image
- * @param image
- * @param levels
- * @return
- */
-Matrix quantization(const Matrix &image, int levels)
-{
-
-    // 256 is the highest number - MAX_PXLS
-    // to get the lower bound:
-    // Divide MAX_PXLS by levels to get rangeInLevel.
-    // Divide each pixel(place in mat) by rangeInLevel, and throw away the remainder.
-    // to get the lower bound:
-    // 200, level =8
-    // range in level = 32
-    // lower = 200/32 =6.25
-    // upper = 6.25 +32 -1 = 37.25 -> 21
-    Matrix res(image.getRows(), image.getCols());
-    int rangeInLevel = 256 / levels; //assuming there would be no remainder
-
-    int *rangeArr = new int[levels];
-    int *averageArr = new int[levels];
-    for (int i = 0; i < levels; ++i)
-    {
-        rangeArr[i] = i * rangeInLevel;
-    }
-    for (int i = 0; i < levels - 1; ++i)
-    {
-        averageArr[i] = (rangeArr[i + 1] + rangeArr[i] - 1) / 2;
-    }
-    averageArr[levels - 1] = (int) ((256 + rangeArr[levels - 1] - 1) / 2);
-
-    for (int i = 0; i < image.getRows() * image.getCols(); ++i)
-    {
-        int idx = (floorf(image[i] / rangeInLevel));  //todo check if there's a mistake here !!!
-        res[i] = averageArr[idx];
-    }
-
-    for (int i = 0; i < image.getRows() * image.getCols(); ++i)
-    {
-        res[i] = rintf(res[i]);
-    }
-    delete[] rangeArr;
-    delete[] averageArr;
-    return res;
-}
-
-/**
- *  make sure mat vals are in range
- * @param numCells
- * @param res
- * @return
- */
-Matrix &makeMatrixInBounds(const int numCells, Matrix &res)
-{
-
-    for (int i = 0; i < numCells; ++i)
-    {
-        if (res[i] > 255)
-        {
-            res[i] = 255;
-        }
-        else if (res[i] < 0)
-        {
-            res[i] = 0;
-        }
-    }
-    return res;
-}
-
-/**
- * Gaussian Blurring
- * Performs gaussian blurring on the input image.
- * Returns new matrix which is the result of running the operator on the image
- * @param image
- * @return
- */
-Matrix blur(const Matrix &image)
-{
-    Matrix temp(3, 3);
-    float valTemp[] = {1 / 16.0, 2 / 16.0, 1 / 16.0, 2 / 16.0, 4 / 16.0, 2 / 16.0, 1 / 16.0, 2 / 16.0, 1 / 16.0};
-
-    for (int i = 0; i < 9; ++i)
-    {
-        temp[i] = valTemp[i];
-    }
-    Matrix res;
-    res = convolution(image, temp);
-    int numCells = image.getRows() * image.getCols();
-    res = makeMatrixInBounds(numCells, res);
-    return res;
-}
-
-/**
- * Sobel operator (edge detection)
- * Performs sobel edge detection on the input image.
- * Returns new matrix which is the result of running the operator on the image.
- * @param image
- * @return
- */
-Matrix sobel(const Matrix &image)
-{
-    // set first mat
-    Matrix mat1(3, 3);
-    float valMat1[] = {1 / 8.0, 0, -1 / 8.0, 2 / 8.0, 0, -2 / 8.0, 1 / 8.0, 0, -1 / 8.0};
-
-    for (int i = 0; i < 9; ++i)
-    {
-        mat1[i] = valMat1[i];
-    }
-    // set second mat
-    Matrix mat2(3, 3);
-    float valMat2[] = {1.0 / 8.0, 2 / 8.0, 1 / 8.0, 0, 0, 0, -1 / 8.0, -2 / 8.0, -1 / 8.0};
-
-    for (int j = 0; j < 9; ++j)
-    {
-        mat2[j] = valMat2[j];
-    }
-
-    // calc convolution for each mat:
-    mat1 = convolution(image, mat1);
-
-    mat2 = convolution(image, mat2);
-
-    // calc convolution res:
-    Matrix res;
-//    res = convolution(image, mat1) +convolution(image, mat2);
-    res = mat1 + mat2;
-    int numCells = image.getRows() * image.getCols();
-    res = makeMatrixInBounds(numCells, res);
-    return res;
-}
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include "Matrix.h"
+#include "Filters.h"
+#include "FFT.h"
+#include "ParallelFor.h"
+
+/**
+ * source coordinate of coordinate i along a dimension of n pixels, under the border mode
+ * @param i
+ * @param n
+ * @param border
+ * @return index in [0, n), -1 for a zero border pixel
+ */
+static int borderIndex(int i, int n, BorderMode border)
+{
+    if (i >= 0 && i < n)
+    {
+        return i;
+    }
+    if (n <= 0)
+    {
+        // an empty image (0 x cols is valid) has no pixel to repeat - and Wrap would divide by 0
+        return -1;
+    }
+    switch (border)
+    {
+        case BorderMode::Clamp:
+            return i < 0 ? 0 : n - 1;
+        case BorderMode::Reflect:
+        {
+            if (n == 1)
+            {
+                return 0;
+            }
+            int period = 2 * n - 2;
+            i %= period;
+            i = i < 0 ? i + period : i;
+            return i < n ? i : period - i;
+        }
+        case BorderMode::Wrap:
+            i %= n;
+            return i < 0 ? i + n : i;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * source coordinates (see borderIndex) of first ... first + count - 1 - looked up by the border
+ * pixels so their tap loops do not branch on the mode
+ */
+static std::vector<int> borderTable(int first, int count, int n, BorderMode border)
+{
+    std::vector<int> table(count);
+    for (int i = 0; i < count; ++i)
+    {
+        table[i] = borderIndex(first + i, n, border);
+    }
+    return table;
+}
+
+/**
+ * 2D convolution engine.
+ * pixel (r,c) reads rows r + offY ... r + offY + KR - 1 and cols c + offX ... c + offX + KC - 1.
+ * every output row first resolves the source rows of its KR tap rows (mapped through the border
+ * mode, or skipped for a zero border), then
+ *  - interior columns, whose taps all fall inside the row, accumulate tap by tap across the whole
+ *    interior span: no bounds tests, unit stride, vectorizable.
+ *  - the few border columns on each side look their source column up in a table.
+ * each pixel sums its taps row by row, in kernel order.
+ * @param image
+ * @param small KR x KC kernel
+ * @param border
+ * @param res image sized result
+ */
+template<typename R, typename T>
+void convolutionBorderSplit(const BasicMatrixView<const T> &image, const ConstMatrixView &small, BorderMode border,
+                            BasicMatrix<R> &res)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    const int kr = small.getRows(), kc = small.getCols();
+    const int rows = image.getRows(), cols = image.getCols();
+    const int offY = kr / 2 - (kr - 1);
+    const int offX = kc / 2 - (kc - 1);
+    int cBegin = std::min(cols, -offX);
+    int cEnd = std::max(cBegin, cols - offX - kc + 1);
+    std::vector<int> rowIndex = borderTable(offY, rows + kr - 1, rows, border);
+    std::vector<int> colIndex = borderTable(offX, cols + kc - 1, cols, border);
+    std::vector<float> kernel(static_cast<size_t>(kr) * kc);
+    for (int i = 0; i < kr; ++i)
+    {
+        std::copy(small.row_ptr(i), small.row_ptr(i) + kc, kernel.begin() + i * kc);
+    }
+    std::vector<ScalarType> acc(cols);
+    std::vector<const T *> src(kr);
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int rs = 0; rs < kr; ++rs)
+        {
+            src[rs] = rowIndex[r + rs] < 0 ? nullptr : image.row_ptr(rowIndex[r + rs]);
+        }
+        std::fill(acc.begin() + cBegin, acc.begin() + cEnd, ScalarType(0));
+        for (int rs = 0; rs < kr; ++rs)
+        {
+            if (src[rs] == nullptr)
+            {
+                continue;
+            }
+            for (int cs = 0; cs < kc; ++cs)
+            {
+                const T *shifted = src[rs] + offX + cs;
+                ScalarType tap = kernel[rs * kc + cs];
+                for (int c = cBegin; c < cEnd; ++c)
+                {
+                    acc[c] += shifted[c] * tap;
+                }
+            }
+        }
+        auto borderPixel = [&](int c)
+        {
+            ScalarType sum = 0;
+            for (int rs = 0; rs < kr; ++rs)
+            {
+                if (src[rs] == nullptr)
+                {
+                    continue;
+                }
+                for (int cs = 0; cs < kc; ++cs)
+                {
+                    int x = colIndex[c + cs];
+                    if (x >= 0)
+                    {
+                        sum += src[rs][x] * kernel[rs * kc + cs];
+                    }
+                }
+            }
+            acc[c] = sum;
+        };
+        for (int c = 0; c < cBegin; ++c)
+        {
+            borderPixel(c);
+        }
+        for (int c = cEnd; c < cols; ++c)
+        {
+            borderPixel(c);
+        }
+        R *resRow = res.row_ptr(r);
+        for (int c = 0; c < cols; ++c)
+        {
+            resRow[c] = saturateCast<R>(std::rint(acc[c]));
+        }
+    }
+}
+
+/**
+ * horizontal pass of the separable convolution over one image row.
+ * interior columns (all taps in the row) accumulate tap by tap across the row, which vectorizes;
+ * the few border columns look their source columns up in colIndex (see borderTable).
+ * @param src image row
+ * @param cols
+ * @param taps row kernel
+ * @param kc number of taps
+ * @param colIndex source column of c + offX + j at [c + j]
+ * @param dst filtered row
+ */
+template<typename S, typename T>
+static void separableRow(const T *src, int cols, const float *taps, int kc, const int *colIndex, S *dst)
+{
+    const int offX = kc / 2 - (kc - 1);
+    int cBegin = std::min(cols, -offX);
+    int cEnd = std::max(cBegin, cols - offX - kc + 1);
+    std::fill(dst + cBegin, dst + cEnd, S(0));
+    for (int j = 0; j < kc; ++j)
+    {
+        const T *shifted = src + offX + j;
+        S tap = taps[j];
+        for (int c = cBegin; c < cEnd; ++c)
+        {
+            dst[c] += tap * shifted[c];
+        }
+    }
+    auto border = [&](int c)
+    {
+        S sum = 0;
+        for (int j = 0; j < kc; ++j)
+        {
+            if (colIndex[c + j] >= 0)
+            {
+                sum += taps[j] * src[colIndex[c + j]];
+            }
+        }
+        dst[c] = sum;
+    };
+    for (int c = 0; c < cBegin; ++c)
+    {
+        border(c);
+    }
+    for (int c = cEnd; c < cols; ++c)
+    {
+        border(c);
+    }
+}
+
+/**
+ * copies the taps of a 1D kernel (a column or a row, possibly strided) into a vector
+ */
+static std::vector<float> kernelTaps(const ConstMatrixView &kernel)
+{
+    std::vector<float> taps;
+    for (int i = 0; i < kernel.getRows(); ++i)
+    {
+        for (int j = 0; j < kernel.getCols(); ++j)
+        {
+            taps.push_back(kernel(i, j));
+        }
+    }
+    return taps;
+}
+
+/**
+ * separable convolution of a T image into R: a horizontal pass with `row`, then a vertical pass
+ * with `column` - the 2D convolution with column * row (up to float rounding).
+ * the horizontally filtered rows live in a ring of KR rows, indexed by padded row (row + KR - 1 -
+ * KR / 2), so the rows the border mode repeats past the top and bottom edges are filtered too.
+ * @param image
+ * @param column KR x 1
+ * @param row 1 x KC
+ * @param border
+ * @param res image sized result
+ */
+template<typename R, typename T>
+void convolutionSeparableInto(const BasicMatrixView<const T> &image, const ConstMatrixView &column,
+                              const ConstMatrixView &row, BorderMode border, BasicMatrix<R> &res)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    if (column.getCols() != 1 || row.getRows() != 1)
+    {
+        matrixError<std::invalid_argument>(INVALID_SEPARABLE_KERNEL);
+    }
+    std::vector<float> colTaps = kernelTaps(column), rowTaps = kernelTaps(row);
+    const int kr = column.getRows(), kc = row.getCols();
+    const int rows = image.getRows(), cols = image.getCols();
+    const int offY = kr / 2 - (kr - 1);
+    const int offX = kc / 2 - (kc - 1);
+    std::vector<int> rowIndex = borderTable(offY, rows + kr - 1, rows, border);
+    std::vector<int> colIndex = borderTable(offX, cols + kc - 1, cols, border);
+    std::vector<ScalarType> ring(static_cast<size_t>(kr) * cols);
+    std::vector<ScalarType> acc(cols);
+    int next = 0;  // next padded row to filter horizontally
+    for (int r = 0; r < rows; ++r)
+    {
+        // output row r reads the padded rows [r, r + kr)
+        for (; next < r + kr; ++next)
+        {
+            if (rowIndex[next] >= 0)
+            {
+                separableRow(image.row_ptr(rowIndex[next]), cols, rowTaps.data(), kc, colIndex.data(),
+                             &ring[static_cast<size_t>(next % kr) * cols]);
+            }
+        }
+        std::fill(acc.begin(), acc.end(), ScalarType(0));
+        for (int y = r; y < r + kr; ++y)
+        {
+            if (rowIndex[y] < 0)
+            {
+                continue;
+            }
+            const ScalarType *filtered = &ring[static_cast<size_t>(y % kr) * cols];
+            ScalarType tap = colTaps[y - r];
+            for (int c = 0; c < cols; ++c)
+            {
+                acc[c] += tap * filtered[c];
+            }
+        }
+        R *resRow = res.row_ptr(r);
+        for (int c = 0; c < cols; ++c)
+        {
+            resRow[c] = saturateCast<R>(std::rint(acc[c]));
+        }
+    }
+}
+
+/**
+ * FFT tile size along one dimension: the fast size n with the least transform work to cover
+ * `padded` input pixels in blocks of n - k + 1 - either a single block, or n >= 2k (blocks of at
+ * least k + 1, so the overlap-add spill of a block only reaches the next one, and the padding
+ * stays under half the transform).
+ * @param k kernel length
+ * @param padded input length (image plus kernel - 1)
+ * @return
+ */
+static int fftTileSize(int k, int padded)
+{
+    int single = fftSize(padded + k - 1);
+    int best = single;
+    double bestCost = single * std::log2(single);
+    for (int n = fftSize(std::max(2 * k, FFT_CONVOLUTION_MIN_TILE)); n < single && n <= FFT_CONVOLUTION_MAX_TILE;
+         n = fftSize(n + 1))
+    {
+        int block = n - k + 1;
+        int blocks = (padded + block - 1) / block;
+        double cost = blocks * n * std::log2(n);
+        if (cost < bestCost)
+        {
+            best = n;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+/**
+ * 2D transform of a nr x nc row major block: row transforms, then column transforms (the inverse
+ * runs them the other way around). rows past usedRows are zero and skipped by the forward pass.
+ */
+static void fft2(std::complex<double> *z, int nr, int nc, int usedRows, const FFTPlan &colPlan,
+                 const FFTPlan &rowPlan, bool inverse, std::complex<double> *scratch, std::complex<double> *column)
+{
+    auto rowsPass = [&](int count)
+    {
+        for (int y = 0; y < count; ++y)
+        {
+            inverse ? rowPlan.inverse(z + static_cast<long>(y) * nc, scratch) :
+                      rowPlan.forward(z + static_cast<long>(y) * nc, scratch);
+        }
+    };
+    if (!inverse)
+    {
+        rowsPass(usedRows);
+    }
+    for (int x = 0; x < nc; ++x)
+    {
+        for (int y = 0; y < nr; ++y)
+        {
+            column[y] = z[static_cast<long>(y) * nc + x];
+        }
+        inverse ? colPlan.inverse(column, scratch) : colPlan.forward(column, scratch);
+        for (int y = 0; y < nr; ++y)
+        {
+            z[static_cast<long>(y) * nc + x] = column[y];
+        }
+    }
+    if (inverse)
+    {
+        rowsPass(nr);
+    }
+}
+
+/**
+ * FFT convolution of a T image into R, by overlap-add.
+ * the image, extended by the border mode to (rows + KR - 1) x (cols + KC - 1), is cut into
+ * blocks; each block is transformed (nr x nc, fast sizes picked by fftTileSize), multiplied by the
+ * spectrum of the flipped kernel, transformed back, and its full convolution added into the
+ * result. two real blocks share one complex transform (one as the real part, one as the imaginary
+ * part - the kernel is real, so their results come back separated the same way).
+ * rows of blocks are split between threads in two phases (even rows, then odd rows), so no two
+ * threads add into the same pixels at the same time.
+ * @param image
+ * @param small KR x KC kernel
+ * @param border
+ * @param res image sized result
+ * @param threads
+ */
+template<typename R, typename T>
+void convolutionFFTInto(const BasicMatrixView<const T> &image, const ConstMatrixView &small, BorderMode border,
+                        BasicMatrix<R> &res, int threads)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    typedef std::complex<double> Complex;
+    const int kr = small.getRows(), kc = small.getCols();
+    const int rows = image.getRows(), cols = image.getCols();
+    const int padRows = rows + kr - 1, padCols = cols + kc - 1;
+    std::vector<int> rowIndex = borderTable(kr / 2 - (kr - 1), padRows, rows, border);
+    std::vector<int> colIndex = borderTable(kc / 2 - (kc - 1), padCols, cols, border);
+    const int nr = fftTileSize(kr, padRows), nc = fftTileSize(kc, padCols);
+    const int br = nr - kr + 1, bc = nc - kc + 1;
+    const int bandsR = (padRows + br - 1) / br, bandsC = (padCols + bc - 1) / bc;
+    FFTPlan colPlan(nr), rowPlan(nc);
+
+    // spectrum of the flipped kernel (convolution() correlates), normalization folded in
+    std::vector<Complex> spectrum(static_cast<size_t>(nr) * nc);
+    std::vector<Complex> scratch(std::max(nr, nc)), column(nr);
+    for (int a = 0; a < kr; ++a)
+    {
+        for (int b = 0; b < kc; ++b)
+        {
+            spectrum[static_cast<size_t>(a) * nc + b] = small(kr - 1 - a, kc - 1 - b) / (static_cast<double>(nr) * nc);
+        }
+    }
+    fft2(spectrum.data(), nr, nc, kr, colPlan, rowPlan, false, scratch.data(), column.data());
+
+    // block (tr, tc) covers padded pixels from (tr * br, tc * bc); its full convolution pixel
+    // (y, x) is result pixel (tr * br + y - (kr - 1), tc * bc + x - (kc - 1))
+    std::vector<ScalarType> acc(static_cast<size_t>(rows) * cols, ScalarType(0));
+    auto band = [&](int tr, Complex *z, Complex *work, Complex *col)
+    {
+        const int top = tr * br;
+        const int usedRows = std::min(br, padRows - top);
+        for (int tc = 0; tc < bandsC; tc += 2)
+        {
+            const int left[2] = {tc * bc, (tc + 1) * bc};
+            std::fill(z, z + static_cast<size_t>(nr) * nc, Complex(0));
+            for (int y = 0; y < usedRows; ++y)
+            {
+                int srcRow = rowIndex[top + y];
+                if (srcRow < 0)
+                {
+                    continue;
+                }
+                const T *src = image.row_ptr(srcRow);
+                Complex *dst = z + static_cast<size_t>(y) * nc;
+                for (int half = 0; half < 2 && tc + half < bandsC; ++half)
+                {
+                    int usedCols = std::min(bc, padCols - left[half]);
+                    for (int x = 0; x < usedCols; ++x)
+                    {
+                        int srcCol = colIndex[left[half] + x];
+                        double value = srcCol < 0 ? 0.0 : static_cast<double>(src[srcCol]);
+                        dst[x] += half == 0 ? Complex(value, 0) : Complex(0, value);
+                    }
+                }
+            }
+            fft2(z, nr, nc, usedRows, colPlan, rowPlan, false, work, col);
+            for (size_t i = 0; i < static_cast<size_t>(nr) * nc; ++i)
+            {
+                // written out - std::complex's operator* is a library call per product
+                z[i] = Complex(z[i].real() * spectrum[i].real() - z[i].imag() * spectrum[i].imag(),
+                               z[i].real() * spectrum[i].imag() + z[i].imag() * spectrum[i].real());
+            }
+            fft2(z, nr, nc, nr, colPlan, rowPlan, true, work, col);
+            for (int y = 0; y < nr; ++y)
+            {
+                int r = top + y - (kr - 1);
+                if (r < 0 || r >= rows)
+                {
+                    continue;
+                }
+                const Complex *full = z + static_cast<size_t>(y) * nc;
+                ScalarType *out = &acc[static_cast<size_t>(r) * cols];
+                for (int half = 0; half < 2 && tc + half < bandsC; ++half)
+                {
+                    int xBegin = std::max(0, kc - 1 - left[half]);
+                    int xEnd = std::min(nc, cols + kc - 1 - left[half]);
+                    for (int x = xBegin; x < xEnd; ++x)
+                    {
+                        out[left[half] + x - (kc - 1)] += static_cast<ScalarType>(
+                                half == 0 ? full[x].real() : full[x].imag());
+                    }
+                }
+            }
+        }
+    };
+    long work = static_cast<long>(bandsR) * bandsC * nr * nc * 16;
+    for (int phase = 0; phase < 2; ++phase)
+    {
+        int count = (bandsR - phase + 1) / 2;
+        parallelFor(0, count, resolveThreadCount(threads, work), [&](int begin, int end)
+        {
+            std::vector<Complex> z(static_cast<size_t>(nr) * nc), work(std::max(nr, nc)), col(nr);
+            for (int i = begin; i < end; ++i)
+            {
+                band(phase + 2 * i, z.data(), work.data(), col.data());
+            }
+        });
+    }
+    for (int r = 0; r < rows; ++r)
+    {
+        const ScalarType *sum = &acc[static_cast<size_t>(r) * cols];
+        R *resRow = res.row_ptr(r);
+        for (int c = 0; c < cols; ++c)
+        {
+            resRow[c] = saturateCast<R>(std::rint(sum[c]));
+        }
+    }
+}
+
+/**
+ * convolution of a T image, rounding each pixel and storing it as R.
+ * R may differ from T so intermediate (e.g sobel) responses of 8 bit images keep their sign.
+ * rank 1 kernels (blur, sobel, box, gaussian) run as two 1D passes, other kernels of at least
+ * FFT_CONVOLUTION_MIN_TAPS taps through the FFT and the rest through convolutionBorderSplit.
+ * @param image
+ * @param small
+ * @param border
+ * @param threads threads of the FFT path
+ * @return matrix after convolution
+ */
+template<typename R, typename T>
+BasicMatrix<R> convolutionAs(const BasicMatrixView<const T> &image, const ConstMatrixView &small,
+                             BorderMode border = BorderMode::Zero, int threads = 0)
+{
+    // create result matrix :
+    BasicMatrix<R> res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    Matrix column, row;
+    if (small.getRows() > 1 && small.getCols() > 1 && separateKernel(small, column, row))
+    {
+        convolutionSeparableInto(image, column, row, border, res);
+    }
+    else if (small.getRows() * small.getCols() >= FFT_CONVOLUTION_MIN_TAPS)
+    {
+        convolutionFFTInto(image, small, border, res, threads);
+    }
+    else
+    {
+        convolutionBorderSplit(image, small, border, res);
+    }
+    return res;
+}
+
+/**
+ * this func does the convolution process
+ * @param image
+ * @param small
+ * @param border
+ * @param threads
+ * @return matrix after convolution
+ */
+Matrix convolution(const ConstMatrixView &image, const ConstMatrixView &small, BorderMode border, int threads)
+{
+    return convolutionAs<float, float>(image, small, border, threads);
+}
+
+/**
+ * convolution of an 8 bit image.
+ * sums are accumulated in float and rounded + saturated to [0,255] once per pixel.
+ * @param image
+ * @param small
+ * @param border
+ * @param threads
+ * @return matrix after convolution
+ */
+ByteMatrix convolution(const ConstByteMatrixView &image, const ConstMatrixView &small, BorderMode border,
+                       int threads)
+{
+    return convolutionAs<uint8_t, uint8_t>(image, small, border, threads);
+}
+
+/**
+ * FFT convolution
+ * @param image
+ * @param small
+ * @param border
+ * @param threads
+ * @return matrix after convolution
+ */
+Matrix convolutionFFT(const ConstMatrixView &image, const ConstMatrixView &small, BorderMode border, int threads)
+{
+    Matrix res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    convolutionFFTInto(image, small, border, res, threads);
+    return res;
+}
+
+/**
+ * FFT convolution of an 8 bit image
+ * @param image
+ * @param small
+ * @param border
+ * @param threads
+ * @return matrix after convolution
+ */
+ByteMatrix convolutionFFT(const ConstByteMatrixView &image, const ConstMatrixView &small, BorderMode border,
+                          int threads)
+{
+    ByteMatrix res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    convolutionFFTInto(image, small, border, res, threads);
+    return res;
+}
+
+/**
+ * separable convolution
+ * @param image
+ * @param column
+ * @param row
+ * @param border
+ * @return matrix after convolution
+ */
+Matrix convolutionSeparable(const ConstMatrixView &image, const ConstMatrixView &column, const ConstMatrixView &row,
+                            BorderMode border)
+{
+    Matrix res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    convolutionSeparableInto(image, column, row, border, res);
+    return res;
+}
+
+/**
+ * separable convolution of an 8 bit image
+ * @param image
+ * @param column
+ * @param row
+ * @param border
+ * @return matrix after convolution
+ */
+ByteMatrix convolutionSeparable(const ConstByteMatrixView &image, const ConstMatrixView &column,
+                                const ConstMatrixView &row, BorderMode border)
+{
+    ByteMatrix res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    convolutionSeparableInto(image, column, row, border, res);
+    return res;
+}
+
+/**
+ * splits a rank 1 kernel into column * row: the column through the largest tap, and the row
+ * through it divided by that tap, then every tap is checked against the product.
+ * @param kernel
+ * @param column
+ * @param row
+ * @return true if separable
+ */
+bool separateKernel(const ConstMatrixView &kernel, Matrix &column, Matrix &row)
+{
+    int pr = 0, pc = 0;
+    for (int i = 0; i < kernel.getRows(); ++i)
+    {
+        for (int j = 0; j < kernel.getCols(); ++j)
+        {
+            if (std::fabs(kernel(i, j)) > std::fabs(kernel(pr, pc)))
+            {
+                pr = i;
+                pc = j;
+            }
+        }
+    }
+    float pivot = kernel(pr, pc);
+    if (pivot == 0)
+    {
+        return false;
+    }
+    Matrix u(kernel.getRows(), 1), v(1, kernel.getCols());
+    for (int i = 0; i < kernel.getRows(); ++i)
+    {
+        u(i, 0) = kernel(i, pc);
+    }
+    for (int j = 0; j < kernel.getCols(); ++j)
+    {
+        v(0, j) = kernel(pr, j) / pivot;
+    }
+    const float tolerance = 1e-6f * std::fabs(pivot);
+    for (int i = 0; i < kernel.getRows(); ++i)
+    {
+        for (int j = 0; j < kernel.getCols(); ++j)
+        {
+            if (std::fabs(kernel(i, j) - u(i, 0) * v(0, j)) > tolerance)
+            {
+                return false;
+            }
+        }
+    }
+    column = std::move(u);
+    row = std::move(v);
+    return true;
+}
+
+/**
+ * sampled, normalized gaussian
+ * @param sigma
+ * @return 1 x (2 * radius + 1) row kernel
+ */
+Matrix gaussianKernel(float sigma)
+{
+    if (!(sigma > 0))
+    {
+        matrixError<std::invalid_argument>(INVALID_SIGMA);
+    }
+    int radius = std::max(1, static_cast<int>(std::ceil(GAUSSIAN_KERNEL_SIGMAS * sigma)));
+    Matrix kernel(1, 2 * radius + 1);
+    double total = 0;
+    for (int i = -radius; i <= radius; ++i)
+    {
+        total += std::exp(-0.5 * i * i / (static_cast<double>(sigma) * sigma));
+    }
+    for (int i = -radius; i <= radius; ++i)
+    {
+        kernel(0, i + radius) = static_cast<float>(std::exp(-0.5 * i * i / (static_cast<double>(sigma) * sigma)) / total);
+    }
+    return kernel;
+}
+
+/**
+ * Gaussian Blurring of any sigma
+ * @param image
+ * @param sigma
+ * @param border
+ * @return
+ */
+Matrix gaussian_blur(const ConstMatrixView &image, float sigma, BorderMode border)
+{
+    Matrix row = gaussianKernel(sigma);
+    Matrix res = convolutionSeparable(image, row.transpose(), row, border);
+    return makeMatrixInBounds(image.getRows() * image.getCols(), res);
+}
+
+/**
+ * Gaussian Blurring of any sigma of an 8 bit image
+ * @param image
+ * @param sigma
+ * @param border
+ * @return
+ */
+ByteMatrix gaussian_blur(const ConstByteMatrixView &image, float sigma, BorderMode border)
+{
+    Matrix row = gaussianKernel(sigma);
+    return convolutionSeparable(image, row.transpose(), row, border);
+}
+
+/**
+ * one row of a summed area table: dst[c + 1] = above[c + 1] + sum of the (squared) pixels
+ * src[colIndex[0 .. c]] (-1 entries are zero), dst[0] = 0
+ */
+template<bool Squared, typename T>
+static void integralRow(const T *src, const int *colIndex, int cols, const double *above, double *dst)
+{
+    double sum = 0;
+    dst[0] = 0;
+    for (int c = 0; c < cols; ++c)
+    {
+        double value = colIndex[c] >= 0 ? static_cast<double>(src[colIndex[c]]) : 0.0;
+        sum += Squared ? value * value : value;
+        dst[c + 1] = above[c + 1] + sum;
+    }
+}
+
+/**
+ * summed area table of the image as seen through the row and column tables (the source row / col
+ * of every bordered coordinate, -1 for zero): res(i, j) = sum of the (squared) bordered pixels
+ * above and left of (i, j).
+ * on one thread each row is summed onto the row above in a single pass; with more, rows are
+ * prefix summed in parallel, then added down in parallel column bands.
+ * @param image
+ * @param rowIndex
+ * @param colIndex
+ * @param squared sum the squares of the pixels
+ * @param threads
+ * @return (rowIndex.size() + 1) x (colIndex.size() + 1) table
+ */
+template<typename T>
+static DoubleMatrix integralOf(const BasicMatrixView<const T> &image, const std::vector<int> &rowIndex,
+                               const std::vector<int> &colIndex, bool squared, int threads)
+{
+    const int rows = static_cast<int>(rowIndex.size()), cols = static_cast<int>(colIndex.size());
+    DoubleMatrix res(rows + 1, cols + 1, MatrixInit::Uninitialized);
+    const double *zeros = res.row_ptr(0);
+    std::fill(res.row_ptr(0), res.row_ptr(0) + cols + 1, 0.0);
+    const int count = resolveThreadCount(threads, static_cast<long>(rows) * cols);
+    auto sumRow = [&](int r, const double *above)
+    {
+        double *dst = res.row_ptr(r + 1);
+        if (rowIndex[r] < 0)
+        {
+            std::copy(above, above + cols + 1, dst);
+        }
+        else if (squared)
+        {
+            integralRow<true>(image.row_ptr(rowIndex[r]), colIndex.data(), cols, above, dst);
+        }
+        else
+        {
+            integralRow<false>(image.row_ptr(rowIndex[r]), colIndex.data(), cols, above, dst);
+        }
+    };
+    if (count == 1)
+    {
+        for (int r = 0; r < rows; ++r)
+        {
+            sumRow(r, res.row_ptr(r));
+        }
+        return res;
+    }
+    parallelFor(0, rows, count, [&](int begin, int end)
+    {
+        for (int r = begin; r < end; ++r)
+        {
+            sumRow(r, zeros);
+        }
+    });
+    parallelFor(1, cols + 1, count, [&](int begin, int end)
+    {
+        for (int r = 1; r < rows; ++r)
+        {
+            const double *above = res.row_ptr(r);
+            double *dst = res.row_ptr(r + 1);
+            for (int c = begin; c < end; ++c)
+            {
+                dst[c] += above[c];
+            }
+        }
+    });
+    return res;
+}
+
+/**
+ * summed area table of the image itself
+ */
+template<typename T>
+static DoubleMatrix integralImageT(const BasicMatrixView<const T> &image, bool squared, int threads)
+{
+    return integralOf(image, borderTable(0, image.getRows(), image.getRows(), BorderMode::Zero),
+                      borderTable(0, image.getCols(), image.getCols(), BorderMode::Zero), squared, threads);
+}
+
+/**
+ * what windowFilter computes per window
+ */
+enum class WindowStatistic
+{
+    Sum,
+    Mean,
+    Variance
+};
+
+/**
+ * box / mean / variance of the height x width window around every pixel, from integral images of
+ * the image bordered by (height - 1) rows and (width - 1) cols: window (r, c) of the result is
+ * rows r ... r + height - 1 and cols c ... c + width - 1 of the bordered image.
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param statistic
+ * @param threads
+ * @return
+ */
+template<typename T>
+static Matrix windowFilter(const BasicMatrixView<const T> &image, int height, int width, BorderMode border,
+                           WindowStatistic statistic, int threads)
+{
+    if (height < 1 || width < 1)
+    {
+        matrixError<std::invalid_argument>(INVALID_WINDOW);
+    }
+    const int rows = image.getRows(), cols = image.getCols();
+    if (rows == 0 || cols == 0)
+    {
+        // nothing to border - an empty image has an empty result
+        return Matrix(rows, cols);
+    }
+    std::vector<int> rowIndex = borderTable(height / 2 - (height - 1), rows + height - 1, rows, border);
+    std::vector<int> colIndex = borderTable(width / 2 - (width - 1), cols + width - 1, cols, border);
+    DoubleMatrix sums = integralOf(image, rowIndex, colIndex, false, threads);
+    DoubleMatrix squares;
+    if (statistic == WindowStatistic::Variance)
+    {
+        squares = integralOf(image, rowIndex, colIndex, true, threads);
+    }
+    // sums of the windows of a row: bottom[c + width] - bottom[c] - top[c + width] + top[c]
+    const double scale = statistic == WindowStatistic::Sum ? 1.0 : 1.0 / (static_cast<double>(height) * width);
+    Matrix res(rows, cols, MatrixInit::Uninitialized);
+    parallelFor(0, rows, resolveThreadCount(threads, static_cast<long>(rows) * cols), [&](int begin, int end)
+    {
+        for (int r = begin; r < end; ++r)
+        {
+            const double *top = sums.row_ptr(r), *bottom = sums.row_ptr(r + height);
+            float *resRow = res.row_ptr(r);
+            if (statistic != WindowStatistic::Variance)
+            {
+                for (int c = 0; c < cols; ++c)
+                {
+                    resRow[c] = static_cast<float>((bottom[c + width] - bottom[c] - top[c + width] + top[c]) * scale);
+                }
+                continue;
+            }
+            const double *squareTop = squares.row_ptr(r), *squareBottom = squares.row_ptr(r + height);
+            for (int c = 0; c < cols; ++c)
+            {
+                double mean = (bottom[c + width] - bottom[c] - top[c + width] + top[c]) * scale;
+                double meanSquare = (squareBottom[c + width] - squareBottom[c] - squareTop[c + width] + squareTop[c]) *
+                                    scale;
+                resRow[c] = static_cast<float>(std::max(0.0, meanSquare - mean * mean));
+            }
+        }
+    });
+    return res;
+}
+
+/**
+ * summed area table
+ * @param image
+ * @param threads
+ * @return
+ */
+DoubleMatrix integralImage(const ConstMatrixView &image, int threads)
+{
+    return integralImageT(image, false, threads);
+}
+
+/**
+ * summed area table of an 8 bit image
+ * @param image
+ * @param threads
+ * @return
+ */
+DoubleMatrix integralImage(const ConstByteMatrixView &image, int threads)
+{
+    return integralImageT(image, false, threads);
+}
+
+/**
+ * summed area table of the squared pixels
+ * @param image
+ * @param threads
+ * @return
+ */
+DoubleMatrix squaredIntegralImage(const ConstMatrixView &image, int threads)
+{
+    return integralImageT(image, true, threads);
+}
+
+/**
+ * summed area table of the squared pixels of an 8 bit image
+ * @param image
+ * @param threads
+ * @return
+ */
+DoubleMatrix squaredIntegralImage(const ConstByteMatrixView &image, int threads)
+{
+    return integralImageT(image, true, threads);
+}
+
+/**
+ * box filter
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads
+ * @return
+ */
+Matrix boxFilter(const ConstMatrixView &image, int height, int width, BorderMode border, int threads)
+{
+    return windowFilter(image, height, width, border, WindowStatistic::Sum, threads);
+}
+
+/**
+ * box filter of an 8 bit image
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads
+ * @return
+ */
+Matrix boxFilter(const ConstByteMatrixView &image, int height, int width, BorderMode border, int threads)
+{
+    return windowFilter(image, height, width, border, WindowStatistic::Sum, threads);
+}
+
+/**
+ * window means
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads
+ * @return
+ */
+Matrix meanFilter(const ConstMatrixView &image, int height, int width, BorderMode border, int threads)
+{
+    return windowFilter(image, height, width, border, WindowStatistic::Mean, threads);
+}
+
+/**
+ * window means of an 8 bit image
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads
+ * @return
+ */
+Matrix meanFilter(const ConstByteMatrixView &image, int height, int width, BorderMode border, int threads)
+{
+    return windowFilter(image, height, width, border, WindowStatistic::Mean, threads);
+}
+
+/**
+ * window variances
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads
+ * @return
+ */
+Matrix varianceFilter(const ConstMatrixView &image, int height, int width, BorderMode border, int threads)
+{
+    return windowFilter(image, height, width, border, WindowStatistic::Variance, threads);
+}
+
+/**
+ * window variances of an 8 bit image
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads
+ * @return
+ */
+Matrix varianceFilter(const ConstByteMatrixView &image, int height, int width, BorderMode border, int threads)
+{
+    return windowFilter(image, height, width, border, WindowStatistic::Variance, threads);
+}
+
+/**
+ * min (Max false) or max of two pixels
+ */
+template<bool Max>
+static inline uint8_t extreme(uint8_t a, uint8_t b)
+{
+    return Max ? std::max(a, b) : std::min(a, b);
+}
+
+/**
+ * van Herk / Gil-Werman over a padded line of n + k - 1 pixels: dst[x] = extreme of
+ * line[x ... x + k - 1]. the line is cut in blocks of k; forward[i] is the extreme from the start
+ * of i's block to i, backward[i] from i to the end of its block, so every window, which spans at
+ * most two blocks, is extreme(backward[x], forward[x + k - 1]).
+ */
+template<bool Max>
+static void vanHerkLine(const uint8_t *line, int n, int k, uint8_t *forward, uint8_t *backward, uint8_t *dst)
+{
+    const int length = n + k - 1;
+    for (int start = 0; start < length; start += k)
+    {
+        const int end = std::min(length, start + k);
+        forward[start] = line[start];
+        for (int i = start + 1; i < end; ++i)
+        {
+            forward[i] = extreme<Max>(forward[i - 1], line[i]);
+        }
+        backward[end - 1] = line[end - 1];
+        for (int i = end - 2; i >= start; --i)
+        {
+            backward[i] = extreme<Max>(backward[i + 1], line[i]);
+        }
+    }
+    for (int x = 0; x < n; ++x)
+    {
+        dst[x] = extreme<Max>(backward[x], forward[x + k - 1]);
+    }
+}
+
+/**
+ * erosion (Max false) or dilation of an 8 bit image by a height x width rectangle.
+ * row pass: vanHerkLine on every (padded) row. column pass: the same recurrences with whole rows
+ * of a column band as the elements, so each step is an element wise min / max of two rows.
+ * padding is the neutral value (255 for min, 0 for max).
+ * @param image
+ * @param height
+ * @param width
+ * @param threads
+ * @return
+ */
+template<bool Max>
+static ByteMatrix rankExtreme(const ConstByteMatrixView &image, int height, int width, int threads)
+{
+    if (height < 1 || width < 1)
+    {
+        matrixError<std::invalid_argument>(INVALID_WINDOW);
+    }
+    const uint8_t neutral = Max ? 0 : 255;
+    const int rows = image.getRows(), cols = image.getCols();
+    const int count = resolveThreadCount(threads, static_cast<long>(rows) * cols * 6);
+    ByteMatrix across(rows, cols, MatrixInit::Uninitialized), res(rows, cols, MatrixInit::Uninitialized);
+    parallelFor(0, rows, count, [&](int begin, int end)
+    {
+        const int before = width - 1 - width / 2;
+        std::vector<uint8_t> line(cols + width - 1, neutral), forward(line.size()), backward(line.size());
+        for (int r = begin; r < end; ++r)
+        {
+            std::copy(image.row_ptr(r), image.row_ptr(r) + cols, line.begin() + before);
+            vanHerkLine<Max>(line.data(), cols, width, forward.data(), backward.data(), across.row_ptr(r));
+        }
+    });
+    parallelFor(0, cols, count, [&](int begin, int end)
+    {
+        const int band = end - begin, before = height - 1 - height / 2, length = rows + height - 1;
+        std::vector<uint8_t> neutralRow(band, neutral);
+        std::vector<uint8_t> forward(static_cast<size_t>(length) * band), backward(forward.size());
+        auto padded = [&](int i)
+        {
+            int y = i - before;
+            return y >= 0 && y < rows ? across.row_ptr(y) + begin : neutralRow.data();
+        };
+        for (int start = 0; start < length; start += height)
+        {
+            const int end = std::min(length, start + height);
+            std::copy(padded(start), padded(start) + band, &forward[static_cast<size_t>(start) * band]);
+            for (int i = start + 1; i < end; ++i)
+            {
+                const uint8_t *src = padded(i), *previous = &forward[static_cast<size_t>(i - 1) * band];
+                uint8_t *dst = &forward[static_cast<size_t>(i) * band];
+                for (int c = 0; c < band; ++c)
+                {
+                    dst[c] = extreme<Max>(previous[c], src[c]);
+                }
+            }
+            std::copy(padded(end - 1), padded(end - 1) + band, &backward[static_cast<size_t>(end - 1) * band]);
+            for (int i = end - 2; i >= start; --i)
+            {
+                const uint8_t *src = padded(i), *next = &backward[static_cast<size_t>(i + 1) * band];
+                uint8_t *dst = &backward[static_cast<size_t>(i) * band];
+                for (int c = 0; c < band; ++c)
+                {
+                    dst[c] = extreme<Max>(next[c], src[c]);
+                }
+            }
+        }
+        for (int r = 0; r < rows; ++r)
+        {
+            const uint8_t *top = &backward[static_cast<size_t>(r) * band];
+            const uint8_t *bottom = &forward[static_cast<size_t>(r + height - 1) * band];
+            uint8_t *dst = res.row_ptr(r) + begin;
+            for (int c = 0; c < band; ++c)
+            {
+                dst[c] = extreme<Max>(top[c], bottom[c]);
+            }
+        }
+    });
+    return res;
+}
+
+/**
+ * erosion
+ * @param image
+ * @param height
+ * @param width
+ * @param threads
+ * @return
+ */
+ByteMatrix erode(const ConstByteMatrixView &image, int height, int width, int threads)
+{
+    return rankExtreme<false>(image, height, width, threads);
+}
+
+/**
+ * dilation
+ * @param image
+ * @param height
+ * @param width
+ * @param threads
+ * @return
+ */
+ByteMatrix dilate(const ConstByteMatrixView &image, int height, int width, int threads)
+{
+    return rankExtreme<true>(image, height, width, threads);
+}
+
+/**
+ * opening
+ * @param image
+ * @param height
+ * @param width
+ * @param threads
+ * @return
+ */
+ByteMatrix morphologyOpen(const ConstByteMatrixView &image, int height, int width, int threads)
+{
+    return dilate(erode(image, height, width, threads), height, width, threads);
+}
+
+/**
+ * closing
+ * @param image
+ * @param height
+ * @param width
+ * @param threads
+ * @return
+ */
+ByteMatrix morphologyClose(const ConstByteMatrixView &image, int height, int width, int threads)
+{
+    return erode(dilate(image, height, width, threads), height, width, threads);
+}
+
+/**
+ * histogram += (or -=) another, n bins
+ */
+static inline void addBins(uint32_t *histogram, const uint32_t *other, int n, bool subtract)
+{
+    if (subtract)
+    {
+        for (int b = 0; b < n; ++b)
+        {
+            histogram[b] -= other[b];
+        }
+        return;
+    }
+    for (int b = 0; b < n; ++b)
+    {
+        histogram[b] += other[b];
+    }
+}
+
+/**
+ * median filter (Perreault - Hebert).
+ * bordered coordinates map to source rows / cols through borderTable, zero border pixels count as
+ * 0, so every window holds exactly height * width values. the image is swept in stripes of
+ * MEDIAN_STRIPE output columns; each thread keeps, for its rows, the histograms of the stripe's
+ * bordered columns over the window rows - 256 fine bins and 16 coarse ones (the counts of each 16
+ * values) - sliding them down one row at a time.
+ * along a row, the coarse window histogram is slid every pixel (16 bins in, 16 out) and finds the
+ * 16 values holding the median; only the fine segment of those 16 values is then brought up to
+ * date, from the column it was last used at (or rebuilt if that is half a window away) - the
+ * median rarely changes segment, so this is a few bins per pixel instead of 256.
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads
+ * @return
+ */
+static ByteMatrix medianT(const ConstByteMatrixView &image, int height, int width, BorderMode border, int threads)
+{
+    if (height < 1 || width < 1)
+    {
+        matrixError<std::invalid_argument>(INVALID_WINDOW);
+    }
+    const int rows = image.getRows(), cols = image.getCols();
+    if (rows == 0 || cols == 0)
+    {
+        return ByteMatrix(rows, cols);
+    }
+    const std::vector<int> rowIndex = borderTable(height / 2 - (height - 1), rows + height - 1, rows, border);
+    const std::vector<int> colIndex = borderTable(width / 2 - (width - 1), cols + width - 1, cols, border);
+    const uint32_t rank = static_cast<uint32_t>((static_cast<long>(height) * width - 1) / 2);
+    ByteMatrix res(rows, cols, MatrixInit::Uninitialized);
+    const long work = static_cast<long>(rows) * cols * 16;
+    parallelFor(0, rows, resolveThreadCount(threads, work), [&](int begin, int end)
+    {
+        // fine histograms are MEDIAN_FINE_STRIDE bins apart - 1KB apart, the counters of
+        // neighbouring columns for similar values would be 4KB aliases and stall each other's loads
+        const size_t stripeColumns = static_cast<size_t>(std::min(cols, MEDIAN_STRIPE)) + width - 1;
+        std::vector<uint32_t> fine(stripeColumns * MEDIAN_FINE_STRIDE), coarse(stripeColumns * 16);
+        uint32_t windowFine[256], windowCoarse[16];
+        int upToDate[16];  // stripe column each fine segment was last brought to
+        for (int c0 = 0; c0 < cols; c0 += MEDIAN_STRIPE)
+        {
+            // bordered columns c0 ... c0 + count - 1, histogram j is bordered column c0 + j
+            const int stripe = std::min(cols - c0, MEDIAN_STRIPE), count = stripe + width - 1;
+            const int *source = colIndex.data() + c0;
+            std::fill(fine.begin(), fine.end(), 0);
+            std::fill(coarse.begin(), coarse.end(), 0);
+            auto addRow = [&](int y, uint32_t delta)
+            {
+                const uint8_t *src = rowIndex[y] >= 0 ? image.row_ptr(rowIndex[y]) : nullptr;
+                for (int j = 0; j < count; ++j)
+                {
+                    uint8_t v = src != nullptr && source[j] >= 0 ? src[source[j]] : 0;
+                    fine[static_cast<size_t>(j) * MEDIAN_FINE_STRIDE + v] += delta;
+                    coarse[static_cast<size_t>(j) * 16 + (v >> 4)] += delta;
+                }
+            };
+            for (int y = begin; y < begin + height; ++y)
+            {
+                addRow(y, 1);
+            }
+            for (int r = begin; r < end; ++r)
+            {
+                if (r > begin)
+                {
+                    addRow(r - 1, static_cast<uint32_t>(-1));
+                    addRow(r + height - 1, 1);
+                }
+                std::fill(windowCoarse, windowCoarse + 16, 0);
+                for (int j = 0; j < width; ++j)
+                {
+                    addBins(windowCoarse, &coarse[static_cast<size_t>(j) * 16], 16, false);
+                }
+                std::fill(upToDate, upToDate + 16, -width);
+                uint8_t *dst = res.row_ptr(r) + c0;
+                for (int c = 0; c < stripe; ++c)
+                {
+                    if (c > 0)
+                    {
+                        addBins(windowCoarse, &coarse[static_cast<size_t>(c + width - 1) * 16], 16, false);
+                        addBins(windowCoarse, &coarse[static_cast<size_t>(c - 1) * 16], 16, true);
+                    }
+                    uint32_t seen = 0;
+                    int segment = 0;
+                    while (seen + windowCoarse[segment] <= rank)
+                    {
+                        seen += windowCoarse[segment++];
+                    }
+                    uint32_t *bins = windowFine + 16 * segment;
+                    auto columnSegment = [&](int j)
+                    {
+                        return &fine[static_cast<size_t>(j) * MEDIAN_FINE_STRIDE + 16 * segment];
+                    };
+                    if (2 * (c - upToDate[segment]) > width)
+                    {
+                        std::fill(bins, bins + 16, 0);
+                        for (int j = c; j < c + width; ++j)
+                        {
+                            addBins(bins, columnSegment(j), 16, false);
+                        }
+                    }
+                    else
+                    {
+                        for (int k = upToDate[segment] + 1; k <= c; ++k)
+                        {
+                            addBins(bins, columnSegment(k + width - 1), 16, false);
+                            addBins(bins, columnSegment(k - 1), 16, true);
+                        }
+                    }
+                    upToDate[segment] = c;
+                    int value = 0;
+                    while (seen + bins[value] <= rank)
+                    {
+                        seen += bins[value++];
+                    }
+                    dst[c] = static_cast<uint8_t>(16 * segment + value);
+                }
+            }
+        }
+    });
+    return res;
+}
+
+/**
+ * median filter
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads
+ * @return
+ */
+ByteMatrix medianFilter(const ConstByteMatrixView &image, int height, int width, BorderMode border, int threads)
+{
+    return medianT(image, height, width, border, threads);
+}
+
+/**
+ * clamps a blurred float pixel to [0,255] the way blur() does (makeMatrixInBounds); 8 bit pixels
+ * are already saturated by saturateCast
+ */
+static inline float blurBounds(float value)
+{
+    return value > 255 ? 255 : (value < 0 ? 0 : value);
+}
+
+/**
+ * see blurBounds
+ */
+static inline uint8_t blurBounds(uint8_t value)
+{
+    return value;
+}
+
+/**
+ * the horizontal [1 2 1] / 4 pass of blur() at the even columns of a row only, with the same
+ * taps in the same order (so the same float rounding)
+ * @param src image row
+ * @param cols image cols
+ * @param dst (cols + 1) / 2 filtered pixels
+ */
+template<typename S, typename T>
+static void pyramidDownRow(const T *src, int cols, S *dst)
+{
+    const S t0 = GAUSSIAN_BLUR_ROW(0, 0), t1 = GAUSSIAN_BLUR_ROW(0, 1), t2 = GAUSSIAN_BLUR_ROW(0, 2);
+    const int outCols = (cols + 1) / 2;
+    // column 0 has no left neighbour, column 2 * o + 1 must exist for the middle ones
+    const int inner = std::max(1, (cols - 1) / 2);
+    for (int o = 1; o < inner; ++o)
+    {
+        S sum = 0;
+        sum += t0 * src[2 * o - 1];
+        sum += t1 * src[2 * o];
+        sum += t2 * src[2 * o + 1];
+        dst[o] = sum;
+    }
+    auto border = [&](int o)
+    {
+        const int c = 2 * o;
+        S sum = 0;
+        if (c > 0)
+        {
+            sum += t0 * src[c - 1];
+        }
+        sum += t1 * src[c];
+        if (c + 1 < cols)
+        {
+            sum += t2 * src[c + 1];
+        }
+        dst[o] = sum;
+    };
+    border(0);
+    for (int o = inner; o < outCols; ++o)
+    {
+        border(o);
+    }
+}
+
+/**
+ * blur() and 2x decimation in one pass: output row r is the vertical [1 2 1] / 4 of the row
+ * passes (even columns only) of image rows 2r - 1, 2r and 2r + 1; the last of them is the first of
+ * output row r + 1, so every image row is filtered once. rows past the edges are zero, as in
+ * blur(), and the taps add up in blur()'s order - the result is blur(image) at the even
+ * rows and cols, bit for bit.
+ * @param image
+ * @param threads
+ * @return
+ */
+template<typename T>
+static BasicMatrix<T> pyramidDownT(const BasicMatrixView<const T> &image, int threads)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    const int rows = image.getRows(), cols = image.getCols();
+    const int outRows = (rows + 1) / 2, outCols = (cols + 1) / 2;
+    BasicMatrix<T> res(outRows, outCols, MatrixInit::Uninitialized);
+    const ScalarType v0 = GAUSSIAN_BLUR_COLUMN(0, 0), v1 = GAUSSIAN_BLUR_COLUMN(1, 0), v2 = GAUSSIAN_BLUR_COLUMN(2, 0);
+    threads = resolveThreadCount(threads, 2L * rows * cols);
+    parallelFor(0, outRows, threads, [&](int begin, int end)
+    {
+        std::vector<ScalarType> buffer(3 * static_cast<size_t>(outCols));
+        ScalarType *up = buffer.data(), *mid = up + outCols, *down = mid + outCols;
+        if (begin > 0)
+        {
+            pyramidDownRow(image.row_ptr(2 * begin - 1), cols, up);
+        }
+        for (int r = begin; r < end; ++r)
+        {
+            const bool hasUp = r > 0, hasDown = 2 * r + 1 < rows;
+            pyramidDownRow(image.row_ptr(2 * r), cols, mid);
+            if (hasDown)
+            {
+                pyramidDownRow(image.row_ptr(2 * r + 1), cols, down);
+            }
+            T *resRow = res.row_ptr(r);
+            for (int c = 0; c < outCols; ++c)
+            {
+                ScalarType acc = 0;
+                if (hasUp)
+                {
+                    acc += v0 * up[c];
+                }
+                acc += v1 * mid[c];
+                if (hasDown)
+                {
+                    acc += v2 * down[c];
+                }
+                resRow[c] = blurBounds(saturateCast<T>(std::rint(acc)));
+            }
+            std::swap(up, down);
+        }
+    });
+    return res;
+}
+
+/**
+ * one pyramid step down
+ * @param image
+ * @param threads
+ * @return
+ */
+Matrix pyramidDown(const ConstMatrixView &image, int threads)
+{
+    return pyramidDownT(image, threads);
+}
+
+/**
+ * one pyramid step down of an 8 bit image
+ * @param image
+ * @param threads
+ * @return
+ */
+ByteMatrix pyramidDown(const ConstByteMatrixView &image, int threads)
+{
+    return pyramidDownT(image, threads);
+}
+
+/**
+ * a row enlarged 2x: the pixels, with the average of each and the next between them (the last
+ * pixel repeated)
+ * @param src image row
+ * @param cols image cols
+ * @param dst enlarged row
+ * @param outCols 2 * cols or 2 * cols - 1
+ */
+template<typename T>
+static void pyramidUpRow(const T *src, int cols, float *dst, int outCols)
+{
+    for (int c = 0; c + 1 < cols; ++c)
+    {
+        dst[2 * c] = src[c];
+        dst[2 * c + 1] = 0.5f * (static_cast<float>(src[c]) + static_cast<float>(src[c + 1]));
+    }
+    dst[2 * (cols - 1)] = src[cols - 1];
+    if (outCols == 2 * cols)
+    {
+        dst[outCols - 1] = src[cols - 1];
+    }
+}
+
+/**
+ * res = fine + sign * pyramidUp(image), or pyramidUp(image) without fine: the laplacian
+ * pyramid's levels and their collapse without a temporary for the enlarged image. odd rows are
+ * the averages of the two enlarged rows around them. rows are split between threads.
+ * Check dimensions valid for operation.
+ * @param image
+ * @param fine nullptr, or an image of res's size
+ * @param sign
+ * @param res
+ * @param threads
+ */
+template<typename T, typename U>
+static void pyramidUpInto(const BasicMatrixView<const T> &image, const BasicMatrixView<const U> *fine, float sign,
+                          const MatrixView &res, int threads)
+{
+    const int rows = res.getRows(), cols = res.getCols();
+    const int inRows = image.getRows(), inCols = image.getCols();
+    if (inRows == 0 || inCols == 0 || (rows + 1) / 2 != inRows || (cols + 1) / 2 != inCols ||
+        (fine != nullptr && (fine->getRows() != rows || fine->getCols() != cols)))
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    threads = resolveThreadCount(threads, 2L * rows * cols);
+    parallelFor(0, rows, threads, [&](int begin, int end)
+    {
+        std::vector<float> buffer(2 * static_cast<size_t>(cols));
+        float *above = buffer.data(), *below = above + cols;
+        int aboveRow = -1;  // image row enlarged in above
+        for (int r = begin; r < end; ++r)
+        {
+            float *resRow = res.row_ptr(r);
+            const int top = r / 2;
+            if (r % 2 == 0)
+            {
+                pyramidUpRow(image.row_ptr(top), inCols, resRow, cols);
+            }
+            else
+            {
+                const int bottom = std::min(top + 1, inRows - 1);
+                if (aboveRow != top)
+                {
+                    pyramidUpRow(image.row_ptr(top), inCols, above, cols);
+                }
+                pyramidUpRow(image.row_ptr(bottom), inCols, below, cols);
+                for (int c = 0; c < cols; ++c)
+                {
+                    resRow[c] = 0.5f * (above[c] + below[c]);
+                }
+                // the next odd row's top is this one's bottom
+                std::swap(above, below);
+                aboveRow = bottom;
+            }
+            if (fine != nullptr)
+            {
+                const U *fineRow = fine->row_ptr(r);
+                for (int c = 0; c < cols; ++c)
+                {
+                    resRow[c] = static_cast<float>(fineRow[c]) + sign * resRow[c];
+                }
+            }
+        }
+    });
+}
+
+/**
+ * one pyramid step up
+ * @param image
+ * @param rows
+ * @param cols
+ * @param threads
+ * @return
+ */
+Matrix pyramidUp(const ConstMatrixView &image, int rows, int cols, int threads)
+{
+    Matrix res(std::max(rows, 0), std::max(cols, 0), MatrixInit::Uninitialized);
+    pyramidUpInto<float, float>(image, nullptr, 1, res.view(), threads);
+    return res;
+}
+
+/**
+ * one pyramid step up of an 8 bit image
+ * @param image
+ * @param rows
+ * @param cols
+ * @param threads
+ * @return
+ */
+Matrix pyramidUp(const ConstByteMatrixView &image, int rows, int cols, int threads)
+{
+    Matrix res(std::max(rows, 0), std::max(cols, 0), MatrixInit::Uninitialized);
+    pyramidUpInto<uint8_t, float>(image, nullptr, 1, res.view(), threads);
+    return res;
+}
+
+/**
+ * gaussian pyramid
+ * @param image
+ * @param levels
+ * @param threads
+ * @return
+ */
+template<typename T>
+static std::vector<BasicMatrix<T>> gaussianPyramidT(const BasicMatrixView<const T> &image, int levels, int threads)
+{
+    if (levels < 1)
+    {
+        matrixError<std::invalid_argument>(INVALID_PYRAMID_LEVELS);
+    }
+    std::vector<BasicMatrix<T>> pyramid;
+    pyramid.reserve(levels);
+    pyramid.emplace_back(image);
+    for (int i = 1; i < levels; ++i)
+    {
+        pyramid.push_back(pyramidDownT<T>(pyramid.back().view(), threads));
+    }
+    return pyramid;
+}
+
+/**
+ * gaussian pyramid
+ * @param image
+ * @param levels
+ * @param threads
+ * @return
+ */
+std::vector<Matrix> gaussianPyramid(const ConstMatrixView &image, int levels, int threads)
+{
+    return gaussianPyramidT(image, levels, threads);
+}
+
+/**
+ * gaussian pyramid of an 8 bit image
+ * @param image
+ * @param levels
+ * @param threads
+ * @return
+ */
+std::vector<ByteMatrix> gaussianPyramid(const ConstByteMatrixView &image, int levels, int threads)
+{
+    return gaussianPyramidT(image, levels, threads);
+}
+
+/**
+ * laplacian pyramid: the gaussian one, then every level but the last minus its enlarged successor
+ * @param image
+ * @param levels
+ * @param threads
+ * @return
+ */
+template<typename T>
+static std::vector<Matrix> laplacianPyramidT(const BasicMatrixView<const T> &image, int levels, int threads)
+{
+    std::vector<BasicMatrix<T>> gaussian = gaussianPyramidT(image, levels, threads);
+    std::vector<Matrix> pyramid;
+    pyramid.reserve(levels);
+    for (int i = 0; i + 1 < levels; ++i)
+    {
+        const BasicMatrixView<const T> fine = gaussian[i].view();
+        pyramid.emplace_back(fine.getRows(), fine.getCols(), MatrixInit::Uninitialized);
+        pyramidUpInto<T, T>(gaussian[i + 1].view(), &fine, -1, pyramid.back().view(), threads);
+    }
+    const BasicMatrix<T> &last = gaussian.back();
+    pyramid.emplace_back(last.getRows(), last.getCols(), MatrixInit::Uninitialized);
+    for (int r = 0; r < last.getRows(); ++r)
+    {
+        std::copy(last.row_ptr(r), last.row_ptr(r) + last.getCols(), pyramid.back().row_ptr(r));
+    }
+    return pyramid;
+}
+
+/**
+ * laplacian pyramid
+ * @param image
+ * @param levels
+ * @param threads
+ * @return
+ */
+std::vector<Matrix> laplacianPyramid(const ConstMatrixView &image, int levels, int threads)
+{
+    return laplacianPyramidT(image, levels, threads);
+}
+
+/**
+ * laplacian pyramid of an 8 bit image
+ * @param image
+ * @param levels
+ * @param threads
+ * @return
+ */
+std::vector<Matrix> laplacianPyramid(const ConstByteMatrixView &image, int levels, int threads)
+{
+    return laplacianPyramidT(image, levels, threads);
+}
+
+/**
+ * collapses a laplacian pyramid: level i plus the enlarged collapse of the levels after it
+ * @param pyramid
+ * @param threads
+ * @return
+ */
+Matrix collapseLaplacianPyramid(const std::vector<Matrix> &pyramid, int threads)
+{
+    if (pyramid.empty())
+    {
+        matrixError<std::invalid_argument>(INVALID_PYRAMID_LEVELS);
+    }
+    Matrix res = pyramid.back();
+    for (int i = static_cast<int>(pyramid.size()) - 2; i >= 0; --i)
+    {
+        const ConstMatrixView fine = pyramid[i].view();
+        Matrix next(fine.getRows(), fine.getCols(), MatrixInit::Uninitialized);
+        pyramidUpInto<float, float>(res.view(), &fine, 1, next.view(), threads);
+        res = std::move(next);
+    }
+    return res;
+}
+
+/**
+ * the taps of resize() along one axis: output pixel o is the sum over j < count of
+ * weight[o * count + j] * source pixel index[o * count + j]. the indices of an output are
+ * consecutive (clamped to the edge), so count buffers hold the source rows of any output row.
+ */
+struct ResizeTaps
+{
+    /**
+     * taps per output pixel
+     */
+    int count;
+    /**
+     * source pixels, count per output pixel
+     */
+    std::vector<int> index;
+    /**
+     * their weights
+     */
+    std::vector<float> weight;
+};
+
+/**
+ * taps along an axis of n source pixels resampled to m
+ * bilinear: the two pixels around the output pixel's centre, (o + 0.5) * n / m - 0.5 in source
+ * coordinates. area: the source pixels overlapping [o * n / m, (o + 1) * n / m), weighted by the
+ * overlap over its length.
+ * @param n
+ * @param m
+ * @param interpolation
+ * @return
+ */
+static ResizeTaps resizeTaps(int n, int m, Interpolation interpolation)
+{
+    const double scale = static_cast<double>(n) / m;
+    ResizeTaps taps;
+    taps.count = interpolation == Interpolation::Bilinear ? 2 : static_cast<int>(std::ceil(scale)) + 1;
+    taps.index.resize(static_cast<size_t>(m) * taps.count);
+    taps.weight.resize(taps.index.size());
+    for (int o = 0; o < m; ++o)
+    {
+        int *index = &taps.index[static_cast<size_t>(o) * taps.count];
+        float *weight = &taps.weight[static_cast<size_t>(o) * taps.count];
+        if (interpolation == Interpolation::Bilinear)
+        {
+            double s = (o + 0.5) * scale - 0.5;
+            double first = std::floor(s);
+            index[0] = static_cast<int>(first);
+            index[1] = index[0] + 1;
+            weight[0] = static_cast<float>(1 - (s - first));
+            weight[1] = static_cast<float>(s - first);
+        }
+        else
+        {
+            double lo = o * scale, hi = (o + 1) * scale;
+            int first = static_cast<int>(std::floor(lo));
+            for (int j = 0; j < taps.count; ++j)
+            {
+                double overlap = std::min(hi, first + j + 1.0) - std::max(lo, first + j + 0.0);
+                index[j] = first + j;
+                weight[j] = static_cast<float>(std::max(0.0, overlap) / scale);
+            }
+        }
+        for (int j = 0; j < taps.count; ++j)
+        {
+            index[j] = std::min(std::max(index[j], 0), n - 1);
+        }
+    }
+    return taps;
+}
+
+/**
+ * resamples a row along its length
+ * @param src source row
+ * @param taps column taps
+ * @param cols output cols
+ * @param dst resampled row
+ */
+template<typename T>
+static void resizeRow(const T *src, const ResizeTaps &taps, int cols, float *dst)
+{
+    const int count = taps.count;
+    const int *index = taps.index.data();
+    const float *weight = taps.weight.data();
+    if (count == 2)
+    {
+        for (int c = 0; c < cols; ++c)
+        {
+            dst[c] = weight[2 * c] * src[index[2 * c]] + weight[2 * c + 1] * src[index[2 * c + 1]];
+        }
+        return;
+    }
+    for (int c = 0; c < cols; ++c)
+    {
+        float sum = 0;
+        for (int j = 0; j < count; ++j)
+        {
+            sum += weight[c * count + j] * src[index[c * count + j]];
+        }
+        dst[c] = sum;
+    }
+}
+
+/**
+ * separable resampling: for every output row, the source rows its taps read are resampled along
+ * the row (each once: a row stays in one of count buffers, slot index % count, while consecutive
+ * output rows read it), then blended a whole row at a time. source rows no tap reads (shrinking)
+ * are never touched.
+ * @param image
+ * @param rows
+ * @param cols
+ * @param interpolation
+ * @param threads
+ * @return
+ */
+template<typename T>
+static BasicMatrix<T> resizeT(const BasicMatrixView<const T> &image, int rows, int cols,
+                              Interpolation interpolation, int threads)
+{
+    if (rows < 1 || cols < 1 || image.getRows() == 0 || image.getCols() == 0)
+    {
+        matrixError<std::invalid_argument>(INVALID_RESIZE);
+    }
+    const ResizeTaps rowTaps = resizeTaps(image.getRows(), rows, interpolation);
+    const ResizeTaps colTaps = resizeTaps(image.getCols(), cols, interpolation);
+    const int count = rowTaps.count;
+    BasicMatrix<T> res(rows, cols, MatrixInit::Uninitialized);
+    threads = resolveThreadCount(threads, static_cast<long>(rows) * cols * (count + colTaps.count));
+    parallelFor(0, rows, threads, [&](int begin, int end)
+    {
+        std::vector<float> buffer(static_cast<size_t>(count) * cols), acc(cols);
+        std::vector<int> slotRow(count, -1);  // source row resampled in each buffer
+        for (int r = begin; r < end; ++r)
+        {
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (int j = 0; j < count; ++j)
+            {
+                const int source = rowTaps.index[static_cast<size_t>(r) * count + j];
+                const float weight = rowTaps.weight[static_cast<size_t>(r) * count + j];
+                if (weight == 0)
+                {
+                    continue;
+                }
+                float *resampled = &buffer[static_cast<size_t>(source % count) * cols];
+                if (slotRow[source % count] != source)
+                {
+                    resizeRow(image.row_ptr(source), colTaps, cols, resampled);
+                    slotRow[source % count] = source;
+                }
+                for (int c = 0; c < cols; ++c)
+                {
+                    acc[c] += weight * resampled[c];
+                }
+            }
+            T *resRow = res.row_ptr(r);
+            for (int c = 0; c < cols; ++c)
+            {
+                resRow[c] = saturateCast<T>(acc[c]);
+            }
+        }
+    });
+    return res;
+}
+
+/**
+ * resize
+ * @param image
+ * @param rows
+ * @param cols
+ * @param interpolation
+ * @param threads
+ * @return
+ */
+Matrix resize(const ConstMatrixView &image, int rows, int cols, Interpolation interpolation, int threads)
+{
+    return resizeT(image, rows, cols, interpolation, threads);
+}
+
+/**
+ * resize of an 8 bit image
+ * @param image
+ * @param rows
+ * @param cols
+ * @param interpolation
+ * @param threads
+ * @return
+ */
+ByteMatrix resize(const ConstByteMatrixView &image, int rows, int cols, Interpolation interpolation, int threads)
+{
+    return resizeT(image, rows, cols, interpolation, threads);
+}
+
+/**
+ * middle value of every quantization level: level i holds the pixels p with
+ * p * levels / 256 == i, i.e. [ceil(256 i / levels), ceil(256 (i + 1) / levels))
+ * @param levels
+ * @return averages, levels entries used
+ */
+static std::array<int, 256> quantizationLevels(int levels)
+{
+    if (levels < 1 || levels > 256)
+    {
+        matrixError<std::invalid_argument>(INVALID_QUANTIZATION_LEVELS);
+    }
+    std::array<int, 256> average{};
+    for (int i = 0; i < levels; ++i)
+    {
+        int lower = (256 * i + levels - 1) / levels;
+        int upper = (256 * (i + 1) + levels - 1) / levels;
+        average[i] = (lower + upper - 1) / 2;
+    }
+    return average;
+}
+
+/**
+ * the quantization of every 8 bit value
+ * @param levels
+ * @return
+ */
+LookupTable quantizationTable(int levels)
+{
+    std::array<int, 256> average = quantizationLevels(levels);
+    LookupTable lut;
+    for (int p = 0; p < 256; ++p)
+    {
+        lut[p] = static_cast<uint8_t>(average[p * levels / 256]);
+    }
+    return lut;
+}
+
+/**
+ * maps n pixels through the table, 4 independent lookups per iteration
+ */
+static void lutRow(const uint8_t *src, uint8_t *dst, int n, const LookupTable &lut)
+{
+    const uint8_t *table = lut.data();
+    int c = 0;
+    for (; c + 4 <= n; c += 4)
+    {
+        uint8_t p0 = table[src[c]], p1 = table[src[c + 1]], p2 = table[src[c + 2]], p3 = table[src[c + 3]];
+        dst[c] = p0;
+        dst[c + 1] = p1;
+        dst[c + 2] = p2;
+        dst[c + 3] = p3;
+    }
+    for (; c < n; ++c)
+    {
+        dst[c] = table[src[c]];
+    }
+}
+
+/**
+ * maps every pixel through the table, into res
+ * @param image
+ * @param lut
+ * @param res
+ * @param threads
+ */
+void apply_lut(const ConstByteMatrixView &image, const LookupTable &lut, const ByteMatrixView &res, int threads)
+{
+    if (image.getRows() != res.getRows() || image.getCols() != res.getCols())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    long work = static_cast<long>(image.getRows()) * image.getCols();
+    parallelFor(0, image.getRows(), resolveThreadCount(threads, work), [&](int begin, int end)
+    {
+        for (int r = begin; r < end; ++r)
+        {
+            lutRow(image.row_ptr(r), res.row_ptr(r), image.getCols(), lut);
+        }
+    });
+}
+
+/**
+ * maps every pixel through the table
+ * @param image
+ * @param lut
+ * @param threads
+ * @return
+ */
+ByteMatrix apply_lut(const ConstByteMatrixView &image, const LookupTable &lut, int threads)
+{
+    ByteMatrix res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    apply_lut(image, lut, res.view(), threads);
+    return res;
+}
+
+/**
+ * Operator Quantization
+ * Performs quantization on the input image by the given number of levels.
+ * Returns new matrix which is the result of running the operator on the image
+ * (pixels outside [0,255] fall in the first or last level)
+ * @param image
+ * @param levels
+ * @return
+ */
+Matrix quantization(const ConstMatrixView &image, int levels)
+{
+    std::array<int, 256> average = quantizationLevels(levels);
+    Matrix res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    const float scale = levels / 256.0f;
+    for (int r = 0; r < image.getRows(); ++r)
+    {
+        const float *imageRow = image.row_ptr(r);
+        float *resRow = res.row_ptr(r);
+        for (int c = 0; c < image.getCols(); ++c)
+        {
+            float level = std::floor(imageRow[c] * scale);
+            int idx = static_cast<int>(std::min(static_cast<float>(levels - 1), std::max(0.0f, level)));
+            resRow[c] = static_cast<float>(average[idx]);
+        }
+    }
+    return res;
+}
+
+/**
+ * Operator Quantization on an 8 bit image
+ * @param image
+ * @param levels
+ * @return
+ */
+ByteMatrix quantization(const ConstByteMatrixView &image, int levels)
+{
+    return apply_lut(image, quantizationTable(levels));
+}
+
+/**
+ *  make sure mat vals are in range
+ * @param numCells
+ * @param res
+ * @return
+ */
+Matrix &makeMatrixInBounds(const int numCells, Matrix &res)
+{
+
+    float *cells = res.data();
+    for (int i = 0; i < numCells; ++i)
+    {
+        if (cells[i] > 255)
+        {
+            cells[i] = 255;
+        }
+        else if (cells[i] < 0)
+        {
+            cells[i] = 0;
+        }
+    }
+    return res;
+}
+
+/**
+ * Gaussian Blurring
+ * Performs gaussian blurring on the input image.
+ * Returns new matrix which is the result of running the operator on the image
+ * @param image
+ * @return
+ */
+Matrix blur(const ConstMatrixView &image)
+{
+    // [1 2 1] / 4 along rows, then along cols: 6 multiply-adds per pixel instead of 9
+    Matrix res = convolutionSeparable(image, GAUSSIAN_BLUR_COLUMN, GAUSSIAN_BLUR_ROW);
+    int numCells = image.getRows() * image.getCols();
+    res = makeMatrixInBounds(numCells, res);
+    return res;
+}
+
+/**
+ * Gaussian Blurring of an 8 bit image
+ * convolution already saturates to [0,255], so no bounds pass is needed.
+ * @param image
+ * @return
+ */
+ByteMatrix blur(const ConstByteMatrixView &image)
+{
+    return convolutionSeparable(image, GAUSSIAN_BLUR_COLUMN, GAUSSIAN_BLUR_ROW);
+}
+
+/**
+ * fused sobel sweep: for every row, gx and gy (the SOBEL_KERNEL_X / SOBEL_KERNEL_Y correlations,
+ * zero border) of all its pixels are computed from the three image rows around it, then handed to
+ * store(r, gx, gy). the kernels are split into a vertical pass over the three rows ([1 2 1] and
+ * [1 0 -1] down each column) and a horizontal one, both branch free over zero padded row copies.
+ * rows are split between threads, each with its own row buffers.
+ * @param image
+ * @param threads
+ * @param store
+ */
+template<typename T, typename Store>
+void sobelSweep(const BasicMatrixView<const T> &image, int threads, Store store)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    const int rows = image.getRows(), cols = image.getCols();
+    long work = static_cast<long>(rows) * cols * 16;
+    parallelFor(0, rows, resolveThreadCount(threads, work), [&](int begin, int end)
+    {
+        // padded copies of rows r - 1, r, r + 1: element c + 1 is pixel c
+        std::vector<ScalarType> padded(3 * static_cast<size_t>(cols + 2), ScalarType(0));
+        std::vector<ScalarType> smooth(cols + 2), diff(cols + 2), gx(cols), gy(cols);
+        auto load = [&](int y, ScalarType *dst)
+        {
+            if (y < 0 || y >= rows)
+            {
+                std::fill(dst + 1, dst + cols + 1, ScalarType(0));
+                return;
+            }
+            const T *src = image.row_ptr(y);
+            for (int c = 0; c < cols; ++c)
+            {
+                dst[c + 1] = src[c];
+            }
+        };
+        for (int r = begin; r < end; ++r)
+        {
+            ScalarType *up = &padded[static_cast<size_t>((r + 2) % 3) * (cols + 2)];
+            ScalarType *mid = &padded[static_cast<size_t>(r % 3) * (cols + 2)];
+            ScalarType *down = &padded[static_cast<size_t>((r + 1) % 3) * (cols + 2)];
+            if (r == begin)
+            {
+                load(r - 1, up);
+                load(r, mid);
+            }
+            load(r + 1, down);
+            for (int c = 0; c < cols + 2; ++c)
+            {
+                smooth[c] = up[c] + 2 * mid[c] + down[c];
+                diff[c] = up[c] - down[c];
+            }
+            for (int c = 0; c < cols; ++c)
+            {
+                gx[c] = (smooth[c] - smooth[c + 2]) * ScalarType(1 / 8.0);
+                gy[c] = (diff[c] + 2 * diff[c + 1] + diff[c + 2]) * ScalarType(1 / 8.0);
+            }
+            store(r, gx.data(), gy.data());
+        }
+    });
+}
+
+/**
+ * legacy sobel: rint(gx) + rint(gy), clamped to [0,255]
+ * @param image
+ * @param threads
+ * @return
+ */
+template<typename R, typename T>
+BasicMatrix<R> sobelSum(const BasicMatrixView<const T> &image, int threads)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    BasicMatrix<R> res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    sobelSweep(image, threads, [&](int r, const ScalarType *gx, const ScalarType *gy)
+    {
+        R *resRow = res.row_ptr(r);
+        for (int c = 0; c < image.getCols(); ++c)
+        {
+            ScalarType sum = std::rint(gx[c]) + std::rint(gy[c]);
+            resRow[c] = static_cast<R>(std::min(ScalarType(255), std::max(ScalarType(0), sum)));
+        }
+    });
+    return res;
+}
+
+/**
+ * sobel gradient magnitude (and orientation)
+ * @param image
+ * @param norm
+ * @param orientation
+ * @param threads
+ * @return
+ */
+template<typename R, typename T>
+BasicMatrix<R> sobelMagnitudeT(const BasicMatrixView<const T> &image, GradientNorm norm, Matrix *orientation,
+                               int threads)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    BasicMatrix<R> res(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    if (orientation != nullptr)
+    {
+        *orientation = Matrix(image.getRows(), image.getCols(), MatrixInit::Uninitialized);
+    }
+    sobelSweep(image, threads, [&](int r, const ScalarType *gx, const ScalarType *gy)
+    {
+        R *resRow = res.row_ptr(r);
+        if (norm == GradientNorm::L1)
+        {
+            for (int c = 0; c < image.getCols(); ++c)
+            {
+                ScalarType magnitude = std::rint(std::fabs(gx[c]) + std::fabs(gy[c]));
+                resRow[c] = static_cast<R>(std::min(ScalarType(255), magnitude));
+            }
+        }
+        else
+        {
+            for (int c = 0; c < image.getCols(); ++c)
+            {
+                ScalarType magnitude = std::rint(std::sqrt(gx[c] * gx[c] + gy[c] * gy[c]));
+                resRow[c] = static_cast<R>(std::min(ScalarType(255), magnitude));
+            }
+        }
+        if (orientation != nullptr)
+        {
+            // the kernels correlate left - right and top - bottom: flip both to get d/dx, d/dy
+            float *angleRow = orientation->row_ptr(r);
+            for (int c = 0; c < image.getCols(); ++c)
+            {
+                angleRow[c] = static_cast<float>(std::atan2(-gy[c], -gx[c]));
+            }
+        }
+    });
+    return res;
+}
+
+/**
+ * Sobel operator (edge detection)
+ * Performs sobel edge detection on the input image.
+ * Returns new matrix which is the result of running the operator on the image.
+ * @param image
+ * @param threads
+ * @return
+ */
+Matrix sobel(const ConstMatrixView &image, int threads)
+{
+    return sobelSum<float>(image, threads);
+}
+
+/**
+ * Sobel operator (edge detection) on an 8 bit image.
+ * @param image
+ * @param threads
+ * @return
+ */
+ByteMatrix sobel(const ConstByteMatrixView &image, int threads)
+{
+    return sobelSum<uint8_t>(image, threads);
+}
+
+/**
+ * sobel gradient magnitude
+ * @param image
+ * @param norm
+ * @param orientation
+ * @param threads
+ * @return
+ */
+Matrix sobelMagnitude(const ConstMatrixView &image, GradientNorm norm, Matrix *orientation, int threads)
+{
+    return sobelMagnitudeT<float>(image, norm, orientation, threads);
+}
+
+/**
+ * sobel gradient magnitude of an 8 bit image
+ * @param image
+ * @param norm
+ * @param orientation
+ * @param threads
+ * @return
+ */
+ByteMatrix sobelMagnitude(const ConstByteMatrixView &image, GradientNorm norm, Matrix *orientation, int threads)
+{
+    return sobelMagnitudeT<uint8_t>(image, norm, orientation, threads);
+}
@@ -0,0 +1,694 @@
+
+
+#ifndef EX5_FILTERS_H
+
+// ------------------------------ includes ------------------------------
+
+#include <array>
+#include <vector>
+#include "Matrix.h"
+#include "FixedMatrix.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_FILTERS_H
+/**
+ * quantization needs between 1 and 256 levels
+ */
+#define INVALID_QUANTIZATION_LEVELS "Invalid number of quantization levels.\n"
+/**
+ * gaussian blurring needs a positive sigma
+ */
+#define INVALID_SIGMA "Invalid gaussian sigma.\n"
+/**
+ * separable convolution takes a column (k x 1) and a row (1 x k) kernel
+ */
+#define INVALID_SEPARABLE_KERNEL "Invalid separable kernel.\n"
+/**
+ * box, mean and variance windows are at least 1 x 1
+ */
+#define INVALID_WINDOW "Invalid filter window size.\n"
+/**
+ * output columns medianFilter sweeps at a time - the histograms of a stripe (1KB per column)
+ * then stay in L2
+ */
+#define MEDIAN_STRIPE 128
+/**
+ * distance between the 256 bin column histograms of medianFilter, padded off a power of two
+ */
+#define MEDIAN_FINE_STRIDE 272
+/**
+ * pyramids have at least one level (the image)
+ */
+#define INVALID_PYRAMID_LEVELS "Invalid number of pyramid levels.\n"
+/**
+ * resize() needs a non empty result
+ */
+#define INVALID_RESIZE "Invalid resize dimensions.\n"
+/**
+ * convolution() switches to the FFT for (non separable) kernels of at least this many taps -
+ * about 11 x 11, where the direct path's taps per pixel overtake the transform work
+ */
+#define FFT_CONVOLUTION_MIN_TAPS 121
+/**
+ * smallest FFT block edge convolutionFFT picks (smaller transforms cost more per pixel in overhead
+ * than they save)
+ */
+#define FFT_CONVOLUTION_MIN_TILE 64
+/**
+ * largest FFT block edge convolutionFFT picks
+ */
+#define FFT_CONVOLUTION_MAX_TILE 1024
+
+/**
+ * how convolutions treat the pixels past the image edges
+ */
+enum class BorderMode
+{
+    /**
+     * zeros (the original behaviour)
+     */
+    Zero,
+    /**
+     * the nearest edge pixel: aaa|abcd|ddd
+     */
+    Clamp,
+    /**
+     * mirrored around the edge pixel: cb|abcd|cb
+     */
+    Reflect,
+    /**
+     * the image repeats: cd|abcd|ab
+     */
+    Wrap
+};
+
+/**
+ * 256 entry table mapping 8 bit values to 8 bit values, see apply_lut
+ */
+typedef std::array<uint8_t, 256> LookupTable;
+
+/**
+ * how resize() computes a pixel from the source pixels
+ */
+enum class Interpolation
+{
+    /**
+     * from the 2 x 2 source pixels around the pixel centre (for enlarging and mild shrinking)
+     */
+    Bilinear,
+    /**
+     * the average of the source area the pixel covers, partly covered pixels weighted by the part
+     * covered (for shrinking - no aliasing)
+     */
+    Area
+};
+
+/**
+ * gaussian kernels reach this many sigmas from the centre
+ */
+#define GAUSSIAN_KERNEL_SIGMAS 3
+
+/**
+ * the 3x3 gaussian blurring kernel (compile time constant, no allocation)
+ */
+constexpr Matrix3f GAUSSIAN_BLUR_KERNEL(1 / 16.0, 2 / 16.0, 1 / 16.0,
+                                        2 / 16.0, 4 / 16.0, 2 / 16.0,
+                                        1 / 16.0, 2 / 16.0, 1 / 16.0);
+
+/**
+ * GAUSSIAN_BLUR_KERNEL is the outer product of this column with GAUSSIAN_BLUR_ROW
+ */
+constexpr FixedMatrix<float, 3, 1> GAUSSIAN_BLUR_COLUMN(1 / 4.0, 2 / 4.0, 1 / 4.0);
+
+/**
+ * see GAUSSIAN_BLUR_COLUMN
+ */
+constexpr FixedMatrix<float, 1, 3> GAUSSIAN_BLUR_ROW(1 / 4.0, 2 / 4.0, 1 / 4.0);
+
+/**
+ * the horizontal (first) sobel kernel
+ */
+constexpr Matrix3f SOBEL_KERNEL_X(1 / 8.0, 0, -1 / 8.0,
+                                  2 / 8.0, 0, -2 / 8.0,
+                                  1 / 8.0, 0, -1 / 8.0);
+
+/**
+ * the vertical (second) sobel kernel
+ */
+constexpr Matrix3f SOBEL_KERNEL_Y(1 / 8.0, 2 / 8.0, 1 / 8.0,
+                                  0, 0, 0,
+                                  -1 / 8.0, -2 / 8.0, -1 / 8.0);
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * this func does the convolution process
+ * image and kernel may be whole matrices or views (tiles, regions of interest) into them.
+ * the interior of the image, where every tap is in bounds, runs without bounds tests; only a
+ * kernel sized frame of border pixels consults the border mode.
+ * @param image
+ * @param small
+ * @param border pixels past the edges, zeros by default
+ * @param threads threads of the FFT path (large kernels), 0 - defaultThreadCount(); the other
+ * paths run on the calling thread
+ * @return matrix after convolution
+ */
+Matrix convolution(const ConstMatrixView &image, const ConstMatrixView &small, BorderMode border = BorderMode::Zero,
+                   int threads = 0);
+
+/**
+ * convolution of an 8 bit image.
+ * sums are accumulated in float and rounded + saturated to [0,255] once per pixel.
+ * @param image
+ * @param small
+ * @param border
+ * @param threads threads of the FFT path, 0 - defaultThreadCount()
+ * @return matrix after convolution
+ */
+ByteMatrix convolution(const ConstByteMatrixView &image, const ConstMatrixView &small,
+                       BorderMode border = BorderMode::Zero, int threads = 0);
+
+/**
+ * FFT convolution: the same as convolution() (up to float rounding), O(log) instead of O(KR * KC)
+ * per pixel - for large kernels (31 x 31 and up it is many times faster).
+ * overlap-add: the image is cut into blocks whose (2, 3, 5 smooth sized) transforms are
+ * multiplied by the kernel spectrum, two real blocks per complex transform; rows of blocks are
+ * split between threads. convolution() picks this path by itself for large kernels.
+ * @param image
+ * @param small
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return matrix after convolution
+ */
+Matrix convolutionFFT(const ConstMatrixView &image, const ConstMatrixView &small,
+                      BorderMode border = BorderMode::Zero, int threads = 0);
+
+/**
+ * FFT convolution of an 8 bit image
+ * @param image
+ * @param small
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return matrix after convolution
+ */
+ByteMatrix convolutionFFT(const ConstByteMatrixView &image, const ConstMatrixView &small,
+                          BorderMode border = BorderMode::Zero, int threads = 0);
+
+/**
+ * separable convolution: the same as convolution() with the kernel column * row, run as a
+ * horizontal pass with `row` and a vertical pass with `column` - KR + KC multiply-adds per pixel
+ * instead of KR * KC. the horizontally filtered rows are kept in a ring of KR rows, so the extra
+ * memory is KR image rows. pixels past the edges follow the border mode.
+ * Check column is KR x 1 and row is 1 x KC.
+ * @param image
+ * @param column
+ * @param row
+ * @param border
+ * @return matrix after convolution
+ */
+Matrix convolutionSeparable(const ConstMatrixView &image, const ConstMatrixView &column, const ConstMatrixView &row,
+                            BorderMode border = BorderMode::Zero);
+
+/**
+ * separable convolution of an 8 bit image
+ * @param image
+ * @param column
+ * @param row
+ * @param border
+ * @return matrix after convolution
+ */
+ByteMatrix convolutionSeparable(const ConstByteMatrixView &image, const ConstMatrixView &column,
+                                const ConstMatrixView &row, BorderMode border = BorderMode::Zero);
+
+/**
+ * splits a rank 1 kernel into column * row.
+ * convolution() uses this to run separable kernels (box, gaussian...) as two 1D passes.
+ * @param kernel
+ * @param column set to KR x 1 when separable
+ * @param row set to 1 x KC when separable
+ * @return true if the kernel is (up to float rounding) the outer product of a column and a row
+ */
+bool separateKernel(const ConstMatrixView &kernel, Matrix &column, Matrix &row);
+
+/**
+ * sampled, normalized gaussian of the given sigma, radius ceil(GAUSSIAN_KERNEL_SIGMAS * sigma)
+ * throws std::invalid_argument unless sigma > 0.
+ * @param sigma
+ * @return 1 x (2 * radius + 1) row kernel
+ */
+Matrix gaussianKernel(float sigma);
+
+/**
+ * Gaussian Blurring of any sigma, as two 1D passes (O(radius) per pixel)
+ * throws std::invalid_argument unless sigma > 0.
+ * @param image
+ * @param sigma
+ * @param border
+ * @return
+ */
+Matrix gaussian_blur(const ConstMatrixView &image, float sigma, BorderMode border = BorderMode::Zero);
+
+/**
+ * Gaussian Blurring of any sigma of an 8 bit image
+ * @param image
+ * @param sigma
+ * @param border
+ * @return
+ */
+ByteMatrix gaussian_blur(const ConstByteMatrixView &image, float sigma, BorderMode border = BorderMode::Zero);
+
+/**
+ * summed area table: res(i, j) = sum of image(y, x) for y < i, x < j, accumulated in double (exact
+ * for 8 bit images of up to 2^37 pixels). row prefix sums run in parallel, then column sums in
+ * parallel column bands.
+ * @param image
+ * @param threads 0 - defaultThreadCount()
+ * @return (rows + 1) x (cols + 1) table, first row and column zero
+ */
+DoubleMatrix integralImage(const ConstMatrixView &image, int threads = 0);
+
+/**
+ * summed area table of an 8 bit image
+ * @param image
+ * @param threads 0 - defaultThreadCount()
+ * @return (rows + 1) x (cols + 1) table
+ */
+DoubleMatrix integralImage(const ConstByteMatrixView &image, int threads = 0);
+
+/**
+ * summed area table of the squared pixels (with integralImage, gives window variances)
+ * @param image
+ * @param threads 0 - defaultThreadCount()
+ * @return (rows + 1) x (cols + 1) table
+ */
+DoubleMatrix squaredIntegralImage(const ConstMatrixView &image, int threads = 0);
+
+/**
+ * summed area table of the squared pixels of an 8 bit image
+ * @param image
+ * @param threads 0 - defaultThreadCount()
+ * @return (rows + 1) x (cols + 1) table
+ */
+DoubleMatrix squaredIntegralImage(const ConstByteMatrixView &image, int threads = 0);
+
+/**
+ * box filter: every pixel is the sum of the height x width window around it (rows
+ * r - (height - 1) / 2 ... r + height / 2, likewise cols) - convolution() with a kernel of ones,
+ * but O(1) per pixel whatever the window (4 lookups in an integral image of the bordered image)
+ * and not rounded. output rows are split between threads.
+ * throws std::invalid_argument unless height, width >= 1. an empty image (0 rows or 0 cols) gives
+ * an empty result of the same size, in every border mode.
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix boxFilter(const ConstMatrixView &image, int height, int width, BorderMode border = BorderMode::Zero,
+                 int threads = 0);
+
+/**
+ * box filter of an 8 bit image (sums are not limited to 8 bits, so the result is float)
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix boxFilter(const ConstByteMatrixView &image, int height, int width, BorderMode border = BorderMode::Zero,
+                 int threads = 0);
+
+/**
+ * mean of the height x width window around every pixel (boxFilter / (height * width)).
+ * pixels past the edges are mirrored by default - zeros would darken the means near the edges.
+ * throws std::invalid_argument unless height, width >= 1. an empty image (0 rows or 0 cols) gives
+ * an empty result of the same size, in every border mode.
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix meanFilter(const ConstMatrixView &image, int height, int width, BorderMode border = BorderMode::Reflect,
+                  int threads = 0);
+
+/**
+ * window means of an 8 bit image
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix meanFilter(const ConstByteMatrixView &image, int height, int width, BorderMode border = BorderMode::Reflect,
+                  int threads = 0);
+
+/**
+ * variance of the height x width window around every pixel: E[x^2] - E[x]^2 from the integral
+ * images of the pixels and of their squares, in double (e.g for adaptive thresholds).
+ * throws std::invalid_argument unless height, width >= 1. an empty image (0 rows or 0 cols) gives
+ * an empty result of the same size, in every border mode.
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix varianceFilter(const ConstMatrixView &image, int height, int width, BorderMode border = BorderMode::Reflect,
+                      int threads = 0);
+
+/**
+ * window variances of an 8 bit image
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix varianceFilter(const ConstByteMatrixView &image, int height, int width,
+                      BorderMode border = BorderMode::Reflect, int threads = 0);
+
+/**
+ * erosion of an 8 bit image: every pixel becomes the minimum of the height x width rectangle
+ * around it (rows r - (height - 1) / 2 ... r + height / 2, likewise cols). pixels past the edges
+ * do not take part. van Herk / Gil-Werman: a row pass then a column pass, each 3 comparisons per
+ * pixel whatever the window; the column pass works on whole rows at a time, which vectorizes.
+ * columns are split between threads.
+ * throws std::invalid_argument unless height, width >= 1.
+ * @param image
+ * @param height
+ * @param width
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix erode(const ConstByteMatrixView &image, int height, int width, int threads = 0);
+
+/**
+ * dilation of an 8 bit image: the maximum of the window, see erode
+ * @param image
+ * @param height
+ * @param width
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix dilate(const ConstByteMatrixView &image, int height, int width, int threads = 0);
+
+/**
+ * opening: dilate(erode(image)) - removes bright details smaller than the window
+ * @param image
+ * @param height
+ * @param width
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix morphologyOpen(const ConstByteMatrixView &image, int height, int width, int threads = 0);
+
+/**
+ * closing: erode(dilate(image)) - fills dark details smaller than the window
+ * @param image
+ * @param height
+ * @param width
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix morphologyClose(const ConstByteMatrixView &image, int height, int width, int threads = 0);
+
+/**
+ * median of the height x width window around every pixel (for even sized windows the lower of
+ * the two middle values). constant time per pixel (Perreault - Hebert): a 256 bin histogram per
+ * column is slid down the image and the window histogram is slid along the row by adding the
+ * column entering and subtracting the one leaving; a 16 bin coarse histogram narrows the search
+ * for the median. output rows are split between threads.
+ * throws std::invalid_argument unless height, width >= 1. an empty image gives an empty result.
+ * @param image
+ * @param height
+ * @param width
+ * @param border
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix medianFilter(const ConstByteMatrixView &image, int height, int width,
+                        BorderMode border = BorderMode::Reflect, int threads = 0);
+
+/**
+ * one pyramid step down: blur() and 2x decimation fused - every output pixel is blur(image) at
+ * (2r, 2c), bit for bit, but only those pixels are computed (a quarter of the blur), from the row
+ * pass of the even columns of three rows. output rows are split between threads.
+ * @param image
+ * @param threads 0 - defaultThreadCount()
+ * @return ceil(rows / 2) x ceil(cols / 2) image
+ */
+Matrix pyramidDown(const ConstMatrixView &image, int threads = 0);
+
+/**
+ * one pyramid step down of an 8 bit image
+ * @param image
+ * @param threads 0 - defaultThreadCount()
+ * @return ceil(rows / 2) x ceil(cols / 2) image
+ */
+ByteMatrix pyramidDown(const ConstByteMatrixView &image, int threads = 0);
+
+/**
+ * one pyramid step up: the image enlarged to rows x cols (2x, rows and cols must halve back to
+ * the image's size, rounded up): pixel (2r, 2c) is image(r, c), the pixels between are the
+ * averages of their neighbours (the edge pixel repeats past the edge). not rounded.
+ * Check dimensions valid for operation.
+ * @param image
+ * @param rows
+ * @param cols
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix pyramidUp(const ConstMatrixView &image, int rows, int cols, int threads = 0);
+
+/**
+ * one pyramid step up of an 8 bit image (the result is float)
+ * @param image
+ * @param rows
+ * @param cols
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix pyramidUp(const ConstByteMatrixView &image, int rows, int cols, int threads = 0);
+
+/**
+ * gaussian pyramid: level 0 is the image, level i + 1 is pyramidDown(level i).
+ * throws std::invalid_argument unless levels >= 1.
+ * @param image
+ * @param levels
+ * @param threads 0 - defaultThreadCount()
+ * @return the levels, largest first
+ */
+std::vector<Matrix> gaussianPyramid(const ConstMatrixView &image, int levels, int threads = 0);
+
+/**
+ * gaussian pyramid of an 8 bit image
+ * @param image
+ * @param levels
+ * @param threads 0 - defaultThreadCount()
+ * @return the levels, largest first
+ */
+std::vector<ByteMatrix> gaussianPyramid(const ConstByteMatrixView &image, int levels, int threads = 0);
+
+/**
+ * laplacian pyramid: level i is gaussian level i - pyramidUp(gaussian level i + 1), the last level
+ * is the last gaussian level. collapseLaplacianPyramid gives the image back.
+ * throws std::invalid_argument unless levels >= 1.
+ * @param image
+ * @param levels
+ * @param threads 0 - defaultThreadCount()
+ * @return the levels, largest first
+ */
+std::vector<Matrix> laplacianPyramid(const ConstMatrixView &image, int levels, int threads = 0);
+
+/**
+ * laplacian pyramid of an 8 bit image (levels are signed, so float)
+ * @param image
+ * @param levels
+ * @param threads 0 - defaultThreadCount()
+ * @return the levels, largest first
+ */
+std::vector<Matrix> laplacianPyramid(const ConstByteMatrixView &image, int levels, int threads = 0);
+
+/**
+ * rebuilds the image from its laplacian pyramid: from the last level up, pyramidUp and add
+ * throws std::invalid_argument if the pyramid is empty or its sizes do not halve.
+ * @param pyramid
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix collapseLaplacianPyramid(const std::vector<Matrix> &pyramid, int threads = 0);
+
+/**
+ * resamples the image to rows x cols. pixel centres are aligned (pixel x of the result is centred
+ * on source coordinate (x + 0.5) * cols / newCols - 0.5). separable: each needed source row is
+ * resampled along the row from precomputed taps, then output rows are blended from those rows,
+ * whole rows at a time (vectorizes). rows are split between threads. not rounded.
+ * throws std::invalid_argument unless rows, cols >= 1.
+ * @param image
+ * @param rows
+ * @param cols
+ * @param interpolation
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix resize(const ConstMatrixView &image, int rows, int cols, Interpolation interpolation = Interpolation::Bilinear,
+              int threads = 0);
+
+/**
+ * resamples an 8 bit image (rounded and saturated)
+ * @param image
+ * @param rows
+ * @param cols
+ * @param interpolation
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix resize(const ConstByteMatrixView &image, int rows, int cols,
+                  Interpolation interpolation = Interpolation::Bilinear, int threads = 0);
+
+/**
+ * Operator Quantization
+ * Performs quantization on the input image by the given number of levels.
+ * Returns new matrix which is the result of running the operator on the image
+ * pixel p falls in level p * levels / 256 (rounded down) and is replaced by the middle of that
+ * level's range, so level counts that do not divide 256 split it as evenly as possible.
+ * throws std::invalid_argument unless 1 <= levels <= 256.
+ * @param image
+ * @param levels
+ * @return
+ */
+Matrix quantization(const ConstMatrixView &image, int levels);
+
+/**
+ * Operator Quantization on an 8 bit image - apply_lut with quantizationTable(levels)
+ * @param image
+ * @param levels
+ * @return
+ */
+ByteMatrix quantization(const ConstByteMatrixView &image, int levels);
+
+/**
+ * the quantization of every 8 bit value, as a table
+ * throws std::invalid_argument unless 1 <= levels <= 256.
+ * @param levels
+ * @return
+ */
+LookupTable quantizationTable(int levels);
+
+/**
+ * maps every pixel through the table: res(i, j) = lut[image(i, j)].
+ * a single pass over the image (the table stays in L1), rows are split between threads.
+ * @param image
+ * @param lut
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix apply_lut(const ConstByteMatrixView &image, const LookupTable &lut, int threads = 0);
+
+/**
+ * apply_lut into an existing image (or view) of the same size - may be the input itself
+ * Check dimensions valid for operation.
+ * @param image
+ * @param lut
+ * @param res
+ * @param threads 0 - defaultThreadCount()
+ */
+void apply_lut(const ConstByteMatrixView &image, const LookupTable &lut, const ByteMatrixView &res, int threads = 0);
+
+/**
+ *  make sure mat vals are in range
+ * @param numCells
+ * @param res
+ * @return
+ */
+Matrix &makeMatrixInBounds(int numCells, Matrix &res);
+
+/**
+ * Gaussian Blurring
+ * Performs gaussian blurring on the input image.
+ * Returns new matrix which is the result of running the operator on the image
+ * (the 3x3 kernel as its [1 2 1] / 4 row and column passes).
+ * @param image
+ * @return
+ */
+Matrix blur(const ConstMatrixView &image);
+
+/**
+ * Gaussian Blurring of an 8 bit image
+ * @param image
+ * @return
+ */
+ByteMatrix blur(const ConstByteMatrixView &image);
+
+/**
+ * norm of the sobel gradient (gx, gy)
+ */
+enum class GradientNorm
+{
+    /**
+     * |gx| + |gy|
+     */
+    L1,
+    /**
+     * sqrt(gx^2 + gy^2), the true magnitude
+     */
+    L2
+};
+
+/**
+ * Sobel operator (edge detection)
+ * Performs sobel edge detection on the input image.
+ * Returns new matrix which is the result of running the operator on the image:
+ * the rounded SOBEL_KERNEL_X and SOBEL_KERNEL_Y responses added and clamped to [0,255]
+ * (a signed sum, so edges of one direction cancel - see sobelMagnitude for the gradient norm).
+ * both responses are computed in a single sweep over the image; rows are split between threads.
+ * @param image
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix sobel(const ConstMatrixView &image, int threads = 0);
+
+/**
+ * Sobel operator (edge detection) on an 8 bit image.
+ * both gradients are kept in float so negative responses are not clipped before summing.
+ * @param image
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix sobel(const ConstByteMatrixView &image, int threads = 0);
+
+/**
+ * sobel gradient magnitude, fused: gx and gy (the SOBEL_KERNEL_X / SOBEL_KERNEL_Y responses, so a
+ * step of 255 gives 127.5) are computed per pixel in one sweep over the image, combined by the
+ * norm, rounded and clamped to [0,255] before they are stored - no intermediate images.
+ * rows are split between threads. pixels past the edges are zero, like sobel().
+ * @param image
+ * @param norm L1 or L2
+ * @param orientation if not null, set to the gradient direction atan2(dy, dx) in radians
+ *        ([-pi, pi], x grows to the right and y downwards)
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+Matrix sobelMagnitude(const ConstMatrixView &image, GradientNorm norm = GradientNorm::L2,
+                      Matrix *orientation = nullptr, int threads = 0);
+
+/**
+ * sobel gradient magnitude of an 8 bit image
+ * @param image
+ * @param norm
+ * @param orientation if not null, set to the gradient direction in radians
+ * @param threads 0 - defaultThreadCount()
+ * @return
+ */
+ByteMatrix sobelMagnitude(const ConstByteMatrixView &image, GradientNorm norm = GradientNorm::L2,
+                          Matrix *orientation = nullptr, int threads = 0);
+
+#endif //EX5_FILTERS_H
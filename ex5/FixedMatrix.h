@@ -0,0 +1,347 @@
+
+
+#ifndef EX5_FIXEDMATRIX_H
+
+// ------------------------------ includes ------------------------------
+
+#include <type_traits>
+#include "Matrix.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_FIXEDMATRIX_H
+
+// ------------------------------ class FixedMatrix -----------------------------
+
+/**
+ *  R x C matrix whose size is known at compile time.
+ *  the elements live inside the object (stack / static storage, never the heap), every loop has a
+ *  constant trip count so the compiler unrolls it, and everything is constexpr - a kernel such as
+ *  the 3x3 blur can be a compile time constant.
+ *  converts to a read only view, so it can be passed wherever a Matrix operand is taken
+ *  (operator*, convolution...).
+ *  T is float or double.
+ */
+template<typename T, int R, int C>
+class FixedMatrix
+{
+    static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+    static_assert(std::is_floating_point<T>::value, "FixedMatrix elements must be float or double");
+
+public:
+    /**
+     * type of a single element
+     */
+    typedef T ElementType;
+    /**
+     * read only view of the elements
+     */
+    typedef BasicMatrixView<const T> ConstView;
+
+private:
+
+    T _data[R * C];
+
+public:
+    /**
+     * Constructor
+     * all elements are 0
+     */
+    constexpr FixedMatrix() : _data{}
+    {
+
+    }
+
+    /**
+     * Constructor
+     * the R * C elements in row major order, e.g
+     * constexpr FixedMatrix<float, 2, 2> m(1, 2, 3, 4);
+     * @param values
+     */
+    template<typename... Values, typename = typename std::enable_if<sizeof...(Values) == R * C>::type>
+    constexpr explicit FixedMatrix(Values... values) : _data{static_cast<T>(values)...}
+    {
+
+    }
+
+    /**
+     * @return amount of rows
+     */
+    static constexpr int getRows()
+    {
+        return R;
+    }
+
+    /**
+     * @return amount of cols
+     */
+    static constexpr int getCols()
+    {
+        return C;
+    }
+
+    /**
+     * @return pointer to the R * C row major elements
+     */
+    constexpr T *data()
+    {
+        return this->_data;
+    }
+
+    /**
+     * @return pointer to the R * C row major elements
+     */
+    constexpr const T *data() const
+    {
+        return this->_data;
+    }
+
+    /**
+     * Parenthesis indexing
+     * @param row
+     * @param col
+     * @return element
+     */
+    constexpr T &operator()(int row, int col)
+    {
+        MATRIX_DEBUG_CHECK(row >= 0 && row < R && col >= 0 && col < C, IDX_OUT_OF_RANGE);
+        return this->_data[row * C + col];
+    }
+
+    /**
+     * Parenthesis indexing
+     * @param row
+     * @param col
+     * @return element
+     */
+    constexpr const T &operator()(int row, int col) const
+    {
+        MATRIX_DEBUG_CHECK(row >= 0 && row < R && col >= 0 && col < C, IDX_OUT_OF_RANGE);
+        return this->_data[row * C + col];
+    }
+
+    /**
+     * Brackets indexing (row major)
+     * @param i
+     * @return element
+     */
+    constexpr T &operator[](int i)
+    {
+        MATRIX_DEBUG_CHECK(i >= 0 && i < R * C, IDX_OUT_OF_RANGE);
+        return this->_data[i];
+    }
+
+    /**
+     * Brackets indexing (row major)
+     * @param i
+     * @return element
+     */
+    constexpr const T &operator[](int i) const
+    {
+        MATRIX_DEBUG_CHECK(i >= 0 && i < R * C, IDX_OUT_OF_RANGE);
+        return this->_data[i];
+    }
+
+    /**
+     * read only view of the elements, valid while this object lives
+     * @return
+     */
+    ConstView view() const
+    {
+        return ConstView(this->_data, R, C);
+    }
+
+    /**
+     * FixedMatrix can be passed wherever a read only view is taken
+     * @return view()
+     */
+    operator ConstView() const
+    {
+        return this->view();
+    }
+
+    /**
+     * @return a dynamic Matrix holding the same elements
+     */
+    BasicMatrix<T> toMatrix() const
+    {
+        return BasicMatrix<T>(this->view());
+    }
+
+    /**
+     * Matrix multiplication, the result size is known at compile time
+     * @param rhs
+     * @return this * rhs
+     */
+    template<int K>
+    constexpr FixedMatrix<T, R, K> operator*(const FixedMatrix<T, C, K> &rhs) const
+    {
+        FixedMatrix<T, R, K> res;
+        for (int i = 0; i < R; ++i)
+        {
+            for (int j = 0; j < K; ++j)
+            {
+                T sum = 0;
+                for (int p = 0; p < C; ++p)
+                {
+                    sum += this->_data[i * C + p] * rhs.data()[p * K + j];
+                }
+                res.data()[i * K + j] = sum;
+            }
+        }
+        return res;
+    }
+
+    /**
+     * Matrix multiplication with a dynamic matrix (or view)
+     * Check dimensions valid for operation.
+     * @param rhs
+     * @return this * rhs
+     */
+    BasicMatrix<T> operator*(const ConstView &rhs) const
+    {
+        return this->view() * rhs;
+    }
+
+    /**
+     * Scalar multiplication
+     * @param c
+     * @return updated matrix
+     */
+    constexpr FixedMatrix &operator*=(T c)
+    {
+        for (int i = 0; i < R * C; ++i)
+        {
+            this->_data[i] *= c;
+        }
+        return *this;
+    }
+
+    /**
+     * Scalar mult. On the right
+     * @param c
+     * @return new matrix
+     */
+    constexpr FixedMatrix operator*(T c) const
+    {
+        FixedMatrix res(*this);
+        return res *= c;
+    }
+
+    /**
+     * Matrix addition accumulation
+     * @param rhs
+     * @return updated matrix
+     */
+    constexpr FixedMatrix &operator+=(const FixedMatrix &rhs)
+    {
+        for (int i = 0; i < R * C; ++i)
+        {
+            this->_data[i] += rhs._data[i];
+        }
+        return *this;
+    }
+
+    /**
+     * Matrix addition
+     * @param rhs
+     * @return new matrix
+     */
+    constexpr FixedMatrix operator+(const FixedMatrix &rhs) const
+    {
+        FixedMatrix res(*this);
+        return res += rhs;
+    }
+
+    /**
+     * Matrix subtraction accumulation
+     * @param rhs
+     * @return updated matrix
+     */
+    constexpr FixedMatrix &operator-=(const FixedMatrix &rhs)
+    {
+        for (int i = 0; i < R * C; ++i)
+        {
+            this->_data[i] -= rhs._data[i];
+        }
+        return *this;
+    }
+
+    /**
+     * Matrix subtraction
+     * @param rhs
+     * @return new matrix
+     */
+    constexpr FixedMatrix operator-(const FixedMatrix &rhs) const
+    {
+        FixedMatrix res(*this);
+        return res -= rhs;
+    }
+
+    /**
+     * @return the C x R transpose
+     */
+    constexpr FixedMatrix<T, C, R> transpose() const
+    {
+        FixedMatrix<T, C, R> res;
+        for (int i = 0; i < R; ++i)
+        {
+            for (int j = 0; j < C; ++j)
+            {
+                res.data()[j * R + i] = this->_data[i * C + j];
+            }
+        }
+        return res;
+    }
+
+    /**
+     * Equality
+     * @param rhs
+     * @return true if all elements are equal
+     */
+    constexpr bool operator==(const FixedMatrix &rhs) const
+    {
+        for (int i = 0; i < R * C; ++i)
+        {
+            if (this->_data[i] != rhs._data[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Inequality
+     * @param rhs
+     * @return true if some element differs
+     */
+    constexpr bool operator!=(const FixedMatrix &rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+/**
+ * Scalar mult. On the left
+ * @param c
+ * @param m
+ * @return new matrix
+ */
+template<typename T, int R, int C>
+constexpr FixedMatrix<T, R, C> operator*(T c, const FixedMatrix<T, R, C> &m)
+{
+    return m * c;
+}
+
+/**
+ * 3x3 single precision matrix (filter kernels, 2d homogeneous transforms)
+ */
+typedef FixedMatrix<float, 3, 3> Matrix3f;
+
+/**
+ * 4x4 single precision matrix (3d homogeneous transforms)
+ */
+typedef FixedMatrix<float, 4, 4> Matrix4f;
+
+#endif //EX5_FIXEDMATRIX_H
@@ -0,0 +1,349 @@
+
+// ------------------------------ includes ------------------------------
+#include "FrameStream.h"
+#include "MatrixIO.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * blocking queue of buffer indices between two stages.
+ * close(): no more pushes, pop drains what is queued then fails. cancel(): pop fails at once.
+ */
+class FrameQueue
+{
+private:
+
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::deque<int> _items;
+    bool _closed, _cancelled;
+
+public:
+    /**
+     * Constructor
+     */
+    FrameQueue() : _closed(false), _cancelled(false)
+    {
+    }
+
+    /**
+     * adds a buffer index
+     */
+    void push(int item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _items.push_back(item);
+        }
+        _ready.notify_one();
+    }
+
+    /**
+     * waits for a buffer index
+     * @return false if the queue was closed and is empty, or cancelled
+     */
+    bool pop(int &item)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _ready.wait(lock, [this]()
+        {
+            return _cancelled || _closed || !_items.empty();
+        });
+        if (_cancelled || _items.empty())
+        {
+            return false;
+        }
+        item = _items.front();
+        _items.pop_front();
+        return true;
+    }
+
+    /**
+     * the producer is done
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _ready.notify_all();
+    }
+
+    /**
+     * a stage failed - wake everybody up
+     */
+    void cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _cancelled = true;
+        }
+        _ready.notify_all();
+    }
+};
+
+/**
+ * a stage's latencies, filled by timing its callback
+ */
+static StageLatency emptyLatency()
+{
+    StageLatency latency;
+    latency.frames = 0;
+    latency.totalSeconds = 0;
+    latency.minSeconds = std::numeric_limits<double>::infinity();
+    latency.maxSeconds = 0;
+    return latency;
+}
+
+/**
+ * runs call() and adds its duration to latency
+ */
+template<typename Call>
+static auto timed(StageLatency &latency, const Call &call) -> decltype(call())
+{
+    auto start = std::chrono::steady_clock::now();
+    struct Record
+    {
+        StageLatency &latency;
+        std::chrono::steady_clock::time_point start;
+
+        ~Record()
+        {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            latency.totalSeconds += seconds;
+            latency.minSeconds = std::min(latency.minSeconds, seconds);
+            latency.maxSeconds = std::max(latency.maxSeconds, seconds);
+        }
+    } record{latency, start};
+    return call();
+}
+
+// ------------------------------ class StageLatency -----------------------------
+
+/**
+ * @return mean time per frame
+ */
+double StageLatency::meanSeconds() const
+{
+    return frames == 0 ? 0 : totalSeconds / frames;
+}
+
+/**
+ * @return frames / seconds
+ */
+double FrameStreamStats::framesPerSecond() const
+{
+    return seconds > 0 ? frames / seconds : 0;
+}
+
+// ------------------------------ class FrameStream -----------------------------
+
+/**
+ * Constructor
+ * @param rows
+ * @param cols
+ * @param depth
+ */
+FrameStream::FrameStream(int rows, int cols, int depth) : _rows(rows), _cols(cols)
+{
+    if (rows <= 0 || cols <= 0 || depth <= 0)
+    {
+        matrixError<std::invalid_argument>(INVALID_FRAME_STREAM);
+    }
+    for (int i = 0; i < depth; ++i)
+    {
+        _inputs.emplace_back(rows, cols, MatrixInit::Uninitialized);
+        _outputs.emplace_back(rows, cols, MatrixInit::Uninitialized);
+    }
+}
+
+/**
+ * @return frame rows
+ */
+int FrameStream::getRows() const
+{
+    return _rows;
+}
+
+/**
+ * @return frame cols
+ */
+int FrameStream::getCols() const
+{
+    return _cols;
+}
+
+/**
+ * runs the stream: buffers cycle free inputs -> reader -> filled -> filter -> filtered -> writer
+ * -> free outputs, the filter also returning its input to the free inputs.
+ * @param reader
+ * @param filter
+ * @param writer
+ * @return
+ */
+FrameStreamStats FrameStream::run(const FrameReader &reader, const FrameFilter &filter, const FrameWriter &writer)
+{
+    FrameStreamStats stats;
+    stats.read = emptyLatency();
+    stats.filter = emptyLatency();
+    stats.write = emptyLatency();
+    FrameQueue freeInputs, filled, freeOutputs, filtered;
+    for (int i = 0; i < static_cast<int>(_inputs.size()); ++i)
+    {
+        freeInputs.push(i);
+        freeOutputs.push(i);
+    }
+    std::exception_ptr errors[3];
+    auto cancelAll = [&]()
+    {
+        freeInputs.cancel();
+        filled.cancel();
+        freeOutputs.cancel();
+        filtered.cancel();
+    };
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread readThread([&]()
+    {
+        try
+        {
+            int in;
+            while (freeInputs.pop(in))
+            {
+                if (!timed(stats.read, [&]()
+                {
+                    return reader(_inputs[in].view());
+                }))
+                {
+                    break;
+                }
+                ++stats.read.frames;
+                filled.push(in);
+            }
+            filled.close();
+        }
+        catch (...)
+        {
+            errors[0] = std::current_exception();
+            cancelAll();
+        }
+    });
+    std::thread writeThread([&]()
+    {
+        try
+        {
+            int out;
+            while (filtered.pop(out))
+            {
+                timed(stats.write, [&]()
+                {
+                    writer(_outputs[out].view());
+                });
+                ++stats.write.frames;
+                freeOutputs.push(out);
+            }
+        }
+        catch (...)
+        {
+            errors[2] = std::current_exception();
+            cancelAll();
+        }
+    });
+    try
+    {
+        int in, out;
+        while (filled.pop(in) && freeOutputs.pop(out))
+        {
+            timed(stats.filter, [&]()
+            {
+                filter(_inputs[in].view(), _outputs[out].view());
+            });
+            ++stats.filter.frames;
+            freeInputs.push(in);
+            filtered.push(out);
+        }
+        filtered.close();
+    }
+    catch (...)
+    {
+        errors[1] = std::current_exception();
+        cancelAll();
+    }
+    readThread.join();
+    writeThread.join();
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.frames = stats.write.frames;
+    for (StageLatency *latency : {&stats.read, &stats.filter, &stats.write})
+    {
+        if (latency->frames == 0)
+        {
+            latency->minSeconds = 0;
+        }
+    }
+    return stats;
+}
+
+/**
+ * runs the stream with a filter pipeline
+ * @param reader
+ * @param pipeline
+ * @param writer
+ * @param threads
+ * @return
+ */
+FrameStreamStats FrameStream::run(const FrameReader &reader, const FilterPipeline &pipeline,
+                                  const FrameWriter &writer, int threads)
+{
+    return run(reader, [&](const ConstByteMatrixView &frame, const ByteMatrixView &out)
+    {
+        pipeline.run(frame, out, threads);
+    }, writer);
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * reader of binary 8 bit matrices
+ * @param is
+ * @return
+ */
+FrameStream::FrameReader binaryFrameReader(std::istream &is)
+{
+    return [&is](const ByteMatrixView &frame)
+    {
+        if (is.peek() == std::char_traits<char>::eof())
+        {
+            return false;
+        }
+        readBinary(is, frame);
+        return true;
+    };
+}
+
+/**
+ * writer of binary 8 bit matrices
+ * @param os
+ * @return
+ */
+FrameStream::FrameWriter binaryFrameWriter(std::ostream &os)
+{
+    return [&os](const ConstByteMatrixView &frame)
+    {
+        writeBinary(os, frame);
+    };
+}
@@ -0,0 +1,180 @@
+
+
+#ifndef EX5_FRAMESTREAM_H
+
+// ------------------------------ includes ------------------------------
+
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "Matrix.h"
+#include "FilterPipeline.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_FRAMESTREAM_H
+/**
+ * default number of input (and of output) frame buffers - one being read or written, one being
+ * filtered and one waiting, so no stage waits for a buffer while the others keep up
+ */
+#define FRAME_STREAM_DEPTH 3
+/**
+ * error - a stream needs a frame size and at least one buffer of each kind
+ */
+#define INVALID_FRAME_STREAM "Invalid frame stream size.\n"
+
+// ------------------------------ class FrameStream -----------------------------
+
+/**
+ *  latency of one stage of a FrameStream run, in seconds per frame
+ */
+struct StageLatency
+{
+    /**
+     * frames the stage handled
+     */
+    long frames;
+    /**
+     * time spent in the stage's callback, in total
+     */
+    double totalSeconds;
+    /**
+     * fastest frame
+     */
+    double minSeconds;
+    /**
+     * slowest frame
+     */
+    double maxSeconds;
+
+    /**
+     * @return mean time per frame (0 if no frames)
+     */
+    double meanSeconds() const;
+};
+
+/**
+ *  statistics of a FrameStream run
+ */
+struct FrameStreamStats
+{
+    /**
+     * frames read, filtered and written
+     */
+    long frames;
+    /**
+     * wall clock time of the whole run
+     */
+    double seconds;
+    /**
+     * the reader callback
+     */
+    StageLatency read;
+    /**
+     * the filter
+     */
+    StageLatency filter;
+    /**
+     * the writer callback
+     */
+    StageLatency write;
+
+    /**
+     * @return throughput, frames / seconds - bounded by the slowest stage, not by their sum
+     */
+    double framesPerSecond() const;
+};
+
+/**
+ *  filters a stream of same sized 8 bit frames (e.g video) in a three stage pipeline:
+ *  a reader thread fills input frames, the calling thread filters them into output frames and a
+ *  writer thread consumes those - so frame n + 1 is read while frame n is filtered and frame n - 1
+ *  written. the frames are a fixed set of depth input and depth output buffers, allocated once by
+ *  the constructor and handed around in bounded queues, so a run allocates nothing per frame and
+ *  the buffers are reused by later runs.
+ *  an exception thrown by any stage stops the other two and is rethrown by run().
+ */
+class FrameStream
+{
+public:
+    /**
+     * fills the next frame (rows x cols) in place; returns false, leaving it unused, when the
+     * stream has ended. called on the reader thread.
+     */
+    typedef std::function<bool(const ByteMatrixView &frame)> FrameReader;
+    /**
+     * filters a frame into an output frame of the same size. called on the calling thread.
+     */
+    typedef std::function<void(const ConstByteMatrixView &frame, const ByteMatrixView &out)> FrameFilter;
+    /**
+     * consumes a filtered frame; the view is valid only during the call (the buffer is reused).
+     * called on the writer thread, in the order the frames were read.
+     */
+    typedef std::function<void(const ConstByteMatrixView &frame)> FrameWriter;
+
+private:
+
+    int _rows, _cols;
+    std::vector<ByteMatrix> _inputs, _outputs;
+
+public:
+    /**
+     * Constructor
+     * allocates the frame buffers.
+     * Check rows, cols and depth are positive.
+     * @param rows
+     * @param cols
+     * @param depth input (and output) buffers
+     */
+    FrameStream(int rows, int cols, int depth = FRAME_STREAM_DEPTH);
+
+    /**
+     * @return frame rows
+     */
+    int getRows() const;
+
+    /**
+     * @return frame cols
+     */
+    int getCols() const;
+
+    /**
+     * runs the stream until the reader reports its end and every frame read was written
+     * @param reader
+     * @param filter
+     * @param writer
+     * @return per stage latencies and throughput
+     */
+    FrameStreamStats run(const FrameReader &reader, const FrameFilter &filter, const FrameWriter &writer);
+
+    /**
+     * runs the stream with a filter pipeline, written straight into the output buffers
+     * @param reader
+     * @param pipeline
+     * @param writer
+     * @param threads threads of the pipeline, 0 - defaultThreadCount()
+     * @return per stage latencies and throughput
+     */
+    FrameStreamStats run(const FrameReader &reader, const FilterPipeline &pipeline, const FrameWriter &writer,
+                         int threads = 0);
+};
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * reader of the 8 bit matrices written one after the other in the binary format (see
+ * MatrixIO.h) - read straight into the frame buffers; ends at the end of the stream.
+ * throws (in run()) if a frame is not a matrix of the stream's size.
+ * @param is must outlive the run
+ * @return
+ */
+FrameStream::FrameReader binaryFrameReader(std::istream &is);
+
+/**
+ * writer of every frame to os in the binary format
+ * @param os must outlive the run
+ * @return
+ */
+FrameStream::FrameWriter binaryFrameWriter(std::ostream &os);
+
+#endif //EX5_FRAMESTREAM_H
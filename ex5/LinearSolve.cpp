@@ -0,0 +1,400 @@
+
+// ------------------------------ includes ------------------------------
+#include "LinearSolve.h"
+#include "MatrixKernels.h"
+#include "ParallelFor.h"
+#include <cmath>
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * C[m x n] -= A[m x k] * B[k x n] (or A * B^T when bTransposed, B then being n x k) for the
+ * trailing updates. -A is copied once so the update is a plain multiply-accumulate; row blocks of
+ * C are split between threads.
+ */
+template<typename T>
+static void subtractProduct(int m, int n, int k, const T *a, int lda, const T *b, int ldb, T *c, int ldc,
+                            bool bTransposed, int threads)
+{
+    if (m <= 0 || n <= 0 || k <= 0)
+    {
+        return;
+    }
+    std::vector<T> negA(static_cast<size_t>(m) * k);
+    for (int i = 0; i < m; ++i)
+    {
+        for (int p = 0; p < k; ++p)
+        {
+            negA[static_cast<size_t>(i) * k + p] = -a[static_cast<long>(i) * lda + p];
+        }
+    }
+    threads = resolveThreadCount(threads, static_cast<long>(m) * n * k / GEMM_BLOCK_ROWS);
+    parallelFor(0, m, threads, [&](int rowBegin, int rowEnd)
+    {
+        const T *aRows = negA.data() + static_cast<size_t>(rowBegin) * k;
+        T *cRows = c + static_cast<long>(rowBegin) * ldc;
+        if (bTransposed)
+        {
+            gemmNTAccumulate(rowEnd - rowBegin, n, k, aRows, k, b, ldb, cRows, ldc);
+        }
+        else
+        {
+            gemmAccumulate(rowEnd - rowBegin, n, k, aRows, k, b, ldb, cRows, ldc);
+        }
+    });
+}
+
+/**
+ * forward substitution with the lower triangle of l (unit diagonal when unitDiagonal) on the n x k
+ * right hand sides x, in place. whole rows of x are updated at a time.
+ */
+template<typename T>
+static void forwardSubstitute(const BasicMatrix<T> &l, bool unitDiagonal, BasicMatrix<T> &x)
+{
+    int n = l.getRows();
+    int k = x.getCols();
+    for (int i = 0; i < n; ++i)
+    {
+        const T *lRow = l.row_ptr(i);
+        T *xi = x.row_ptr(i);
+        for (int j = 0; j < i; ++j)
+        {
+            const T lij = lRow[j];
+            const T *xj = x.row_ptr(j);
+            for (int c = 0; c < k; ++c)
+            {
+                xi[c] -= lij * xj[c];
+            }
+        }
+        if (!unitDiagonal)
+        {
+            for (int c = 0; c < k; ++c)
+            {
+                xi[c] /= lRow[i];
+            }
+        }
+    }
+}
+
+/**
+ * backward substitution with the upper triangle of u on the n x k right hand sides x, in place.
+ * when transposed, the upper triangle used is l^T (l read below its diagonal).
+ */
+template<typename T>
+static void backwardSubstitute(const BasicMatrix<T> &u, bool transposed, BasicMatrix<T> &x)
+{
+    int n = u.getRows();
+    int k = x.getCols();
+    for (int i = n - 1; i >= 0; --i)
+    {
+        T *xi = x.row_ptr(i);
+        for (int j = i + 1; j < n; ++j)
+        {
+            const T uij = transposed ? u.unchecked(j, i) : u.unchecked(i, j);
+            const T *xj = x.row_ptr(j);
+            for (int c = 0; c < k; ++c)
+            {
+                xi[c] -= uij * xj[c];
+            }
+        }
+        const T uii = u.unchecked(i, i);
+        for (int c = 0; c < k; ++c)
+        {
+            xi[c] /= uii;
+        }
+    }
+}
+
+/**
+ * n x n identity
+ */
+template<typename T>
+static BasicMatrix<T> identity(int n)
+{
+    BasicMatrix<T> res(n, n);
+    for (int i = 0; i < n; ++i)
+    {
+        res.unchecked(i, i) = 1;
+    }
+    return res;
+}
+
+// ------------------------------ LU -----------------------------
+
+/**
+ * Constructor
+ * for every FACTORIZATION_BLOCK wide panel:
+ *  1. factor the panel (all rows below its top) column by column with partial pivoting,
+ *     swapping whole rows
+ *  2. U12 = L11^-1 A12 for the block row right of the panel
+ *  3. A22 -= L21 U12 for the trailing matrix
+ * @param a
+ * @param threads
+ */
+template<typename T>
+BasicLUDecomposition<T>::BasicLUDecomposition(const BasicMatrixView<const T> &a, int threads) : _lu(a), _sign(1),
+                                                                                                 _singular(false)
+{
+    if (a.getRows() != a.getCols())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    int n = a.getRows();
+    this->_pivots.resize(n);
+    T *lu = this->_lu.data();
+    for (int k0 = 0; k0 < n; k0 += FACTORIZATION_BLOCK)
+    {
+        int kEnd = std::min(n, k0 + FACTORIZATION_BLOCK);
+        // 1. panel
+        for (int j = k0; j < kEnd; ++j)
+        {
+            int p = j;
+            for (int i = j + 1; i < n; ++i)
+            {
+                if (std::abs(lu[static_cast<long>(i) * n + j]) > std::abs(lu[static_cast<long>(p) * n + j]))
+                {
+                    p = i;
+                }
+            }
+            this->_pivots[j] = p;
+            if (p != j)
+            {
+                std::swap_ranges(this->_lu.row_ptr(j), this->_lu.row_ptr(j) + n, this->_lu.row_ptr(p));
+                this->_sign = -this->_sign;
+            }
+            const T pivot = lu[static_cast<long>(j) * n + j];
+            if (pivot == T(0))
+            {
+                this->_singular = true;
+                continue;
+            }
+            const T *pivotRow = this->_lu.row_ptr(j);
+            for (int i = j + 1; i < n; ++i)
+            {
+                T *row = this->_lu.row_ptr(i);
+                row[j] /= pivot;
+                const T lij = row[j];
+                for (int c = j + 1; c < kEnd; ++c)
+                {
+                    row[c] -= lij * pivotRow[c];
+                }
+            }
+        }
+        if (kEnd == n)
+        {
+            break;
+        }
+        // 2. U12
+        for (int j = k0; j < kEnd; ++j)
+        {
+            const T *uRow = this->_lu.row_ptr(j) + kEnd;
+            for (int i = j + 1; i < kEnd; ++i)
+            {
+                T *row = this->_lu.row_ptr(i);
+                const T lij = row[j];
+                for (int c = 0; c < n - kEnd; ++c)
+                {
+                    row[kEnd + c] -= lij * uRow[c];
+                }
+            }
+        }
+        // 3. trailing update
+        subtractProduct(n - kEnd, n - kEnd, kEnd - k0, this->_lu.row_ptr(kEnd) + k0, n, this->_lu.row_ptr(k0) + kEnd,
+                        n, this->_lu.row_ptr(kEnd) + kEnd, n, false, threads);
+    }
+}
+
+/**
+ * @return true if a zero pivot was met
+ */
+template<typename T>
+bool BasicLUDecomposition<T>::isSingular() const
+{
+    return this->_singular;
+}
+
+/**
+ * @return L and U packed in one matrix
+ */
+template<typename T>
+const BasicMatrix<T> &BasicLUDecomposition<T>::packed() const
+{
+    return this->_lu;
+}
+
+/**
+ * @return the row swaps
+ */
+template<typename T>
+const std::vector<int> &BasicLUDecomposition<T>::pivots() const
+{
+    return this->_pivots;
+}
+
+/**
+ * solves A X = B: X = U^-1 L^-1 P B
+ * @param b
+ * @return X
+ */
+template<typename T>
+BasicMatrix<T> BasicLUDecomposition<T>::solve(const BasicMatrixView<const T> &b) const
+{
+    if (b.getRows() != this->_lu.getRows())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    if (this->_singular)
+    {
+        matrixError<std::domain_error>(SINGULAR_MATRIX);
+    }
+    BasicMatrix<T> x(b);
+    for (int i = 0; i < static_cast<int>(this->_pivots.size()); ++i)
+    {
+        if (this->_pivots[i] != i)
+        {
+            std::swap_ranges(x.row_ptr(i), x.row_ptr(i) + x.getCols(), x.row_ptr(this->_pivots[i]));
+        }
+    }
+    forwardSubstitute(this->_lu, true, x);
+    backwardSubstitute(this->_lu, false, x);
+    return x;
+}
+
+/**
+ * @return A^-1
+ */
+template<typename T>
+BasicMatrix<T> BasicLUDecomposition<T>::inverse() const
+{
+    return this->solve(identity<T>(this->_lu.getRows()));
+}
+
+/**
+ * @return det(A)
+ */
+template<typename T>
+T BasicLUDecomposition<T>::determinant() const
+{
+    T det = static_cast<T>(this->_sign);
+    for (int i = 0; i < this->_lu.getRows(); ++i)
+    {
+        det *= this->_lu.unchecked(i, i);
+    }
+    return det;
+}
+
+// ------------------------------ Cholesky -----------------------------
+
+/**
+ * Constructor
+ * for every FACTORIZATION_BLOCK wide panel:
+ *  1. factor the diagonal block, L11 L11^T = A11
+ *  2. L21 = A21 L11^-T
+ *  3. A22 -= L21 L21^T, lower triangle only (block row by block row)
+ * @param a
+ * @param threads
+ */
+template<typename T>
+BasicCholeskyDecomposition<T>::BasicCholeskyDecomposition(const BasicMatrixView<const T> &a, int threads) : _l(a)
+{
+    if (a.getRows() != a.getCols())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    int n = a.getRows();
+    for (int k0 = 0; k0 < n; k0 += FACTORIZATION_BLOCK)
+    {
+        int kEnd = std::min(n, k0 + FACTORIZATION_BLOCK);
+        // 1. + 2. - every row below the panel top: a dot product against the rows above it
+        for (int j = k0; j < kEnd; ++j)
+        {
+            T *jRow = this->_l.row_ptr(j);
+            T d = jRow[j];
+            for (int p = k0; p < j; ++p)
+            {
+                d -= jRow[p] * jRow[p];
+            }
+            if (!(d > T(0)))
+            {
+                matrixError<std::domain_error>(NOT_POSITIVE_DEFINITE);
+            }
+            jRow[j] = std::sqrt(d);
+            for (int i = j + 1; i < n; ++i)
+            {
+                T *iRow = this->_l.row_ptr(i);
+                T s = iRow[j];
+                for (int p = k0; p < j; ++p)
+                {
+                    s -= iRow[p] * jRow[p];
+                }
+                iRow[j] = s / jRow[j];
+            }
+        }
+        // 3. trailing update, lower triangle: block row i0 needs columns [kEnd, iEnd)
+        for (int i0 = kEnd; i0 < n; i0 += FACTORIZATION_BLOCK)
+        {
+            int iEnd = std::min(n, i0 + FACTORIZATION_BLOCK);
+            subtractProduct(iEnd - i0, iEnd - kEnd, kEnd - k0, this->_l.row_ptr(i0) + k0, n,
+                            this->_l.row_ptr(kEnd) + k0, n, this->_l.row_ptr(i0) + kEnd, n, true, threads);
+        }
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        std::fill(this->_l.row_ptr(i) + i + 1, this->_l.row_ptr(i) + n, T(0));
+    }
+}
+
+/**
+ * @return L
+ */
+template<typename T>
+const BasicMatrix<T> &BasicCholeskyDecomposition<T>::lower() const
+{
+    return this->_l;
+}
+
+/**
+ * solves A X = B: X = L^-T L^-1 B
+ * @param b
+ * @return X
+ */
+template<typename T>
+BasicMatrix<T> BasicCholeskyDecomposition<T>::solve(const BasicMatrixView<const T> &b) const
+{
+    if (b.getRows() != this->_l.getRows())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    BasicMatrix<T> x(b);
+    forwardSubstitute(this->_l, false, x);
+    backwardSubstitute(this->_l, true, x);
+    return x;
+}
+
+/**
+ * @return A^-1
+ */
+template<typename T>
+BasicMatrix<T> BasicCholeskyDecomposition<T>::inverse() const
+{
+    return this->solve(identity<T>(this->_l.getRows()));
+}
+
+/**
+ * @return det(A)
+ */
+template<typename T>
+T BasicCholeskyDecomposition<T>::determinant() const
+{
+    T det = 1;
+    for (int i = 0; i < this->_l.getRows(); ++i)
+    {
+        det *= this->_l.unchecked(i, i);
+    }
+    return det * det;
+}
+
+template class BasicLUDecomposition<float>;
+template class BasicLUDecomposition<double>;
+template class BasicCholeskyDecomposition<float>;
+template class BasicCholeskyDecomposition<double>;
@@ -0,0 +1,200 @@
+
+
+#ifndef EX5_LINEARSOLVE_H
+
+// ------------------------------ includes ------------------------------
+
+#include <vector>
+#include "Matrix.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_LINEARSOLVE_H
+/**
+ * error - the matrix has no inverse (a zero pivot was met)
+ */
+#define SINGULAR_MATRIX "Singular matrix.\n"
+/**
+ * error - cholesky needs a symmetric positive definite matrix
+ */
+#define NOT_POSITIVE_DEFINITE "Matrix is not positive definite.\n"
+/**
+ * columns factored per panel by the blocked factorizations - the rest of the matrix is updated
+ * once per panel by the multiplication kernel
+ */
+#define FACTORIZATION_BLOCK 64
+
+// ------------------------------ class LU -----------------------------
+
+/**
+ *  LU decomposition with partial pivoting: P A = L U.
+ *  blocked right looking algorithm: a FACTORIZATION_BLOCK wide panel is factored column by column,
+ *  then the trailing matrix gets a single rank-FACTORIZATION_BLOCK update through the blocked
+ *  multiplication kernel (split between threads), so almost all the O(n^3) work runs at matrix
+ *  multiplication speed.
+ *  factor once, then solve for any number of right hand sides.
+ *  T is float or double (double is recommended for large systems).
+ */
+template<typename T>
+class BasicLUDecomposition
+{
+private:
+
+    BasicMatrix<T> _lu;
+    std::vector<int> _pivots;
+    int _sign;
+    bool _singular;
+
+public:
+    /**
+     * Constructor
+     * factors a.
+     * Check a is square.
+     * a singular matrix is factored as well (see isSingular) - only solving with it fails.
+     * @param a
+     * @param threads threads of the trailing updates, 0 - defaultThreadCount()
+     */
+    explicit BasicLUDecomposition(const BasicMatrixView<const T> &a, int threads = 0);
+
+    /**
+     * @return true if a zero pivot was met (the matrix has no inverse)
+     */
+    bool isSingular() const;
+
+    /**
+     * L (unit diagonal, below it) and U (diagonal and above) packed in one matrix
+     * @return
+     */
+    const BasicMatrix<T> &packed() const;
+
+    /**
+     * row i of the factored matrix was swapped with row pivots()[i] at step i
+     * @return
+     */
+    const std::vector<int> &pivots() const;
+
+    /**
+     * solves A X = B
+     * Check dimensions valid for operation, throws if A is singular.
+     * @param b n x k right hand sides
+     * @return X, n x k
+     */
+    BasicMatrix<T> solve(const BasicMatrixView<const T> &b) const;
+
+    /**
+     * @return A^-1 (throws if A is singular)
+     */
+    BasicMatrix<T> inverse() const;
+
+    /**
+     * @return det(A) = sign(P) * product of the diagonal of U
+     */
+    T determinant() const;
+};
+
+// ------------------------------ class Cholesky -----------------------------
+
+/**
+ *  Cholesky decomposition of a symmetric positive definite matrix: A = L L^T.
+ *  blocked like BasicLUDecomposition (half the work, no pivoting); only the lower triangle of A
+ *  is read.
+ */
+template<typename T>
+class BasicCholeskyDecomposition
+{
+private:
+
+    BasicMatrix<T> _l;
+
+public:
+    /**
+     * Constructor
+     * factors a.
+     * Check a is square, throws if a is not positive definite.
+     * @param a
+     * @param threads threads of the trailing updates, 0 - defaultThreadCount()
+     */
+    explicit BasicCholeskyDecomposition(const BasicMatrixView<const T> &a, int threads = 0);
+
+    /**
+     * @return L (zeros above the diagonal)
+     */
+    const BasicMatrix<T> &lower() const;
+
+    /**
+     * solves A X = B
+     * Check dimensions valid for operation.
+     * @param b n x k right hand sides
+     * @return X, n x k
+     */
+    BasicMatrix<T> solve(const BasicMatrixView<const T> &b) const;
+
+    /**
+     * @return A^-1
+     */
+    BasicMatrix<T> inverse() const;
+
+    /**
+     * @return det(A) = product of the diagonal of L, squared
+     */
+    T determinant() const;
+};
+
+/**
+ * single precision LU
+ */
+typedef BasicLUDecomposition<float> LUDecomposition;
+
+/**
+ * double precision LU
+ */
+typedef BasicLUDecomposition<double> DoubleLUDecomposition;
+
+/**
+ * single precision Cholesky
+ */
+typedef BasicCholeskyDecomposition<float> CholeskyDecomposition;
+
+/**
+ * double precision Cholesky
+ */
+typedef BasicCholeskyDecomposition<double> DoubleCholeskyDecomposition;
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * solves A X = B with a pivoted LU decomposition.
+ * takes matrices, views or FixedMatrix.
+ * @param a n x n
+ * @param b n x k
+ * @return X
+ */
+template<typename MA, typename MB, typename T = typename MA::ElementType>
+inline BasicMatrix<T> solve(const MA &a, const MB &b)
+{
+    return BasicLUDecomposition<T>(BasicMatrixView<const T>(a)).solve(BasicMatrixView<const T>(b));
+}
+
+/**
+ * inverse with a pivoted LU decomposition, throws if a is singular
+ * @param a n x n
+ * @return a^-1
+ */
+template<typename M, typename T = typename M::ElementType>
+inline BasicMatrix<T> inverse(const M &a)
+{
+    return BasicLUDecomposition<T>(BasicMatrixView<const T>(a)).inverse();
+}
+
+/**
+ * determinant with a pivoted LU decomposition
+ * @param a n x n
+ * @return det(a)
+ */
+template<typename M, typename T = typename M::ElementType>
+inline T determinant(const M &a)
+{
+    return BasicLUDecomposition<T>(BasicMatrixView<const T>(a)).determinant();
+}
+
+#endif //EX5_LINEARSOLVE_H
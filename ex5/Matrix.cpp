@@ -1,554 +1,938 @@
-
-
-// ------------------------------ includes ------------------------------
-#include "Matrix.h"
-#include<iostream>
-// ------------------------------ functions -----------------------------
-/**
- * Constructor
- * Constructs matrix rows * cols (need to make sure rows,cols are non negative).
- * Initiates all elements to 0.
- * @param rows
- * @param cols
- */
-Matrix::Matrix(int rows, int cols) : _rows(rows), _cols(cols)
-{
-    if (_rows < 0 || _cols < 0)
-    {
-        std::cerr << INVALID_MAT_DIMENSIONS;
-        exit(EXIT_FAILURE);
-    }
-    _mat = new float[_rows * _cols]();
-
-
-}
-
-/**
- * copy constructor
- * Constructs matrix from another matrix
- * @param m
- */
-Matrix::Matrix(const Matrix &m) : Matrix(m._rows, m._cols)
-{
-
-    this->_mat = new float[m._rows * m._cols]();
-    for (int i = 0; i < m._rows * m._cols; i++)
-    {
-        this->_mat[i] = m._mat[i];
-    }
-}
-
-/**
- * Default constructor
- * Constructs 1*1 matrix, where the single element is initiated to 0
- */
-Matrix::Matrix() : Matrix(DEFAULD_ROWS, DEFAULT_COLS)
-{
-
-}
-
-/**
- * Destructor
- * Destroys the matrix
- */
-Matrix::~Matrix()
-{
-    delete[] this->_mat;
-    this->_mat = nullptr;
-}
-
-/**
- * Returns the amount of rows (int).
- * @return
- */
-int Matrix::getRows() const
-{
-    return this->_rows;
-}
-
-/**
- * Returns the amount of columns (int).
- * @return
- */
-int Matrix::getCols() const
-{
-    return this->_cols;
-}
-
-/**
- * Transforms a matrix into a column vector.
- *  Supports function calling. I.E:
- *  Matrix m(5,4);
- *  m.vectorize();
- *  int r = m.getRows(); // suppose to return 20
- *  int c = m.getCols(); // suppose to return 1
-    [ 1, 2, 3]
-    [ 4, 5, 6] ⇒ transpose ( [1, 2, 3, 4, 5, 6, 7, 8, 9] )
-    [ 7, 8, 9]
- *
- * @return
- */
-Matrix Matrix::vectorize()
-{
-    // initailize new mat
-    this->_rows = getRows() * getCols();
-    this->_cols = 1;
-    return *this;
-}
-
-
-/**
- * Prints matrix elements, no return value (void).
- * Prints space after each element (not including the last element in the row).
- * Prints new line after each row (not including the last row)
- */
-void Matrix::print() const
-{
-    std::cout << *this;
-}
-
-/**
- * assignment
- * Matrix a, b;
- * a = b;
- * @param rhs
- * @return updated matrix
- */
-Matrix &Matrix::operator=(const Matrix &rhs)
-{
-    if (this == &rhs)
-    {
-        return *this;
-    }
-    this->_rows = rhs.getRows();
-    this->_cols = rhs.getCols();
-    delete[] this->_mat;
-    this->_mat = new float[rhs._rows * rhs._cols]();
-    for (int i = 0; i < rhs._rows * rhs._cols; i++)
-    {
-        this->_mat[i] = rhs._mat[i];
-    }
-    return *this;
-}
-
-
-/**
- * Matrix multiplication
- * Matrix a, b;
- * Matrix c = a * b
- * ** do not forget algebra rules for matrix multiplication.
- * Check dimensions valid for operation.
- * @param rhs
- * @return updated matrix
- */
-Matrix Matrix::operator*(const Matrix &rhs) const
-{
-    if (this->getCols() != rhs.getRows())
-    {
-        std::cerr << INVALID_MAT_DIMENSIONS;
-        exit(EXIT_FAILURE);
-    }
-    // can multiply matrix!!
-    // create mat in valid size:
-    Matrix res(this->getRows(), rhs.getCols());
-    // multiply and fill res:
-    int i, j, k;
-    for (i = 0; i < this->getRows(); i++)
-    {
-        for (j = 0; j < rhs.getCols(); j++)
-        {
-            res._mat[i * this->_cols + j] = 0;
-            float sum = 0;
-            for (k = 0; k < this->getCols(); k++)
-            {
-                sum += this->_mat[i * this->_cols + k] * rhs._mat[k * rhs._cols + j];
-            }
-            res._mat[i * this->_cols + j] = sum;
-        }
-    }
-    return res;
-}
-
-/**
- * Scalar mult. On the right
- * Matrix m;
- * float c;
- * Matrix m2 = m * c;
- * @param c
- * @return updated matrix
- */
-Matrix Matrix::operator*(const float c) const
-{
-    Matrix res(*this);
-    for (int i = 0; i < this->getRows() * this->getCols(); ++i)
-    {
-        res._mat[i] = c * this->_mat[i];
-    }
-    return res;
-}
-
-
-/**
- * Scalar mult. In the left.
- * Matrix m; float c;
- * Matrix m2 = c * m
- *
- * @param c
- * @param rhs
- * @return updated matrix
- */
-Matrix operator*(float c, const Matrix &rhs)
-{
-    Matrix res(rhs.getRows(), rhs.getCols());
-    for (int i = 0; i < rhs.getRows() * rhs.getCols(); ++i)
-    {
-        res._mat[i] = c * rhs._mat[i];
-    }
-    return res;
-}
-
-
-/**
- *  Matrix multiplication.
- *  Matrix a,b;
- *  a*=b;
- *  it is equivalent to  a= a*b
- * Check dimensions valid for operation
- * @param rhs
- * @return updated matrix
- */
-Matrix &Matrix::operator*=(const Matrix &rhs)
-{
-    *this = *this * rhs;
-    return *this;
-}
-
-
-/**
- * Scalar mult.accumulation.
- * Matrix a; float c;
- * a*=c
- * (note to self:  it is equivalent to a= a*c)
- * @param c
- * @return updated matrix
- */
-Matrix &Matrix::operator*=(float c)
-{
-    Matrix res(this->getRows(), this->getCols());
-    for (int i = 0; i < this->getRows() * this->getCols(); ++i)
-    {
-        this->_mat[i] = c * this->_mat[i];
-    }
-    return *this;
-}
-
-
-/**
- * Scalar division on the right
- * Matrix a; float c;
- * Matrix b = a / c;
- * check to scalar is not 0
- * @param c
- * @return updated matrix
- */
-Matrix Matrix::operator/(float c)
-{
-
-    if (c == 0)
-    {
-        std::cerr << DEVISION_BY_ZERO;
-        exit(EXIT_FAILURE);
-    }
-
-    Matrix res(this->getRows(), this->getCols());
-    for (int i = 0; i < this->getRows() * this->getCols(); ++i)
-    {
-        res._mat[i] = this->_mat[i] / c;
-    }
-    return res;
-}
-
-/**
- * Scalar division
- * Matrix a;
- * float c;
- * a /= c;
- * ** check to scalar is not 0.
- * (note to self:  it is equivalent to a= a/c)
- * @param c
- * @return updated matrix
- */
-Matrix &Matrix::operator/=(float c)
-{
-    if (c == 0)
-    {
-        std::cerr << DEVISION_BY_ZERO;
-        exit(EXIT_FAILURE);
-    }
-
-    for (int i = 0; i < this->getRows() * this->getCols(); ++i)
-    {
-        this->_mat[i] = this->_mat[i] / c;
-    }
-    return *this;
-}
-
-/**
- * Matrix addition
- * Matrix a, b;
- * Matrix c = a + b;
- * Check dimensions valid for operation.
- * @param rhs
- * @return updated matrix
- */
-Matrix Matrix::operator+(const Matrix &rhs) const
-{
-
-    if (this->getCols() != rhs.getCols() || this->getRows() != rhs.getRows())
-    {
-        std::cerr << INVALID_MAT_DIMENSIONS;
-        exit(EXIT_FAILURE);
-    }
-    // mats are the same dimensions, so we can add them!
-    Matrix res(this->getRows(), this->getCols());
-    for (int i = 0; i < this->getRows() * this->getCols(); ++i)
-    {
-        res._mat[i] = this->_mat[i] + rhs._mat[i];
-    }
-    return res;
-
-}
-
-/**
- * Matrix addition accumulation
- * Matrix a, b;
- * a += b;
- * Check dimensions valid for operation.
- * (note to self:  it is equivalent to a= a+b)
- * @param c
- * @return updated matrix
- */
-Matrix &Matrix::operator+=(const Matrix &rhs)
-{
-    *this = *this + rhs;
-    return *this;
-}
-
-/**
- * Matrix scalar addition.
- * Matrix a; float c;
- * a += c;
- * (note to self:  it is equivalent to a= a+c)
- * @param c
- * @return updated matrix
- */
-Matrix &Matrix::operator+=(float c)
-{
-    for (int i = 0; i < this->getRows() * this->getCols(); ++i)
-    {
-        this->_mat[i] = this->_mat[i] + c;
-    }
-    return *this;
-}
-
-/**
- * Parenthesis indexing
- *int i, j; Matrix m;
- * float val = m(i, j);
- * m(i,j) = 5.6;
- * check the indexes are in the right range
- *
- * Check indexes are in valid ranges.
-
- * @param i
- * @param j
- * @return float object for the given index
- */
-float Matrix::operator()(int i, int j) const
-{
-    if (i < 0 || j < 0 || i > (this->getRows() - 1) || (j > this->getCols() - 1))
-    {
-        std::cerr << IDX_OUT_OF_RANGE;
-        exit(EXIT_FAILURE);
-    }
-    return this->_mat[i * this->_cols + j];
-}
-
-/**
- * Parenthesis indexing
- *int i, j; Matrix m;
- * float val = m(i, j);
- * m(i,j) = 5.6;
- * check the indexes are in the right range
- *
- * Check indexes are in valid ranges.
-
- * @param i
- * @param j
- * @return float ref object for the given index
- */
-float &Matrix::operator()(int i, int j)
-{
-    if (i < 0 || j < 0 || i > (this->getRows() - 1) || (j > this->getCols() - 1))
-    {
-        std::cerr << IDX_OUT_OF_RANGE;
-        exit(EXIT_FAILURE);
-    }
-    return this->_mat[i * this->_cols + j];
-}
-
-
-/**
- * Brackets indexing
- * int i; Matrix m;
- * float val = m[i];
- * m[k] = 6.7;
- * read section 2.1.2
- *Check index is in valid range.
- * @param i
- * @return float object for the given index
- */
-float Matrix::operator[](int i) const
-{
-    if (i < 0 || i > (this->getRows() * this->getCols() - 1))
-    {
-        std::cerr << IDX_OUT_OF_RANGE;
-        exit(EXIT_FAILURE);
-    }
-    return this->_mat[i];
-}
-
-
-/**
- * Brackets indexing
- * int i; Matrix m;
- * float val = m[i];
- * m[k] = 6.7;
- * read section 2.1.2
- *Check index is in valid range.
- * @param i
- * @return float ref object for the given index
- */
-float &Matrix::operator[](int i)
-{
-
-    if (i < 0 || i > (this->getRows() * this->getCols() - 1))
-    {
-        std::cerr << IDX_OUT_OF_RANGE;
-        exit(EXIT_FAILURE);
-    }
-    return this->_mat[i];
-}
-
-/**
- * Equality
- * Matrix a, b;
- * bool t = (a == b);
- * @param rhs
- * @return true if matrices have the save values, false otherwise
- */
-bool Matrix::operator==(const Matrix &rhs) const
-{
-    //check dimensions
-    if (this->getCols() != rhs.getCols() || this->getRows() != rhs.getRows())
-    {
-        return false;
-    }
-    // check matrix vals one by one
-    for (int i = 0; i < this->getRows() * this->getCols(); ++i)
-    {
-        if (this->_mat[i] != rhs._mat[i])
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
-/**
- * Not equal
- * Matrix a, b;
- * bool t = (a != b);
- * @param rhs
- * @return true if mat are different, false otherwise
- */
-bool Matrix::operator!=(const Matrix &rhs) const
-{
-    if (this->getCols() != rhs.getCols() || this->getRows() != rhs.getRows())
-    {
-        return true;
-    }
-    // check matrix vals one by one
-    for (int i = 0; i < this->getRows() * this->getCols(); ++i)
-    {
-        if (this->_mat[i] != rhs._mat[i])
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
-/**
- * Input stream
- * Check input stream validity.
- * Fills matrix elements. Reads from given input stream.
- * I.E:
- * ifstream is;
- * Matrix m(3, 5);
- * is >> m;
- * I.E:
- * The input is: 1 2 3 4 5 6
- * Is >> m;
- * m is [1 2 3]
- * [4 5 6]
- * @param rhs
- * @return updated input stream
- */
-std::istream &operator>>(std::istream &input, Matrix &rhs)
-{
-    // check what's the col and what's the row and update rhs!!!!
-    if (!input.good())
-    {
-        std::cerr << INPUT_STREAM_INVALID;
-        exit(EXIT_FAILURE);
-    }
-    for (int i = 0; i < rhs.getCols() * rhs.getRows(); ++i)
-    {
-        input >> rhs[i];
-    }
-    return input;
-}
-
-/**
- * Output stream
- * Matrix m;
- * std::cout << m << std::endl;
- * OR
- * file << m;
- * @param rhs
- * @return updated output stream
- */
-std::ostream &operator<<(std::ostream &os, const Matrix &rhs)
-{
-    for (int i = 0; i < rhs._rows; i++)
-    {
-        for (int j = 0; j < rhs._cols; j++)
-        {
-            if (j != rhs._cols - 1)
-            {
-                os << rhs._mat[i * rhs._cols + j] << " ";
-            }
-            else
-            {
-                os << rhs._mat[i * rhs._cols + j];
-            }
-        }
-        if (i != rhs._rows - 1)
-        {
-            os << "\n";
-        }
-    }
-    return os;
-
-}
+
+// ------------------------------ includes ------------------------------
+#include "Matrix.h"
+#include "MatrixIO.h"
+#include "MatrixKernels.h"
+#include "BufferPool.h"
+#include <vector>
+#include<iostream>
+// ------------------------------ helpers -----------------------------
+
+/**
+ * runs a multiply-accumulate kernel into a new rows x cols matrix of E.
+ * floating point elements accumulate straight into the (zeroed) result; 8 bit elements accumulate
+ * in a ScalarType buffer that is saturated once per element at the end.
+ * @param rows
+ * @param cols
+ * @param kernel called as kernel(accumulator, leading dimension)
+ * @return the result matrix
+ */
+template<typename E, typename Kernel>
+static BasicMatrix<E> accumulateInto(int rows, int cols, Kernel kernel)
+{
+    typedef typename BasicMatrix<E>::ScalarType ScalarType;
+    BasicMatrix<E> res(rows, cols);
+    E *resData = res.data();
+    if (std::is_same<E, ScalarType>::value)
+    {
+        kernel(reinterpret_cast<ScalarType *>(resData), cols);
+    }
+    else
+    {
+        std::vector<ScalarType> acc(static_cast<size_t>(rows) * cols, 0);
+        kernel(acc.data(), cols);
+        for (size_t i = 0; i < acc.size(); ++i)
+        {
+            resData[i] = saturateCast<E>(acc[i]);
+        }
+    }
+    return res;
+}
+
+// ------------------------------ functions -----------------------------
+/**
+ * Constructor
+ * Constructs matrix rows * cols (need to make sure rows,cols are non negative).
+ * Initiates all elements to 0 (unless init is MatrixInit::Uninitialized).
+ * @param rows
+ * @param cols
+ * @param init
+ */
+template<typename T>
+BasicMatrix<T>::BasicMatrix(int rows, int cols, MatrixInit init) : _rows(rows), _cols(cols)
+{
+    if (_rows < 0 || _cols < 0)
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    _mat = static_cast<T *>(bufferPoolAllocate(static_cast<size_t>(_rows) * _cols * sizeof(T)));
+    if (init == MatrixInit::Zero)
+    {
+        std::fill(_mat, _mat + static_cast<long>(_rows) * _cols, T(0));
+    }
+}
+
+/**
+ * copy constructor
+ * Constructs matrix from another matrix
+ * @param m
+ */
+template<typename T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix &m) : BasicMatrix(m._rows, m._cols, MatrixInit::Uninitialized)
+{
+    std::copy(m._mat, m._mat + static_cast<long>(m._rows) * m._cols, this->_mat);
+}
+
+/**
+ * move constructor
+ * takes over the storage of m, m is left empty (0 * 0)
+ * @param m
+ */
+template<typename T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix &&m) noexcept : _rows(m._rows), _cols(m._cols), _mat(m._mat)
+{
+    m._rows = 0;
+    m._cols = 0;
+    m._mat = nullptr;
+}
+
+/**
+ * Constructs matrix from a view (copies the viewed elements)
+ * @param v
+ */
+template<typename T>
+BasicMatrix<T>::BasicMatrix(const ConstView &v) : BasicMatrix(v.getRows(), v.getCols(), MatrixInit::Uninitialized)
+{
+    this->view().copyFrom(v);
+}
+
+/**
+ * Default constructor
+ * Constructs 1*1 matrix, where the single element is initiated to 0
+ */
+template<typename T>
+BasicMatrix<T>::BasicMatrix() : BasicMatrix(DEFAULD_ROWS, DEFAULT_COLS)
+{
+
+}
+
+/**
+ * Destructor
+ * Destroys the matrix
+ */
+template<typename T>
+BasicMatrix<T>::~BasicMatrix()
+{
+    bufferPoolRelease(this->_mat, static_cast<size_t>(this->_rows) * this->_cols * sizeof(T));
+    this->_mat = nullptr;
+}
+
+/**
+ * Returns the amount of rows (int).
+ * @return
+ */
+template<typename T>
+int BasicMatrix<T>::getRows() const
+{
+    return this->_rows;
+}
+
+/**
+ * Returns the amount of columns (int).
+ * @return
+ */
+template<typename T>
+int BasicMatrix<T>::getCols() const
+{
+    return this->_cols;
+}
+
+/**
+ * view over the whole matrix, no copy is made
+ * @return
+ */
+template<typename T>
+typename BasicMatrix<T>::View BasicMatrix<T>::view()
+{
+    return View(this->_mat, this->_rows, this->_cols);
+}
+
+/**
+ * read only view over the whole matrix, no copy is made
+ * @return
+ */
+template<typename T>
+typename BasicMatrix<T>::ConstView BasicMatrix<T>::view() const
+{
+    return ConstView(this->_mat, this->_rows, this->_cols);
+}
+
+/**
+ * view over the sub block starting at (row, col), no copy is made.
+ * Check the block is inside the matrix.
+ * @param row
+ * @param col
+ * @param rows
+ * @param cols
+ * @return
+ */
+template<typename T>
+typename BasicMatrix<T>::View BasicMatrix<T>::block(int row, int col, int rows, int cols)
+{
+    return this->view().block(row, col, rows, cols);
+}
+
+/**
+ * read only view over the sub block starting at (row, col), no copy is made.
+ * Check the block is inside the matrix.
+ * @param row
+ * @param col
+ * @param rows
+ * @param cols
+ * @return
+ */
+template<typename T>
+typename BasicMatrix<T>::ConstView BasicMatrix<T>::block(int row, int col, int rows, int cols) const
+{
+    return this->view().block(row, col, rows, cols);
+}
+
+/**
+ * a matrix can be passed wherever a read only view is expected
+ * @return
+ */
+template<typename T>
+BasicMatrix<T>::operator ConstView() const
+{
+    return this->view();
+}
+
+/**
+ * Transforms a matrix into a column vector.
+ *  Supports function calling. I.E:
+ *  Matrix m(5,4);
+ *  m.vectorize();
+ *  int r = m.getRows(); // suppose to return 20
+ *  int c = m.getCols(); // suppose to return 1
+    [ 1, 2, 3]
+    [ 4, 5, 6] ⇒ transpose ( [1, 2, 3, 4, 5, 6, 7, 8, 9] )
+    [ 7, 8, 9]
+ *
+ * @return
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::vectorize()
+{
+    // initailize new mat
+    // a column of more than INT_MAX rows can not be represented
+    long size = static_cast<long>(getRows()) * getCols();
+    if (size > std::numeric_limits<int>::max())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    this->_rows = static_cast<int>(size);
+    this->_cols = 1;
+    return *this;
+}
+
+
+/**
+ * Transpose
+ * Matrix m(2, 3);
+ * Matrix t = m.transpose();  // 3 x 2, t(j, i) == m(i, j)
+ * cache oblivious blocked copy.
+ * @return new matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::transpose() const
+{
+    BasicMatrix res(this->_cols, this->_rows, MatrixInit::Uninitialized);
+    transposeKernel(this->_rows, this->_cols, this->_mat, this->_cols, res._mat, res._cols);
+    return res;
+}
+
+/**
+ * In place transpose of a square matrix, no memory is allocated.
+ * Check the matrix is square.
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::transposeInPlace()
+{
+    if (this->_rows != this->_cols)
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    transposeSquareInPlace(this->_rows, this->_mat, this->_cols);
+    return *this;
+}
+
+/**
+ * Transposed-operand multiplication: this^T * rhs, without materializing the transpose.
+ * Check dimensions valid for operation (this->getRows() == rhs.getRows()).
+ * @param rhs
+ * @return new matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::mul_tn(const ConstView &rhs) const
+{
+    if (this->_rows != rhs.getRows())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    return accumulateInto<T>(this->_cols, rhs.getCols(), [&](ScalarType *acc, int ldc)
+    {
+        gemmTNAccumulate(this->_cols, rhs.getCols(), this->_rows, static_cast<const T *>(this->_mat), this->_cols,
+                         rhs.data(), rhs.getStride(), acc, ldc);
+    });
+}
+
+/**
+ * Transposed-operand multiplication: this * rhs^T, without materializing the transpose.
+ * Check dimensions valid for operation (this->getCols() == rhs.getCols()).
+ * @param rhs
+ * @return new matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::mul_nt(const ConstView &rhs) const
+{
+    if (this->_cols != rhs.getCols())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    return accumulateInto<T>(this->_rows, rhs.getRows(), [&](ScalarType *acc, int ldc)
+    {
+        gemmNTAccumulate(this->_rows, rhs.getRows(), this->_cols, static_cast<const T *>(this->_mat), this->_cols,
+                         rhs.data(), rhs.getStride(), acc, ldc);
+    });
+}
+
+/**
+ * Prints matrix elements, no return value (void).
+ * Prints space after each element (not including the last element in the row).
+ * Prints new line after each row (not including the last row)
+ */
+template<typename T>
+void BasicMatrix<T>::print() const
+{
+    std::cout << *this;
+}
+
+/**
+ * assignment
+ * Matrix a, b;
+ * a = b;
+ * @param rhs
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const BasicMatrix &rhs)
+{
+    if (this == &rhs)
+    {
+        return *this;
+    }
+    long count = static_cast<long>(rhs._rows) * rhs._cols;
+    if (count != static_cast<long>(this->_rows) * this->_cols)
+    {
+        // allocate first, so a failed allocation leaves this matrix untouched
+        T *mat = static_cast<T *>(bufferPoolAllocate(count * sizeof(T)));
+        bufferPoolRelease(this->_mat, static_cast<size_t>(this->_rows) * this->_cols * sizeof(T));
+        this->_mat = mat;
+    }
+    std::copy(rhs._mat, rhs._mat + count, this->_mat);
+    this->_rows = rhs.getRows();
+    this->_cols = rhs.getCols();
+    return *this;
+}
+
+/**
+ * move assignment
+ * swaps storage with rhs, whose old storage is released with rhs
+ * @param rhs
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(BasicMatrix &&rhs) noexcept
+{
+    std::swap(this->_rows, rhs._rows);
+    std::swap(this->_cols, rhs._cols);
+    std::swap(this->_mat, rhs._mat);
+    return *this;
+}
+
+
+/**
+ * Matrix multiplication
+ * Matrix a, b;
+ * Matrix c = a * b
+ * ** do not forget algebra rules for matrix multiplication.
+ * Check dimensions valid for operation.
+ * sums are accumulated in ScalarType and saturated once per result element.
+ * @param rhs
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix &rhs) const
+{
+    return this->view() * rhs.view();
+}
+
+/**
+ * Matrix multiplication by a view
+ * Check dimensions valid for operation.
+ * @param rhs
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const ConstView &rhs) const
+{
+    return this->view() * rhs;
+}
+
+/**
+ * Scalar mult. On the right
+ * Matrix m;
+ * float c;
+ * Matrix m2 = m * c;
+ * @param c
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const ScalarType c) const
+{
+    BasicMatrix res(*this);
+    const long size = static_cast<long>(this->getRows()) * this->getCols();
+    for (long i = 0; i < size; ++i)
+    {
+        res._mat[i] = saturateCast<T>(c * this->_mat[i]);
+    }
+    return res;
+}
+
+
+/**
+ *  Matrix multiplication.
+ *  Matrix a,b;
+ *  a*=b;
+ *  it is equivalent to  a= a*b
+ * Check dimensions valid for operation
+ * @param rhs
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator*=(const BasicMatrix &rhs)
+{
+    *this = *this * rhs;
+    return *this;
+}
+
+
+/**
+ * Scalar mult.accumulation.
+ * Matrix a; float c;
+ * a*=c
+ * (note to self:  it is equivalent to a= a*c)
+ * @param c
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator*=(ScalarType c)
+{
+    const long size = static_cast<long>(this->getRows()) * this->getCols();
+    for (long i = 0; i < size; ++i)
+    {
+        this->_mat[i] = saturateCast<T>(c * this->_mat[i]);
+    }
+    return *this;
+}
+
+
+/**
+ * Scalar division on the right
+ * Matrix a; float c;
+ * Matrix b = a / c;
+ * check to scalar is not 0
+ * @param c
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator/(ScalarType c)
+{
+
+    if (c == 0)
+    {
+        matrixError<std::domain_error>(DEVISION_BY_ZERO);
+    }
+
+    BasicMatrix res(this->getRows(), this->getCols(), MatrixInit::Uninitialized);
+    const long size = static_cast<long>(this->getRows()) * this->getCols();
+    for (long i = 0; i < size; ++i)
+    {
+        res._mat[i] = saturateCast<T>(this->_mat[i] / c);
+    }
+    return res;
+}
+
+/**
+ * Scalar division
+ * Matrix a;
+ * float c;
+ * a /= c;
+ * ** check to scalar is not 0.
+ * (note to self:  it is equivalent to a= a/c)
+ * @param c
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator/=(ScalarType c)
+{
+    if (c == 0)
+    {
+        matrixError<std::domain_error>(DEVISION_BY_ZERO);
+    }
+
+    const long size = static_cast<long>(this->getRows()) * this->getCols();
+    for (long i = 0; i < size; ++i)
+    {
+        this->_mat[i] = saturateCast<T>(this->_mat[i] / c);
+    }
+    return *this;
+}
+
+/**
+ * Matrix addition
+ * Matrix a, b;
+ * Matrix c = a + b;
+ * Check dimensions valid for operation.
+ * @param rhs
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const BasicMatrix &rhs) const
+{
+    return this->view() + rhs.view();
+}
+
+/**
+ * Matrix addition of a view
+ * Check dimensions valid for operation.
+ * @param rhs
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const ConstView &rhs) const
+{
+    return this->view() + rhs;
+}
+
+/**
+ * Matrix addition accumulation
+ * Matrix a, b;
+ * a += b;
+ * Check dimensions valid for operation.
+ * (note to self:  it is equivalent to a= a+b)
+ * @param c
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(const BasicMatrix &rhs)
+{
+    *this = *this + rhs;
+    return *this;
+}
+
+/**
+ * Matrix scalar addition.
+ * Matrix a; float c;
+ * a += c;
+ * (note to self:  it is equivalent to a= a+c)
+ * @param c
+ * @return updated matrix
+ */
+template<typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(ScalarType c)
+{
+    const long size = static_cast<long>(this->getRows()) * this->getCols();
+    for (long i = 0; i < size; ++i)
+    {
+        this->_mat[i] = saturateCast<T>(this->_mat[i] + c);
+    }
+    return *this;
+}
+
+/**
+ * Parenthesis indexing
+ *int i, j; Matrix m;
+ * float val = m(i, j);
+ * m(i,j) = 5.6;
+ * check the indexes are in the right range
+ *
+ * Check indexes are in valid ranges.
+
+ * @param i
+ * @param j
+ * @return float object for the given index
+ */
+template<typename T>
+T BasicMatrix<T>::operator()(int i, int j) const
+{
+    if (i < 0 || j < 0 || i > (this->getRows() - 1) || (j > this->getCols() - 1))
+    {
+        matrixError<std::out_of_range>(IDX_OUT_OF_RANGE);
+    }
+    return this->_mat[static_cast<long>(i) * this->_cols + j];
+}
+
+/**
+ * Parenthesis indexing
+ *int i, j; Matrix m;
+ * float val = m(i, j);
+ * m(i,j) = 5.6;
+ * check the indexes are in the right range
+ *
+ * Check indexes are in valid ranges.
+
+ * @param i
+ * @param j
+ * @return float ref object for the given index
+ */
+template<typename T>
+T &BasicMatrix<T>::operator()(int i, int j)
+{
+    if (i < 0 || j < 0 || i > (this->getRows() - 1) || (j > this->getCols() - 1))
+    {
+        matrixError<std::out_of_range>(IDX_OUT_OF_RANGE);
+    }
+    return this->_mat[static_cast<long>(i) * this->_cols + j];
+}
+
+
+/**
+ * Brackets indexing
+ * int i; Matrix m;
+ * float val = m[i];
+ * m[k] = 6.7;
+ * read section 2.1.2
+ *Check index is in valid range.
+ * @param i
+ * @return float object for the given index
+ */
+template<typename T>
+T BasicMatrix<T>::operator[](int i) const
+{
+    if (i < 0 || i >= static_cast<long>(this->getRows()) * this->getCols())
+    {
+        matrixError<std::out_of_range>(IDX_OUT_OF_RANGE);
+    }
+    return this->_mat[i];
+}
+
+
+/**
+ * Brackets indexing
+ * int i; Matrix m;
+ * float val = m[i];
+ * m[k] = 6.7;
+ * read section 2.1.2
+ *Check index is in valid range.
+ * @param i
+ * @return float ref object for the given index
+ */
+template<typename T>
+T &BasicMatrix<T>::operator[](int i)
+{
+
+    if (i < 0 || i >= static_cast<long>(this->getRows()) * this->getCols())
+    {
+        matrixError<std::out_of_range>(IDX_OUT_OF_RANGE);
+    }
+    return this->_mat[i];
+}
+
+/**
+ * Equality
+ * Matrix a, b;
+ * bool t = (a == b);
+ * @param rhs
+ * @return true if matrices have the save values, false otherwise
+ */
+template<typename T>
+bool BasicMatrix<T>::operator==(const BasicMatrix &rhs) const
+{
+    return this->view() == rhs.view();
+}
+
+/**
+ * Equality with a view
+ * @param rhs
+ * @return true if matrix and view have the save values, false otherwise
+ */
+template<typename T>
+bool BasicMatrix<T>::operator==(const ConstView &rhs) const
+{
+    return this->view() == rhs;
+}
+
+/**
+ * Not equal
+ * Matrix a, b;
+ * bool t = (a != b);
+ * @param rhs
+ * @return true if mat are different, false otherwise
+ */
+template<typename T>
+bool BasicMatrix<T>::operator!=(const BasicMatrix &rhs) const
+{
+    return this->view() != rhs.view();
+}
+
+/**
+ * Not equal to a view
+ * @param rhs
+ * @return true if matrix and view are different, false otherwise
+ */
+template<typename T>
+bool BasicMatrix<T>::operator!=(const ConstView &rhs) const
+{
+    return this->view() != rhs;
+}
+
+/**
+ * Input stream
+ * Check input stream validity.
+ * Fills matrix elements. Reads from given input stream.
+ * I.E:
+ * ifstream is;
+ * Matrix m(3, 5);
+ * is >> m;
+ * I.E:
+ * The input is: 1 2 3 4 5 6
+ * Is >> m;
+ * m is [1 2 3]
+ * [4 5 6]
+ * values are read as numbers (not chars) and saturated into the element type.
+ * throws std::runtime_error if the stream runs out or holds a non number (rhs may then be
+ * partially filled).
+ * @param rhs
+ * @return updated input stream
+ */
+template<typename T>
+std::istream &operator>>(std::istream &input, BasicMatrix<T> &rhs)
+{
+    // check what's the col and what's the row and update rhs!!!!
+    if (!input.good())
+    {
+        matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+    }
+    typename BasicMatrix<T>::ScalarType val;
+    for (int i = 0; i < rhs.getCols() * rhs.getRows(); ++i)
+    {
+        if (!(input >> val))
+        {
+            matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+        }
+        rhs._mat[i] = saturateCast<T>(val);
+    }
+    return input;
+}
+
+/**
+ * Output stream
+ * Matrix m;
+ * std::cout << m << std::endl;
+ * OR
+ * file << m;
+ * elements are written as numbers, so 8 bit matrices do not print as chars.
+ * @param rhs
+ * @return updated output stream
+ */
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicMatrix<T> &rhs)
+{
+    return os << rhs.view();
+}
+
+// ------------------------------ views -----------------------------
+
+/**
+ * Matrix multiplication
+ * Check dimensions valid for operation.
+ * runs the cache blocked kernel (gemmAccumulate), or the matrix-vector kernel (gemvAccumulate)
+ * when rhs is a single column; sums are accumulated in ScalarType and saturated once per result
+ * element.
+ * @param rhs
+ * @return new matrix
+ */
+template<typename T>
+BasicMatrix<typename BasicMatrixView<T>::ElementType> BasicMatrixView<T>::operator*(const ConstView &rhs) const
+{
+    typedef typename BasicMatrix<ElementType>::ScalarType ScalarType;
+    if (this->getCols() != rhs.getRows())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    // can multiply matrix!!
+    const BasicMatrixView &lhs = *this;
+    if (rhs.getCols() == 1)
+    {
+        return accumulateInto<ElementType>(this->getRows(), 1, [&](ScalarType *acc, int)
+        {
+            gemvAccumulate(lhs.getRows(), lhs.getCols(), lhs.data(), lhs.getStride(), rhs.data(), rhs.getStride(),
+                           acc);
+        });
+    }
+    return accumulateInto<ElementType>(this->getRows(), rhs.getCols(), [&](ScalarType *acc, int ldc)
+    {
+        gemmAccumulate(lhs.getRows(), rhs.getCols(), lhs.getCols(), lhs.data(), lhs.getStride(),
+                       rhs.data(), rhs.getStride(), acc, ldc);
+    });
+}
+
+/**
+ * Scalar mult. On the right
+ * @param c
+ * @return new matrix
+ */
+template<typename T>
+BasicMatrix<typename BasicMatrixView<T>::ElementType>
+BasicMatrixView<T>::operator*(typename MatrixElementTraits<ElementType>::AccumType c) const
+{
+    BasicMatrix<ElementType> res(*this);
+    return res *= c;
+}
+
+/**
+ * Matrix addition
+ * Check dimensions valid for operation.
+ * @param rhs
+ * @return new matrix
+ */
+template<typename T>
+BasicMatrix<typename BasicMatrixView<T>::ElementType> BasicMatrixView<T>::operator+(const ConstView &rhs) const
+{
+    typedef typename BasicMatrix<ElementType>::ScalarType ScalarType;
+    if (this->getCols() != rhs.getCols() || this->getRows() != rhs.getRows())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    // mats are the same dimensions, so we can add them!
+    BasicMatrix<ElementType> res(this->getRows(), this->getCols(), MatrixInit::Uninitialized);
+    for (int i = 0; i < this->getRows(); ++i)
+    {
+        const T *lhsRow = this->data() + static_cast<long>(i) * this->getStride();
+        const ElementType *rhsRow = rhs.data() + static_cast<long>(i) * rhs.getStride();
+        ElementType *resRow = res.row_ptr(i);
+        for (int j = 0; j < this->getCols(); ++j)
+        {
+            resRow[j] = saturateCast<ElementType>(static_cast<ScalarType>(lhsRow[j]) + rhsRow[j]);
+        }
+    }
+    return res;
+}
+
+/**
+ * Equality
+ * @param rhs
+ * @return true if views have the same dimensions and values
+ */
+template<typename T>
+bool BasicMatrixView<T>::operator==(const ConstView &rhs) const
+{
+    //check dimensions
+    if (this->getCols() != rhs.getCols() || this->getRows() != rhs.getRows())
+    {
+        return false;
+    }
+    // check matrix vals one by one
+    for (int i = 0; i < this->getRows(); ++i)
+    {
+        const T *lhsRow = this->data() + static_cast<long>(i) * this->getStride();
+        const ElementType *rhsRow = rhs.data() + static_cast<long>(i) * rhs.getStride();
+        for (int j = 0; j < this->getCols(); ++j)
+        {
+            if (lhsRow[j] != rhsRow[j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Not equal
+ * @param rhs
+ * @return true if views differ
+ */
+template<typename T>
+bool BasicMatrixView<T>::operator!=(const ConstView &rhs) const
+{
+    return !(*this == rhs);
+}
+
+/**
+ * Output stream, same format as Matrix
+ * with default stream formatting this is writeText (buffered to_chars), otherwise the
+ * elements go through the stream's own formatting.
+ * elements are written as numbers, so 8 bit matrices do not print as chars.
+ * @param rhs
+ * @return updated output stream
+ */
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicMatrixView<T> &rhs)
+{
+    const std::ios_base::fmtflags custom = std::ios_base::floatfield | std::ios_base::showpos |
+                                          std::ios_base::showpoint | std::ios_base::uppercase;
+    if (!(os.flags() & custom) && os.width() == 0 && os.getloc() == std::locale::classic())
+    {
+        // default formatting - take the buffered to_chars path
+        writeText(os, typename BasicMatrixView<T>::ConstView(rhs));
+        return os;
+    }
+    typedef typename MatrixElementTraits<typename BasicMatrixView<T>::ElementType>::AccumType ScalarType;
+    for (int i = 0; i < rhs.getRows(); i++)
+    {
+        const T *row = rhs.data() + static_cast<long>(i) * rhs.getStride();
+        for (int j = 0; j < rhs.getCols(); j++)
+        {
+            if (j != rhs.getCols() - 1)
+            {
+                os << static_cast<ScalarType>(row[j]) << " ";
+            }
+            else
+            {
+                os << static_cast<ScalarType>(row[j]);
+            }
+        }
+        if (i != rhs.getRows() - 1)
+        {
+            os << "\n";
+        }
+    }
+    return os;
+}
+
+// ------------------------------ instantiations -----------------------------
+
+template class BasicMatrix<float>;
+template std::istream &operator>>(std::istream &input, BasicMatrix<float> &rhs);
+template std::ostream &operator<<(std::ostream &os, const BasicMatrix<float> &rhs);
+template class BasicMatrixView<float>;
+template class BasicMatrixView<const float>;
+template std::ostream &operator<<(std::ostream &os, const BasicMatrixView<float> &rhs);
+template std::ostream &operator<<(std::ostream &os, const BasicMatrixView<const float> &rhs);
+
+template class BasicMatrix<double>;
+template std::istream &operator>>(std::istream &input, BasicMatrix<double> &rhs);
+template std::ostream &operator<<(std::ostream &os, const BasicMatrix<double> &rhs);
+template class BasicMatrixView<double>;
+template class BasicMatrixView<const double>;
+template std::ostream &operator<<(std::ostream &os, const BasicMatrixView<double> &rhs);
+template std::ostream &operator<<(std::ostream &os, const BasicMatrixView<const double> &rhs);
+
+template class BasicMatrix<uint8_t>;
+template std::istream &operator>>(std::istream &input, BasicMatrix<uint8_t> &rhs);
+template std::ostream &operator<<(std::ostream &os, const BasicMatrix<uint8_t> &rhs);
+template class BasicMatrixView<uint8_t>;
+template class BasicMatrixView<const uint8_t>;
+template std::ostream &operator<<(std::ostream &os, const BasicMatrixView<uint8_t> &rhs);
+template std::ostream &operator<<(std::ostream &os, const BasicMatrixView<const uint8_t> &rhs);
+
+template class BasicMatrix<int8_t>;
+template std::istream &operator>>(std::istream &input, BasicMatrix<int8_t> &rhs);
+template std::ostream &operator<<(std::ostream &os, const BasicMatrix<int8_t> &rhs);
+template class BasicMatrixView<int8_t>;
+template class BasicMatrixView<const int8_t>;
+template std::ostream &operator<<(std::ostream &os, const BasicMatrixView<int8_t> &rhs);
+template std::ostream &operator<<(std::ostream &os, const BasicMatrixView<const int8_t> &rhs);
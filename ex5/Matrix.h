@@ -1,335 +1,779 @@
-
-
-#ifndef EX5_MATRIX_H
-
-// ------------------------------ includes ------------------------------
-
-#include <iostream>
-#include <fstream>      // std::ifstream
-#include <cmath>
-
-// ------------------------------ const & macros -----------------------------
-
-#define EX5_MATRIX_H
-/**
- * default val rows
- */
-#define DEFAULD_ROWS 1
-/**
- * default val cols
- */
-#define DEFAULT_COLS 1
-/**
- * invalid matrix dimensions
- */
-#define INVALID_MAT_DIMENSIONS "Invalid matrix dimensions.\n"
-/**
- * error - dividing by 0
- */
-#define DEVISION_BY_ZERO "Divesion by zero.\n"
-/**
- * index out of range
- */
-#define IDX_OUT_OF_RANGE "Index out of range.\n"
-/**
- * input stream is invalid
- */
-#define INPUT_STREAM_INVALID "Error loading from input stream.\n"
-
-
-// ------------------------------ functions -----------------------------
-
-/**
- *  class which represents a matrix
- */
-class Matrix
-{
-private:
-
-    int _rows, _cols;
-    float *_mat;
-
-public:
-    /**
-     * Constructor
-     * Constructs matrix rows * cols (need to make sure rows,cols are non negative).
-     * Initiates all elements to 0.
-     * @param rows
-     * @param cols
-     */
-    Matrix(int rows, int cols);
-
-    /**
-     * Default constructor
-     * Constructs 1*1 matrix, where the single element is initiated to 0
-     */
-    Matrix();
-
-    /**
-     * copy constructor
-     * Constructs matrix from another matrix
-     * @param m
-     */
-    Matrix(const Matrix &m);
-
-    /**
-     * Destructor
-     * Destroys the matrix
-     */
-    ~Matrix();
-
-    /**
-     * Returns the amount of rows (int).
-     * @return
-     */
-    int getRows() const;
-
-    /**
-     * Returns the amount of columns (int).
-     * @return
-     */
-    int getCols() const;
-
-    /**
-     * Transforms a matrix into a column vector.
-     *  Supports function calling. I.E:
-     *  Matrix m(5,4);
-     *  m.vectorize();
-     *  int r = m.getRows(); // suppose to return 20
-     *  int c = m.getCols(); // suppose to return 1
-        [ 1, 2, 3]
-        [ 4, 5, 6] ⇒ transpose ( [1, 2, 3, 4, 5, 6, 7, 8, 9] )
-        [ 7, 8, 9]
-     *
-     * @return
-     */
-    Matrix vectorize();
-
-    /**
-     * Prints matrix elements, no return value (void).
-     * Prints space after each element (not including the last element in the row).
-     * Prints new line after each row (not including the last row)
-     */
-    void print() const;
-
-    /**
-     * assignment
-     * Matrix a, b;
-     * a = b;
-     * @param rhs
-     * @return
-     */
-    Matrix &operator=(const Matrix &rhs);
-
-    /**
-     * Matrix multiplication
-     * Matrix a, b;
-     * Matrix c = a * b
-     * ** do not forget algebra rules for matrix multiplication.
-     * Check dimensions valid for operation.
-     * @param rhs
-     * @return
-     */
-    Matrix operator*(const Matrix &rhs) const;
-
-    /**
-     * Scalar mult. On the right
-     * Matrix m;
-     * float c;
-     * Matrix m2 = m * c;
-     * @param c
-     * @return
-     */
-    Matrix operator*(float c) const;
-
-    /**
-     * Scalar mult. In the left.
-     * Matrix m; float c;
-     * Matrix m2 = c * m
-     * @param c
-     * @param rhs
-     * @return
-     */
-    friend Matrix operator*(float c, const Matrix &rhs);
-
-    /**
-     *  Matrix multiplication.
-     *  Matrix a,b;
-     *  a*=b;
-     *  it is equivalent to  a= a*b
-     * Check dimensions valid for operation
-     * @param rhs
-     * @return
-     */
-    Matrix &operator*=(const Matrix &rhs);
-
-    /**
-     * Scalar mult.accumulation.
-     * Matrix a; float c;
-     * a*=c
-     * (note to self:  it is equivalent to a= a*c)
-     * @param c
-     * @return
-     */
-    Matrix &operator*=(float c);
-
-    /**
-     * Scalar division on the right
-     * Matrix a; float c;
-     * Matrix b = a / c;
-     * check to scalar is not 0
-     * @param c
-     * @return
-     */
-    Matrix operator/(float c);
-
-    /**
-     * Scalar division
-     * Matrix a;
-     * float c;
-     * a /= c;
-     * ** check to scalar is not 0.
-     * (note to self:  it is equivalent to a= a/c)
-     * @param c
-     * @return
-     */
-    Matrix &operator/=(float c);
-
-    /**
-     * Matrix addition
-     * Matrix a, b;
-     * Matrix c = a + b;
-     * Check dimensions valid for operation.
-     * @param rhs
-     * @return
-     */
-    Matrix operator+(const Matrix &rhs) const;
-
-    /**
-     * Matrix addition accumulation
-     * Matrix a, b;
-     * a += b;
-     * Check dimensions valid for operation.
-     * (note to self:  it is equivalent to a= a+b)
-     * @param c
-     * @return
-     */
-    Matrix &operator+=(const Matrix &rhs);
-
-    /**
-     * Matrix scalar addition.
-     * Matrix a; float c;
-     * a += c;
-     * (note to self:  it is equivalent to a= a+c)
-     * @param c
-     * @return
-     */
-    Matrix &operator+=(float c);
-
-    /**
-     * Parenthesis indexing
-     *int i, j; Matrix m;
-     * float val = m(i, j);
-     * m(i,j) = 5.6;
-     * check the indexes are in the right range
-     *
-     * Check indexes are in valid ranges.
-
-     * @param i
-     * @param j
-     * @return
-     */
-    float operator()(int i, int j) const;
-
-    /**
-     * Parenthesis indexing
-     *int i, j; Matrix m;
-     * float val = m(i, j);
-     * m(i,j) = 5.6;
-     * check the indexes are in the right range
-     *
-     * Check indexes are in valid ranges.
-
-     * @param i
-     * @param j
-     * @return
-     */
-    float &operator()(int i, int j);
-
-    /**
-     * Brackets indexing
-     * int i; Matrix m;
-     * float val = m[i];
-     * m[k] = 6.7;
-     * read section 2.1.2
-     * Check index is in valid range.
-     * @param i
-     * @param j
-     * @return float with the relevant value
-     */
-    float operator[](int i) const;
-
-    /**
-     * Brackets indexing
-     * int i; Matrix m;
-     * float val = m[i];
-     * m[k] = 6.7;
-     * read section 2.1.2
-     * Check index is in valid range.
-     * @param i
-     * @param j
-     * @return ref float with the relevant value
-     */
-    float &operator[](int i);
-
-    /**
-     * Equality
-     * Matrix a, b;
-     * bool t = (a == b);
-     * @param rhs
-     * @return
-     */
-    bool operator==(const Matrix &rhs) const;
-
-    /**
-     * Not equal
-     * Matrix a, b;
-     * bool t = (a != b);
-     * @param rhs
-     * @return
-     */
-    bool operator!=(const Matrix &rhs) const;
-
-    /**
-     * Input stream
-     * Check input stream validity.
-     * Fills matrix elements. Reads from given input stream.
-     * I.E:
-     * ifstream is;
-     * Matrix m(3, 5);
-     * is >> m;
-     * I.E:
-     * The input is: 1 2 3 4 5 6
-     * Is >> m;
-     * m is [1 2 3]
-     * [4 5 6]
-     * @param rhs
-     * @return
-     */
-
-    friend std::istream &
-    operator>>(std::istream &input, Matrix &rhs);
-
-    /**
-     * Output stream
-     * Matrix m;
-     * std::cout << m << std::endl;
-     * OR
-     * file << m;
-     * @param rhs
-     * @return
-     */
-    friend std::ostream &operator<<(std::ostream &os, const Matrix &rhs);
-};
-
-#endif //EX5_MATRIX_H
+
+
+#ifndef EX5_MATRIX_H
+
+// ------------------------------ includes ------------------------------
+
+#include <iostream>
+#include <fstream>      // std::ifstream
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_MATRIX_H
+/**
+ * default val rows
+ */
+#define DEFAULD_ROWS 1
+/**
+ * default val cols
+ */
+#define DEFAULT_COLS 1
+/**
+ * invalid matrix dimensions
+ */
+#define INVALID_MAT_DIMENSIONS "Invalid matrix dimensions.\n"
+/**
+ * error - dividing by 0
+ */
+#define DEVISION_BY_ZERO "Divesion by zero.\n"
+/**
+ * index out of range
+ */
+#define IDX_OUT_OF_RANGE "Index out of range.\n"
+/**
+ * input stream is invalid
+ */
+#define INPUT_STREAM_INVALID "Error loading from input stream.\n"
+
+/**
+ * reports an invalid operation (bad dimensions, bad index, division by zero, bad input).
+ * throws Exception(msg) - one malformed request fails only that operation (checks run before any
+ * arithmetic, so operands and targets are left unchanged; stream readers may leave a partial
+ * fill), and a long running process can catch it and carry on.
+ * compiling with MATRIX_EXIT_ON_ERROR restores the original fatal behaviour (print msg to
+ * stderr and exit).
+ * @tparam Exception std exception type thrown
+ * @param msg
+ */
+template<typename Exception>
+[[noreturn]] inline void matrixError(const char *msg)
+{
+#ifdef MATRIX_EXIT_ON_ERROR
+    std::cerr << msg;
+    exit(EXIT_FAILURE);
+#else
+    throw Exception(msg);
+#endif
+}
+
+/**
+ * MATRIX_DEBUG_CHECKS - when 1, the unchecked fast path accessors (data / row_ptr / unchecked /
+ * iterators) validate their arguments as well. defaults to on in debug builds and compiles away
+ * when NDEBUG is defined (release builds). can be forced either way with -DMATRIX_DEBUG_CHECKS=0/1
+ */
+#ifndef MATRIX_DEBUG_CHECKS
+#ifdef NDEBUG
+#define MATRIX_DEBUG_CHECKS 0
+#else
+#define MATRIX_DEBUG_CHECKS 1
+#endif
+#endif
+
+/**
+ * debug only check used by the unchecked accessors
+ */
+#if MATRIX_DEBUG_CHECKS
+#define MATRIX_DEBUG_CHECK(cond, msg) do { if (!(cond)) { matrixError<std::out_of_range>(msg); } } while (0)
+#else
+#define MATRIX_DEBUG_CHECK(cond, msg) ((void) 0)
+#endif
+
+
+// ------------------------------ element traits -----------------------------
+
+/**
+ * per element type information.
+ * AccumType is the type every arithmetic operation is carried out in before the result is
+ * stored back - 8 bit images accumulate in float so convolution sums do not overflow.
+ * @tparam T element type
+ */
+template<typename T>
+struct MatrixElementTraits
+{
+    typedef float AccumType;
+};
+
+/**
+ * double matrices keep the full double precision when accumulating
+ */
+template<>
+struct MatrixElementTraits<double>
+{
+    typedef double AccumType;
+};
+
+/**
+ * converts an accumulated value back to the element type.
+ * integer element types are rounded to the nearest integer and saturated to the type's range
+ * (i.e 300 -> 255, -4 -> 0 for uint8_t), floating point types are a plain conversion.
+ * @tparam T element type
+ * @tparam A accumulated value type
+ * @param val
+ * @return val as T
+ */
+template<typename T, typename A>
+inline T saturateCast(A val)
+{
+    if (std::is_floating_point<T>::value)
+    {
+        return static_cast<T>(val);
+    }
+    A rounded = std::rint(val);
+    if (!(rounded > static_cast<A>(std::numeric_limits<T>::min())))  // also catches NaN
+    {
+        return std::numeric_limits<T>::min();
+    }
+    if (rounded > static_cast<A>(std::numeric_limits<T>::max()))
+    {
+        return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(rounded);
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * how a new matrix's elements start out
+ */
+enum class MatrixInit
+{
+    /**
+     * all elements are 0
+     */
+    Zero,
+    /**
+     * elements are left undefined - for matrices that are about to be overwritten completely
+     * (skips a pass over the memory)
+     */
+    Uninitialized
+};
+
+template<typename T>
+class BasicMatrix;
+
+template<typename T>
+class BasicMatrixView;
+
+template<typename T>
+class BasicRowRange;
+
+template<typename T>
+std::istream &operator>>(std::istream &input, BasicMatrix<T> &rhs);
+
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicMatrix<T> &rhs);
+
+/**
+ *  class which represents a matrix of T elements.
+ *  instantiated for float (Matrix), double (DoubleMatrix), uint8_t (ByteMatrix) and
+ *  int8_t (SignedByteMatrix). Integer matrices use saturating arithmetic.
+ */
+template<typename T>
+class BasicMatrix
+{
+public:
+    /**
+     * type of a single element
+     */
+    typedef T ElementType;
+    /**
+     * type arithmetic is done in (and the type of scalar operands)
+     */
+    typedef typename MatrixElementTraits<T>::AccumType ScalarType;
+    /**
+     * writable view of the matrix elements
+     */
+    typedef BasicMatrixView<T> View;
+    /**
+     * read only view of the matrix elements
+     */
+    typedef BasicMatrixView<const T> ConstView;
+    /**
+     * element iterator (elements are stored row major and contiguous)
+     */
+    typedef T *iterator;
+    /**
+     * read only element iterator
+     */
+    typedef const T *const_iterator;
+
+private:
+
+    int _rows, _cols;
+    T *_mat;
+
+public:
+    /**
+     * Constructor
+     * Constructs matrix rows * cols (need to make sure rows,cols are non negative).
+     * Initiates all elements to 0 (unless init is MatrixInit::Uninitialized).
+     * the storage comes from the buffer pool (BufferPool.h), 64 byte aligned.
+     * @param rows
+     * @param cols
+     * @param init
+     */
+    BasicMatrix(int rows, int cols, MatrixInit init = MatrixInit::Zero);
+
+    /**
+     * Default constructor
+     * Constructs 1*1 matrix, where the single element is initiated to 0
+     */
+    BasicMatrix();
+
+    /**
+     * copy constructor
+     * Constructs matrix from another matrix
+     * @param m
+     */
+    BasicMatrix(const BasicMatrix &m);
+
+    /**
+     * move constructor
+     * takes over the storage of m (no allocation), m is left empty (0 * 0)
+     * @param m
+     */
+    BasicMatrix(BasicMatrix &&m) noexcept;
+
+    /**
+     * Constructs matrix from a view (copies the viewed elements)
+     * @param v
+     */
+    explicit BasicMatrix(const ConstView &v);
+
+    /**
+     * Destructor
+     * Destroys the matrix
+     */
+    ~BasicMatrix();
+
+    /**
+     * Returns the amount of rows (int).
+     * @return
+     */
+    int getRows() const;
+
+    /**
+     * Returns the amount of columns (int).
+     * @return
+     */
+    int getCols() const;
+
+    /**
+     * Returns pointer to the row major elements - no checks, valid until the matrix is resized.
+     * @return
+     */
+    T *data()
+    {
+        return _mat;
+    }
+
+    /**
+     * Returns pointer to the row major elements - no checks.
+     * @return
+     */
+    const T *data() const
+    {
+        return _mat;
+    }
+
+    /**
+     * Returns pointer to the first element of row i.
+     * unchecked (checked only when MATRIX_DEBUG_CHECKS is on).
+     * @param i
+     * @return
+     */
+    T *row_ptr(int i)
+    {
+        MATRIX_DEBUG_CHECK(i >= 0 && i < _rows, IDX_OUT_OF_RANGE);
+        return _mat + static_cast<long>(i) * _cols;
+    }
+
+    /**
+     * Returns pointer to the first element of row i.
+     * unchecked (checked only when MATRIX_DEBUG_CHECKS is on).
+     * @param i
+     * @return
+     */
+    const T *row_ptr(int i) const
+    {
+        MATRIX_DEBUG_CHECK(i >= 0 && i < _rows, IDX_OUT_OF_RANGE);
+        return _mat + static_cast<long>(i) * _cols;
+    }
+
+    /**
+     * element (i, j) without the bounds check of operator() - for inner loops whose bounds were
+     * validated once up front. checked only when MATRIX_DEBUG_CHECKS is on.
+     * @param i
+     * @param j
+     * @return
+     */
+    T &unchecked(int i, int j)
+    {
+        MATRIX_DEBUG_CHECK(i >= 0 && j >= 0 && i < _rows && j < _cols, IDX_OUT_OF_RANGE);
+        return _mat[static_cast<long>(i) * _cols + j];
+    }
+
+    /**
+     * element (i, j) without the bounds check of operator().
+     * checked only when MATRIX_DEBUG_CHECKS is on.
+     * @param i
+     * @param j
+     * @return
+     */
+    T unchecked(int i, int j) const
+    {
+        MATRIX_DEBUG_CHECK(i >= 0 && j >= 0 && i < _rows && j < _cols, IDX_OUT_OF_RANGE);
+        return _mat[static_cast<long>(i) * _cols + j];
+    }
+
+    /**
+     * iterator to the first element (row major order)
+     * @return
+     */
+    iterator begin()
+    {
+        return _mat;
+    }
+
+    /**
+     * iterator past the last element
+     * @return
+     */
+    iterator end()
+    {
+        return _mat + static_cast<long>(_rows) * _cols;
+    }
+
+    /**
+     * read only iterator to the first element (row major order)
+     * @return
+     */
+    const_iterator begin() const
+    {
+        return _mat;
+    }
+
+    /**
+     * read only iterator past the last element
+     * @return
+     */
+    const_iterator end() const
+    {
+        return _mat + static_cast<long>(_rows) * _cols;
+    }
+
+    /**
+     * read only iterator to the first element (row major order)
+     * @return
+     */
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    /**
+     * read only iterator past the last element
+     * @return
+     */
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+    /**
+     * the rows of the matrix, for (View row : m.rows()) { ... }
+     * @return
+     */
+    BasicRowRange<T> rows();
+
+    /**
+     * the rows of the matrix as read only views
+     * @return
+     */
+    BasicRowRange<const T> rows() const;
+
+    /**
+     * view over the whole matrix, no copy is made
+     * @return
+     */
+    View view();
+
+    /**
+     * read only view over the whole matrix, no copy is made
+     * @return
+     */
+    ConstView view() const;
+
+    /**
+     * view over the sub block starting at (row, col), no copy is made.
+     * Check the block is inside the matrix.
+     * @param row
+     * @param col
+     * @param rows
+     * @param cols
+     * @return
+     */
+    View block(int row, int col, int rows, int cols);
+
+    /**
+     * read only view over the sub block starting at (row, col), no copy is made.
+     * Check the block is inside the matrix.
+     * @param row
+     * @param col
+     * @param rows
+     * @param cols
+     * @return
+     */
+    ConstView block(int row, int col, int rows, int cols) const;
+
+    /**
+     * a matrix can be passed wherever a read only view is expected
+     * @return
+     */
+    operator ConstView() const;
+
+    /**
+     * Transforms a matrix into a column vector.
+     *  Supports function calling. I.E:
+     *  Matrix m(5,4);
+     *  m.vectorize();
+     *  int r = m.getRows(); // suppose to return 20
+     *  int c = m.getCols(); // suppose to return 1
+        [ 1, 2, 3]
+        [ 4, 5, 6] ⇒ transpose ( [1, 2, 3, 4, 5, 6, 7, 8, 9] )
+        [ 7, 8, 9]
+     *
+     * @return
+     */
+    BasicMatrix vectorize();
+
+    /**
+     * Transpose
+     * Matrix m(2, 3);
+     * Matrix t = m.transpose();  // 3 x 2, t(j, i) == m(i, j)
+     * cache oblivious blocked copy.
+     * @return new matrix
+     */
+    BasicMatrix transpose() const;
+
+    /**
+     * In place transpose of a square matrix, no memory is allocated.
+     * Check the matrix is square.
+     * @return updated matrix
+     */
+    BasicMatrix &transposeInPlace();
+
+    /**
+     * Transposed-operand multiplication: this^T * rhs, without materializing the transpose.
+     * Check dimensions valid for operation (this->getRows() == rhs.getRows()).
+     * @param rhs
+     * @return new matrix
+     */
+    BasicMatrix mul_tn(const ConstView &rhs) const;
+
+    /**
+     * Transposed-operand multiplication: this * rhs^T, without materializing the transpose.
+     * Check dimensions valid for operation (this->getCols() == rhs.getCols()).
+     * @param rhs
+     * @return new matrix
+     */
+    BasicMatrix mul_nt(const ConstView &rhs) const;
+
+    /**
+     * Prints matrix elements, no return value (void).
+     * Prints space after each element (not including the last element in the row).
+     * Prints new line after each row (not including the last row)
+     */
+    void print() const;
+
+    /**
+     * assignment
+     * Matrix a, b;
+     * a = b;
+     * @param rhs
+     * @return
+     */
+    BasicMatrix &operator=(const BasicMatrix &rhs);
+
+    /**
+     * move assignment
+     * swaps storage with rhs (no allocation)
+     * @param rhs
+     * @return
+     */
+    BasicMatrix &operator=(BasicMatrix &&rhs) noexcept;
+
+    /**
+     * Matrix multiplication
+     * Matrix a, b;
+     * Matrix c = a * b
+     * ** do not forget algebra rules for matrix multiplication.
+     * Check dimensions valid for operation.
+     * @param rhs
+     * @return
+     */
+    BasicMatrix operator*(const BasicMatrix &rhs) const;
+
+    /**
+     * Matrix multiplication by a view
+     * Check dimensions valid for operation.
+     * @param rhs
+     * @return
+     */
+    BasicMatrix operator*(const ConstView &rhs) const;
+
+    /**
+     * Scalar mult. On the right
+     * Matrix m;
+     * float c;
+     * Matrix m2 = m * c;
+     * @param c
+     * @return
+     */
+    BasicMatrix operator*(ScalarType c) const;
+
+    /**
+     *  Matrix multiplication.
+     *  Matrix a,b;
+     *  a*=b;
+     *  it is equivalent to  a= a*b
+     * Check dimensions valid for operation
+     * @param rhs
+     * @return
+     */
+    BasicMatrix &operator*=(const BasicMatrix &rhs);
+
+    /**
+     * Scalar mult.accumulation.
+     * Matrix a; float c;
+     * a*=c
+     * (note to self:  it is equivalent to a= a*c)
+     * @param c
+     * @return
+     */
+    BasicMatrix &operator*=(ScalarType c);
+
+    /**
+     * Scalar division on the right
+     * Matrix a; float c;
+     * Matrix b = a / c;
+     * check to scalar is not 0
+     * @param c
+     * @return
+     */
+    BasicMatrix operator/(ScalarType c);
+
+    /**
+     * Scalar division
+     * Matrix a;
+     * float c;
+     * a /= c;
+     * ** check to scalar is not 0.
+     * (note to self:  it is equivalent to a= a/c)
+     * @param c
+     * @return
+     */
+    BasicMatrix &operator/=(ScalarType c);
+
+    /**
+     * Matrix addition
+     * Matrix a, b;
+     * Matrix c = a + b;
+     * Check dimensions valid for operation.
+     * @param rhs
+     * @return
+     */
+    BasicMatrix operator+(const BasicMatrix &rhs) const;
+
+    /**
+     * Matrix addition of a view
+     * Check dimensions valid for operation.
+     * @param rhs
+     * @return
+     */
+    BasicMatrix operator+(const ConstView &rhs) const;
+
+    /**
+     * Matrix addition accumulation
+     * Matrix a, b;
+     * a += b;
+     * Check dimensions valid for operation.
+     * (note to self:  it is equivalent to a= a+b)
+     * @param c
+     * @return
+     */
+    BasicMatrix &operator+=(const BasicMatrix &rhs);
+
+    /**
+     * Matrix scalar addition.
+     * Matrix a; float c;
+     * a += c;
+     * (note to self:  it is equivalent to a= a+c)
+     * @param c
+     * @return
+     */
+    BasicMatrix &operator+=(ScalarType c);
+
+    /**
+     * Parenthesis indexing
+     *int i, j; Matrix m;
+     * float val = m(i, j);
+     * m(i,j) = 5.6;
+     * check the indexes are in the right range
+     *
+     * Check indexes are in valid ranges.
+
+     * @param i
+     * @param j
+     * @return
+     */
+    T operator()(int i, int j) const;
+
+    /**
+     * Parenthesis indexing
+     *int i, j; Matrix m;
+     * float val = m(i, j);
+     * m(i,j) = 5.6;
+     * check the indexes are in the right range
+     *
+     * Check indexes are in valid ranges.
+
+     * @param i
+     * @param j
+     * @return
+     */
+    T &operator()(int i, int j);
+
+    /**
+     * Brackets indexing
+     * int i; Matrix m;
+     * float val = m[i];
+     * m[k] = 6.7;
+     * read section 2.1.2
+     * Check index is in valid range.
+     * @param i
+     * @param j
+     * @return float with the relevant value
+     */
+    T operator[](int i) const;
+
+    /**
+     * Brackets indexing
+     * int i; Matrix m;
+     * float val = m[i];
+     * m[k] = 6.7;
+     * read section 2.1.2
+     * Check index is in valid range.
+     * @param i
+     * @param j
+     * @return ref float with the relevant value
+     */
+    T &operator[](int i);
+
+    /**
+     * Equality
+     * Matrix a, b;
+     * bool t = (a == b);
+     * @param rhs
+     * @return
+     */
+    bool operator==(const BasicMatrix &rhs) const;
+
+    /**
+     * Equality with a view
+     * @param rhs
+     * @return
+     */
+    bool operator==(const ConstView &rhs) const;
+
+    /**
+     * Not equal
+     * Matrix a, b;
+     * bool t = (a != b);
+     * @param rhs
+     * @return
+     */
+    bool operator!=(const BasicMatrix &rhs) const;
+
+    /**
+     * Not equal to a view
+     * @param rhs
+     * @return
+     */
+    bool operator!=(const ConstView &rhs) const;
+
+    /**
+     * Input stream
+     * Check input stream validity.
+     * Fills matrix elements. Reads from given input stream.
+     * I.E:
+     * ifstream is;
+     * Matrix m(3, 5);
+     * is >> m;
+     * I.E:
+     * The input is: 1 2 3 4 5 6
+     * Is >> m;
+     * m is [1 2 3]
+     * [4 5 6]
+     * @param rhs
+     * @return
+     */
+
+    friend std::istream &
+    operator>><>(std::istream &input, BasicMatrix &rhs);
+
+    /**
+     * Output stream
+     * Matrix m;
+     * std::cout << m << std::endl;
+     * OR
+     * file << m;
+     * @param rhs
+     * @return
+     */
+    friend std::ostream &operator<<<>(std::ostream &os, const BasicMatrix &rhs);
+};
+
+/**
+ * Scalar mult. In the left.
+ * Matrix m; float c;
+ * Matrix m2 = c * m
+ * @param c
+ * @param rhs
+ * @return
+ */
+template<typename T>
+BasicMatrix<T> operator*(typename BasicMatrix<T>::ScalarType c, const BasicMatrix<T> &rhs)
+{
+    return rhs * c;
+}
+
+/**
+ * the float matrix every existing client uses
+ */
+typedef BasicMatrix<float> Matrix;
+
+/**
+ * double precision matrix
+ */
+typedef BasicMatrix<double> DoubleMatrix;
+
+/**
+ * 8 bit grayscale image - values in [0,255], saturating arithmetic
+ */
+typedef BasicMatrix<uint8_t> ByteMatrix;
+
+/**
+ * signed 8 bit matrix - values in [-128,127], saturating arithmetic
+ */
+typedef BasicMatrix<int8_t> SignedByteMatrix;
+
+// views are part of the matrix interface, so every Matrix user gets them
+#include "MatrixView.h"
+
+#endif //EX5_MATRIX_H
@@ -0,0 +1,505 @@
+
+// ------------------------------ includes ------------------------------
+#include "MatrixIO.h"
+#include <charconv>
+#include <cctype>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ------------------------------ const & macros -----------------------------
+
+/**
+ * magic bytes opening every binary matrix
+ */
+#define MATRIX_BINARY_MAGIC "EX5M"
+/**
+ * size of the chunks the text reader pulls from the stream
+ */
+#define TEXT_CHUNK_SIZE (1 << 16)
+/**
+ * highest precision the text writer formats with
+ */
+#define MAX_TEXT_PRECISION 100
+/**
+ * longest text a single formatted element (at MAX_TEXT_PRECISION) and its separator can take
+ */
+#define MAX_ELEMENT_TEXT 128
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * element type code written to the binary header
+ * @tparam T
+ */
+template<typename T>
+struct MatrixFileType;
+
+template<>
+struct MatrixFileType<float>
+{
+    static const uint32_t code = 1;
+};
+
+template<>
+struct MatrixFileType<double>
+{
+    static const uint32_t code = 2;
+};
+
+template<>
+struct MatrixFileType<uint8_t>
+{
+    static const uint32_t code = 3;
+};
+
+template<>
+struct MatrixFileType<int8_t>
+{
+    static const uint32_t code = 4;
+};
+
+/**
+ * @return true if this host stores numbers little endian (the file byte order)
+ */
+static bool isLittleEndianHost()
+{
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+/**
+ * reverses the bytes of every element in place (file <-> host order on big endian hosts)
+ * @param data
+ * @param count number of elements
+ * @param size size of one element
+ */
+static void swapBytes(char *data, size_t count, size_t size)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        char *elem = data + i * size;
+        for (size_t b = 0; b < size / 2; ++b)
+        {
+            char tmp = elem[b];
+            elem[b] = elem[size - 1 - b];
+            elem[size - 1 - b] = tmp;
+        }
+    }
+}
+
+/**
+ * stores val as 4 little endian bytes
+ * @param dst
+ * @param val
+ */
+static void putUint32(unsigned char *dst, uint32_t val)
+{
+    for (int b = 0; b < 4; ++b)
+    {
+        dst[b] = static_cast<unsigned char>(val >> (8 * b));
+    }
+}
+
+/**
+ * reads 4 little endian bytes
+ * @param src
+ * @return
+ */
+static uint32_t getUint32(const unsigned char *src)
+{
+    return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+           (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+}
+
+/**
+ * validates a binary header and extracts the dimensions.
+ * @param header MATRIX_BINARY_HEADER_SIZE bytes
+ * @param rows
+ * @param cols
+ * @return false if it does not describe a matrix of T
+ */
+template<typename T>
+static bool parseHeader(const unsigned char *header, int &rows, int &cols)
+{
+    uint32_t r = getUint32(header + 8);
+    uint32_t c = getUint32(header + 12);
+    if (std::memcmp(header, MATRIX_BINARY_MAGIC, 4) != 0 || getUint32(header + 4) != MatrixFileType<T>::code ||
+        r > static_cast<uint32_t>(std::numeric_limits<int>::max()) ||
+        c > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+    {
+        return false;
+    }
+    rows = static_cast<int>(r);
+    cols = static_cast<int>(c);
+    return true;
+}
+
+/**
+ * whether rows x cols elements of T fit in the given number of bytes - divides instead of
+ * multiplying, so dimensions from an untrusted header cannot wrap size_t
+ * @param rows
+ * @param cols
+ * @param bytes
+ * @return
+ */
+template<typename T>
+static bool fitsIn(int rows, int cols, size_t bytes)
+{
+    return cols == 0 || static_cast<size_t>(rows) <= bytes / sizeof(T) / static_cast<size_t>(cols);
+}
+
+/**
+ * bytes left in the stream, or the largest size_t if it cannot seek (e.g. a pipe)
+ * @param is
+ * @return
+ */
+static size_t remainingBytes(std::istream &is)
+{
+    std::istream::pos_type pos = is.tellg();
+    if (pos == std::istream::pos_type(-1))
+    {
+        is.clear();
+        return std::numeric_limits<size_t>::max();
+    }
+    is.seekg(0, std::ios::end);
+    std::istream::pos_type end = is.tellg();
+    is.clear();
+    is.seekg(pos);
+    if (end == std::istream::pos_type(-1) || end < pos)
+    {
+        return std::numeric_limits<size_t>::max();
+    }
+    return static_cast<size_t>(end - pos);
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * writes the matrix (or view) in the binary format with one bulk write per row
+ * (one write in total for contiguous data).
+ * @param os
+ * @param m
+ */
+template<typename T>
+void writeBinary(std::ostream &os, const BasicMatrixView<const T> &m)
+{
+    unsigned char header[MATRIX_BINARY_HEADER_SIZE];
+    std::memcpy(header, MATRIX_BINARY_MAGIC, 4);
+    putUint32(header + 4, MatrixFileType<T>::code);
+    putUint32(header + 8, static_cast<uint32_t>(m.getRows()));
+    putUint32(header + 12, static_cast<uint32_t>(m.getCols()));
+    os.write(reinterpret_cast<const char *>(header), MATRIX_BINARY_HEADER_SIZE);
+
+    size_t rowBytes = static_cast<size_t>(m.getCols()) * sizeof(T);
+    if (!isLittleEndianHost())
+    {
+        std::vector<char> row(rowBytes);
+        for (int i = 0; i < m.getRows(); ++i)
+        {
+            std::memcpy(row.data(), m.data() + static_cast<long>(i) * m.getStride(), rowBytes);
+            swapBytes(row.data(), m.getCols(), sizeof(T));
+            os.write(row.data(), rowBytes);
+        }
+    }
+    else if (m.isContiguous())
+    {
+        os.write(reinterpret_cast<const char *>(m.data()), rowBytes * m.getRows());
+    }
+    else
+    {
+        for (int i = 0; i < m.getRows(); ++i)
+        {
+            os.write(reinterpret_cast<const char *>(m.data() + static_cast<long>(i) * m.getStride()), rowBytes);
+        }
+    }
+}
+
+/**
+ * reads a matrix in the binary format, elements are read straight into the matrix storage.
+ * Check the stream holds a matrix of T.
+ * @param is
+ * @return the matrix
+ */
+template<typename T>
+BasicMatrix<T> readBinary(std::istream &is)
+{
+    unsigned char header[MATRIX_BINARY_HEADER_SIZE];
+    if (!is.read(reinterpret_cast<char *>(header), MATRIX_BINARY_HEADER_SIZE))
+    {
+        matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+    }
+    int rows, cols;
+    // the header is untrusted: check the body can be there before allocating for it
+    if (!parseHeader<T>(header, rows, cols) || !fitsIn<T>(rows, cols, remainingBytes(is)))
+    {
+        matrixError<std::runtime_error>(INVALID_MATRIX_FILE);
+    }
+
+    BasicMatrix<T> res(rows, cols, MatrixInit::Uninitialized);
+    size_t count = static_cast<size_t>(rows) * cols;
+    char *dst = reinterpret_cast<char *>(res.data());
+    if (!is.read(dst, count * sizeof(T)))
+    {
+        matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+    }
+    if (!isLittleEndianHost())
+    {
+        swapBytes(dst, count, sizeof(T));
+    }
+    return res;
+}
+
+/**
+ * reads a matrix in the binary format into res, one bulk read per row
+ * @param is
+ * @param res
+ */
+template<typename T>
+void readBinary(std::istream &is, const BasicMatrixView<T> &res)
+{
+    unsigned char header[MATRIX_BINARY_HEADER_SIZE];
+    if (!is.read(reinterpret_cast<char *>(header), MATRIX_BINARY_HEADER_SIZE))
+    {
+        matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+    }
+    int rows, cols;
+    if (!parseHeader<T>(header, rows, cols))
+    {
+        matrixError<std::runtime_error>(INVALID_MATRIX_FILE);
+    }
+    if (rows != res.getRows() || cols != res.getCols())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    for (int i = 0; i < rows; ++i)
+    {
+        char *dst = reinterpret_cast<char *>(res.row_ptr(i));
+        if (!is.read(dst, static_cast<std::streamsize>(cols) * sizeof(T)))
+        {
+            matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+        }
+        if (!isLittleEndianHost())
+        {
+            swapBytes(dst, cols, sizeof(T));
+        }
+    }
+}
+
+/**
+ * loads a binary matrix file by memory mapping it and copying the elements out in one pass.
+ * @param path
+ * @return the matrix
+ */
+template<typename T>
+BasicMatrix<T> loadBinary(const std::string &path)
+{
+    if (!isLittleEndianHost())
+    {
+        std::ifstream file(path, std::ios::binary);
+        return readBinary<T>(file);
+    }
+    BasicMappedMatrixFile<T> file(path);
+    return BasicMatrix<T>(file.view());
+}
+
+/**
+ * fast text reader for the whitespace separated format of operator>>.
+ * the stream is pulled TEXT_CHUNK_SIZE bytes at a time; a number cut by the end of a chunk is
+ * carried over to the next one.
+ * throws std::runtime_error on a malformed or short stream; rhs may then be partially filled.
+ * @param is
+ * @param rhs
+ */
+template<typename T>
+void readText(std::istream &is, BasicMatrix<T> &rhs)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    if (!is.good())
+    {
+        matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+    }
+    T *dst = rhs.data();
+    size_t total = static_cast<size_t>(rhs.getRows()) * rhs.getCols();
+    size_t filled = 0;
+    std::vector<char> buf(TEXT_CHUNK_SIZE);
+    size_t carry = 0;
+    bool eof = false;
+    while (filled < total && !eof)
+    {
+        if (buf.size() < carry + TEXT_CHUNK_SIZE)
+        {
+            buf.resize(carry + TEXT_CHUNK_SIZE);
+        }
+        std::streamsize got = is.rdbuf()->sgetn(buf.data() + carry, TEXT_CHUNK_SIZE);
+        eof = got < TEXT_CHUNK_SIZE;
+        const char *p = buf.data();
+        const char *end = p + carry + got;
+        while (filled < total)
+        {
+            while (p < end && std::isspace(static_cast<unsigned char>(*p)))
+            {
+                ++p;
+            }
+            const char *tokEnd = p;
+            while (tokEnd < end && !std::isspace(static_cast<unsigned char>(*tokEnd)))
+            {
+                ++tokEnd;
+            }
+            if (p == end || (tokEnd == end && !eof))
+            {
+                break;  // need more input
+            }
+            const char *numBegin = (*p == '+') ? p + 1 : p;  // from_chars does not take a leading '+'
+            ScalarType val;
+            std::from_chars_result parsed = std::from_chars(numBegin, tokEnd, val);
+            if (parsed.ec != std::errc() || parsed.ptr != tokEnd)
+            {
+                matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+            }
+            dst[filled++] = saturateCast<T>(val);
+            p = tokEnd;
+        }
+        carry = end - p;
+        std::memmove(buf.data(), p, carry);
+    }
+    if (eof)
+    {
+        is.setstate(std::ios::eofbit);
+    }
+    if (filled < total)
+    {
+        matrixError<std::runtime_error>(INPUT_STREAM_INVALID);
+    }
+}
+
+/**
+ * fast text writer, same output as operator<<.
+ * elements are formatted with std::to_chars in %g style using the stream precision (what
+ * os << float does with default flags) into a buffer that is written once it fills up.
+ * @param os
+ * @param m
+ */
+template<typename T>
+void writeText(std::ostream &os, const BasicMatrixView<const T> &m)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    int precision = static_cast<int>(std::min<std::streamsize>(os.precision(), MAX_TEXT_PRECISION));
+    std::vector<char> buf(TEXT_CHUNK_SIZE);
+    char *out = buf.data();
+    char *limit = buf.data() + TEXT_CHUNK_SIZE - MAX_ELEMENT_TEXT;
+    for (int i = 0; i < m.getRows(); ++i)
+    {
+        const T *row = m.data() + static_cast<long>(i) * m.getStride();
+        for (int j = 0; j < m.getCols(); ++j)
+        {
+            if (out > limit)
+            {
+                os.write(buf.data(), out - buf.data());
+                out = buf.data();
+            }
+            out = std::to_chars(out, out + MAX_ELEMENT_TEXT - 1, static_cast<ScalarType>(row[j]),
+                                std::chars_format::general, precision).ptr;
+            if (j != m.getCols() - 1)
+            {
+                *out++ = ' ';
+            }
+        }
+        if (i != m.getRows() - 1)
+        {
+            *out++ = '\n';
+        }
+    }
+    os.write(buf.data(), out - buf.data());
+}
+
+// ------------------------------ mapped files -----------------------------
+
+/**
+ * Constructor
+ * maps the file and validates its header.
+ * @param path
+ */
+template<typename T>
+BasicMappedMatrixFile<T>::BasicMappedMatrixFile(const std::string &path) : _map(nullptr), _mapSize(0), _rows(0),
+                                                                          _cols(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        matrixError<std::runtime_error>(CANNOT_OPEN_FILE);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        matrixError<std::runtime_error>(CANNOT_OPEN_FILE);
+    }
+    _mapSize = static_cast<size_t>(info.st_size);
+    if (_mapSize < MATRIX_BINARY_HEADER_SIZE || !isLittleEndianHost())
+    {
+        close(fd);
+        matrixError<std::runtime_error>(INVALID_MATRIX_FILE);
+    }
+    _map = mmap(nullptr, _mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (_map == MAP_FAILED)
+    {
+        matrixError<std::runtime_error>(CANNOT_OPEN_FILE);
+    }
+    // the destructor does not run when the constructor throws - unmap before reporting
+    bool valid = parseHeader<T>(static_cast<const unsigned char *>(_map), _rows, _cols) &&
+                 fitsIn<T>(_rows, _cols, _mapSize - MATRIX_BINARY_HEADER_SIZE);
+    if (!valid)
+    {
+        munmap(_map, _mapSize);
+        matrixError<std::runtime_error>(INVALID_MATRIX_FILE);
+    }
+    madvise(_map, _mapSize, MADV_SEQUENTIAL);
+}
+
+/**
+ * Destructor
+ * unmaps the file
+ */
+template<typename T>
+BasicMappedMatrixFile<T>::~BasicMappedMatrixFile()
+{
+    munmap(_map, _mapSize);
+}
+
+/**
+ * read only view of the mapped elements, valid while this object lives
+ * @return
+ */
+template<typename T>
+BasicMatrixView<const T> BasicMappedMatrixFile<T>::view() const
+{
+    const T *data = reinterpret_cast<const T *>(static_cast<const char *>(_map) + MATRIX_BINARY_HEADER_SIZE);
+    return BasicMatrixView<const T>(data, _rows, _cols);
+}
+
+// ------------------------------ instantiations -----------------------------
+
+/**
+ * instantiates the io functions for one element type
+ */
+#define INSTANTIATE_MATRIX_IO(T) \
+    template void writeBinary(std::ostream &os, const BasicMatrixView<const T> &m); \
+    template BasicMatrix<T> readBinary<T>(std::istream &is); \
+    template void readBinary(std::istream &is, const BasicMatrixView<T> &res); \
+    template BasicMatrix<T> loadBinary<T>(const std::string &path); \
+    template void readText(std::istream &is, BasicMatrix<T> &rhs); \
+    template void writeText(std::ostream &os, const BasicMatrixView<const T> &m); \
+    template class BasicMappedMatrixFile<T>;
+
+INSTANTIATE_MATRIX_IO(float)
+INSTANTIATE_MATRIX_IO(double)
+INSTANTIATE_MATRIX_IO(uint8_t)
+INSTANTIATE_MATRIX_IO(int8_t)
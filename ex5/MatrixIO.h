@@ -0,0 +1,169 @@
+
+
+#ifndef EX5_MATRIXIO_H
+
+// ------------------------------ includes ------------------------------
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include "Matrix.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_MATRIXIO_H
+/**
+ * binary file / stream is not a matrix of the requested type
+ */
+#define INVALID_MATRIX_FILE "Invalid matrix file.\n"
+/**
+ * the matrix file could not be opened / mapped
+ */
+#define CANNOT_OPEN_FILE "Cannot open matrix file.\n"
+/**
+ * size of the binary header: magic, element type, rows, cols (4 bytes each)
+ */
+#define MATRIX_BINARY_HEADER_SIZE 16
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * Binary format
+ * [ "EX5M" | element type | rows | cols ] followed by rows * cols elements, row major.
+ * header fields are 32 bit little endian ints, elements are little endian, no padding.
+ * element type: 1 - float, 2 - double, 3 - uint8_t, 4 - int8_t.
+ */
+
+/**
+ * writes the matrix (or view) in the binary format with one bulk write per row
+ * (one write in total for contiguous data).
+ * @param os
+ * @param m
+ */
+template<typename T>
+void writeBinary(std::ostream &os, const BasicMatrixView<const T> &m);
+
+/**
+ * writes the matrix in the binary format
+ * @param os
+ * @param m
+ */
+template<typename T>
+inline void writeBinary(std::ostream &os, const BasicMatrix<T> &m)
+{
+    writeBinary(os, m.view());
+}
+
+/**
+ * reads a matrix in the binary format, elements are read straight into the matrix storage.
+ * Check the stream holds a matrix of T.
+ * @param is
+ * @return the matrix
+ */
+template<typename T>
+BasicMatrix<T> readBinary(std::istream &is);
+
+/**
+ * reads a matrix in the binary format into an existing matrix (or view) of the same size, row by
+ * row straight into its storage - for reading a sequence of same sized matrices (e.g frames)
+ * without allocating.
+ * Check the stream holds a matrix of T of res's dimensions (throws std::invalid_argument if the
+ * size differs).
+ * @param is
+ * @param res
+ */
+template<typename T>
+void readBinary(std::istream &is, const BasicMatrixView<T> &res);
+
+/**
+ * loads a binary matrix file by memory mapping it and copying the elements out in one pass.
+ * @param path
+ * @return the matrix
+ */
+template<typename T>
+BasicMatrix<T> loadBinary(const std::string &path);
+
+/**
+ * fast text reader for the whitespace separated format of operator>>.
+ * numbers are parsed with std::from_chars from large buffered chunks instead of one formatted
+ * extraction per element. Fills rhs in row major order.
+ * throws std::runtime_error on a malformed or short stream (rhs may then be partially filled).
+ * note: the stream is read in chunks, so it may be consumed past the last needed number -
+ * intended for reading whole files.
+ * @param is
+ * @param rhs
+ */
+template<typename T>
+void readText(std::istream &is, BasicMatrix<T> &rhs);
+
+/**
+ * fast text writer, same output as operator<< (elements formatted with std::to_chars using the
+ * stream precision, written a buffer at a time).
+ * @param os
+ * @param m
+ */
+template<typename T>
+void writeText(std::ostream &os, const BasicMatrixView<const T> &m);
+
+/**
+ * fast text writer, same output as operator<<
+ * @param os
+ * @param m
+ */
+template<typename T>
+inline void writeText(std::ostream &os, const BasicMatrix<T> &m)
+{
+    writeText(os, m.view());
+}
+
+/**
+ *  read only memory mapping of a binary matrix file.
+ *  the elements are used straight from the page cache, nothing is copied.
+ *  (on big endian hosts the file can not be viewed in place - use loadBinary there)
+ */
+template<typename T>
+class BasicMappedMatrixFile
+{
+private:
+
+    void *_map;
+    size_t _mapSize;
+    int _rows, _cols;
+
+public:
+    /**
+     * Constructor
+     * maps the file and validates its header.
+     * @param path
+     */
+    explicit BasicMappedMatrixFile(const std::string &path);
+
+    /**
+     * Destructor
+     * unmaps the file
+     */
+    ~BasicMappedMatrixFile();
+
+    /**
+     * a mapping owns its pages, it can not be copied
+     */
+    BasicMappedMatrixFile(const BasicMappedMatrixFile &) = delete;
+
+    /**
+     * a mapping owns its pages, it can not be copied
+     */
+    BasicMappedMatrixFile &operator=(const BasicMappedMatrixFile &) = delete;
+
+    /**
+     * read only view of the mapped elements, valid while this object lives
+     * @return
+     */
+    BasicMatrixView<const T> view() const;
+};
+
+/**
+ * mapping of a float matrix file
+ */
+typedef BasicMappedMatrixFile<float> MappedMatrixFile;
+
+#endif //EX5_MATRIXIO_H
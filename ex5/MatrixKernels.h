@@ -0,0 +1,335 @@
+
+
+#ifndef EX5_MATRIXKERNELS_H
+
+// ------------------------------ includes ------------------------------
+
+#include <algorithm>
+#include <utility>
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_MATRIXKERNELS_H
+/**
+ * rows of A handled per block by the blocked multiplication kernel
+ */
+#define GEMM_BLOCK_ROWS 64
+/**
+ * inner (k) dimension handled per block - a GEMM_BLOCK_DEPTH x GEMM_BLOCK_COLS panel of B stays in L2
+ */
+#define GEMM_BLOCK_DEPTH 256
+/**
+ * columns of B / C handled per block
+ */
+#define GEMM_BLOCK_COLS 512
+/**
+ * tiles at most this wide are transposed directly by the transpose kernels
+ */
+#define TRANSPOSE_LEAF 32
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * raw blocked multiply-accumulate kernel shared by the Matrix operations:
+ *  C[m x n] += A[m x k] * B[k x n]
+ * all matrices are row major with leading dimensions (row strides) lda, ldb, ldc.
+ * the loops run i-k-j inside cache blocks so the innermost loop streams contiguous rows of B and C
+ * (and vectorizes); every C element still receives its products in increasing k order, so results
+ * match the plain triple loop.
+ * @tparam T element type of A and B
+ * @tparam A accumulator type of C
+ */
+template<typename T, typename A>
+inline void gemmAccumulate(int m, int n, int k, const T *a, int lda, const T *b, int ldb, A *c, int ldc)
+{
+    for (int i0 = 0; i0 < m; i0 += GEMM_BLOCK_ROWS)
+    {
+        int iEnd = std::min(m, i0 + GEMM_BLOCK_ROWS);
+        for (int k0 = 0; k0 < k; k0 += GEMM_BLOCK_DEPTH)
+        {
+            int kEnd = std::min(k, k0 + GEMM_BLOCK_DEPTH);
+            for (int j0 = 0; j0 < n; j0 += GEMM_BLOCK_COLS)
+            {
+                int jEnd = std::min(n, j0 + GEMM_BLOCK_COLS);
+                for (int i = i0; i < iEnd; ++i)
+                {
+                    A *cRow = c + static_cast<long>(i) * ldc;
+                    const T *aRow = a + static_cast<long>(i) * lda;
+                    for (int p = k0; p < kEnd; ++p)
+                    {
+                        const A aip = aRow[p];
+                        const T *bRow = b + static_cast<long>(p) * ldb;
+                        for (int j = j0; j < jEnd; ++j)
+                        {
+                            cRow[j] += aip * bRow[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ *  C[m x n] += A^T * B  where A is k x m and B is k x n (row major, strides lda, ldb, ldc).
+ *  A is read down its columns one row of A at a time, so no transposed copy is needed;
+ *  the inner loop streams rows of B and C like gemmAccumulate.
+ */
+template<typename T, typename A>
+inline void gemmTNAccumulate(int m, int n, int k, const T *a, int lda, const T *b, int ldb, A *c, int ldc)
+{
+    for (int i0 = 0; i0 < m; i0 += GEMM_BLOCK_ROWS)
+    {
+        int iEnd = std::min(m, i0 + GEMM_BLOCK_ROWS);
+        for (int k0 = 0; k0 < k; k0 += GEMM_BLOCK_DEPTH)
+        {
+            int kEnd = std::min(k, k0 + GEMM_BLOCK_DEPTH);
+            for (int j0 = 0; j0 < n; j0 += GEMM_BLOCK_COLS)
+            {
+                int jEnd = std::min(n, j0 + GEMM_BLOCK_COLS);
+                for (int i = i0; i < iEnd; ++i)
+                {
+                    A *cRow = c + static_cast<long>(i) * ldc;
+                    for (int p = k0; p < kEnd; ++p)
+                    {
+                        const A api = a[static_cast<long>(p) * lda + i];
+                        const T *bRow = b + static_cast<long>(p) * ldb;
+                        for (int j = j0; j < jEnd; ++j)
+                        {
+                            cRow[j] += api * bRow[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ *  C[m x n] += A * B^T  where A is m x k and B is n x k (row major, strides lda, ldb, ldc).
+ *  every element is a dot product of two contiguous rows; blocks of B rows are reused across a
+ *  block of A rows while they are in cache.
+ */
+template<typename T, typename A>
+inline void gemmNTAccumulate(int m, int n, int k, const T *a, int lda, const T *b, int ldb, A *c, int ldc)
+{
+    for (int i0 = 0; i0 < m; i0 += GEMM_BLOCK_ROWS)
+    {
+        int iEnd = std::min(m, i0 + GEMM_BLOCK_ROWS);
+        for (int j0 = 0; j0 < n; j0 += GEMM_BLOCK_ROWS)
+        {
+            int jEnd = std::min(n, j0 + GEMM_BLOCK_ROWS);
+            for (int i = i0; i < iEnd; ++i)
+            {
+                const T *aRow = a + static_cast<long>(i) * lda;
+                for (int j = j0; j < jEnd; ++j)
+                {
+                    const T *bRow = b + static_cast<long>(j) * ldb;
+                    A sum = 0;
+                    for (int p = 0; p < k; ++p)
+                    {
+                        sum += static_cast<A>(aRow[p]) * bRow[p];
+                    }
+                    c[static_cast<long>(i) * ldc + j] += sum;
+                }
+            }
+        }
+    }
+}
+
+/**
+ *  y[m] += A[m x n] * x   (x has stride incx, so a column of a matrix can be used as is).
+ *  four rows are walked together so every x element is loaded once per four rows; each row still
+ *  sums its products in increasing column order, like gemmAccumulate with a single column.
+ */
+template<typename T, typename A>
+inline void gemvAccumulate(int m, int n, const T *a, int lda, const T *x, int incx, A *y)
+{
+    int i = 0;
+    for (; i + 4 <= m; i += 4)
+    {
+        const T *a0 = a + static_cast<long>(i) * lda;
+        const T *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+        A s0 = y[i], s1 = y[i + 1], s2 = y[i + 2], s3 = y[i + 3];
+        for (int j = 0; j < n; ++j)
+        {
+            const A xj = x[static_cast<long>(j) * incx];
+            s0 += xj * a0[j];
+            s1 += xj * a1[j];
+            s2 += xj * a2[j];
+            s3 += xj * a3[j];
+        }
+        y[i] = s0;
+        y[i + 1] = s1;
+        y[i + 2] = s2;
+        y[i + 3] = s3;
+    }
+    for (; i < m; ++i)
+    {
+        const T *aRow = a + static_cast<long>(i) * lda;
+        A sum = y[i];
+        for (int j = 0; j < n; ++j)
+        {
+            sum += static_cast<A>(x[static_cast<long>(j) * incx]) * aRow[j];
+        }
+        y[i] = sum;
+    }
+}
+
+/**
+ *  y[n] += A[m x n]^T * x   (x has stride incx).
+ *  walks A row by row, adding x[i] * row i to y - the inner loop is a contiguous axpy.
+ */
+template<typename T, typename A>
+inline void gemvTAccumulate(int m, int n, const T *a, int lda, const T *x, int incx, A *y)
+{
+    for (int i = 0; i < m; ++i)
+    {
+        const A xi = x[static_cast<long>(i) * incx];
+        const T *aRow = a + static_cast<long>(i) * lda;
+        for (int j = 0; j < n; ++j)
+        {
+            y[j] += xi * aRow[j];
+        }
+    }
+}
+
+/**
+ *  C[M x N] = A[M x K] * B[K x N] for tiny contiguous row major matrices whose sizes are known at
+ *  compile time: the loops have constant trip counts and are unrolled completely by the compiler,
+ *  the operands stay in registers.
+ */
+template<int M, int K, int N, typename T>
+inline void smallGemmKernel(const T *a, const T *b, T *c)
+{
+    for (int i = 0; i < M; ++i)
+    {
+        for (int j = 0; j < N; ++j)
+        {
+            T sum = a[i * K] * b[j];
+            for (int p = 1; p < K; ++p)
+            {
+                sum += a[i * K + p] * b[p * N + j];
+            }
+            c[i * N + j] = sum;
+        }
+    }
+}
+
+/**
+ *  dst[cols x rows] = src[rows x cols]^T, cache oblivious: the larger dimension is halved until
+ *  the tile fits TRANSPOSE_LEAF x TRANSPOSE_LEAF, so both the reads and the strided writes stay in
+ *  cache whatever the cache sizes are.
+ */
+template<typename T>
+inline void transposeKernel(int rows, int cols, const T *src, int lds, T *dst, int ldd)
+{
+    if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF)
+    {
+        for (int i = 0; i < rows; ++i)
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                dst[static_cast<long>(j) * ldd + i] = src[static_cast<long>(i) * lds + j];
+            }
+        }
+    }
+    else if (rows >= cols)
+    {
+        int half = rows / 2;
+        transposeKernel(half, cols, src, lds, dst, ldd);
+        transposeKernel(rows - half, cols, src + static_cast<long>(half) * lds, lds, dst + half, ldd);
+    }
+    else
+    {
+        int half = cols / 2;
+        transposeKernel(rows, half, src, lds, dst, ldd);
+        transposeKernel(rows, cols - half, src + half, lds, dst + static_cast<long>(half) * ldd, ldd);
+    }
+}
+
+/**
+ *  swaps the rows x cols block a with the transpose of the cols x rows block b (same stride ld),
+ *  recursively like transposeKernel. the in place transpose of a square matrix is this applied to
+ *  its two off diagonal halves.
+ */
+template<typename T>
+inline void transposeSwapKernel(int rows, int cols, T *a, T *b, int ld)
+{
+    if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF)
+    {
+        for (int i = 0; i < rows; ++i)
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                std::swap(a[static_cast<long>(i) * ld + j], b[static_cast<long>(j) * ld + i]);
+            }
+        }
+    }
+    else if (rows >= cols)
+    {
+        int half = rows / 2;
+        transposeSwapKernel(half, cols, a, b, ld);
+        transposeSwapKernel(rows - half, cols, a + static_cast<long>(half) * ld, b + half, ld);
+    }
+    else
+    {
+        int half = cols / 2;
+        transposeSwapKernel(rows, half, a, b, ld);
+        transposeSwapKernel(rows, cols - half, a + half, b + static_cast<long>(half) * ld, ld);
+    }
+}
+
+/**
+ *  in place transpose of the n x n matrix a (stride ld): transpose both diagonal blocks, swap the
+ *  off diagonal ones.
+ */
+template<typename T>
+inline void transposeSquareInPlace(int n, T *a, int ld)
+{
+    if (n <= TRANSPOSE_LEAF)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = i + 1; j < n; ++j)
+            {
+                std::swap(a[static_cast<long>(i) * ld + j], a[static_cast<long>(j) * ld + i]);
+            }
+        }
+        return;
+    }
+    int half = n / 2;
+    transposeSquareInPlace(half, a, ld);
+    transposeSquareInPlace(n - half, a + static_cast<long>(half) * ld + half, ld);
+    transposeSwapKernel(half, n - half, a + half, a + static_cast<long>(half) * ld, ld);
+}
+
+/**
+ * C[m x n] = A + B (or A - B when subtract is set), all row major with their own strides
+ */
+template<typename T>
+inline void addKernel(int m, int n, const T *a, int lda, const T *b, int ldb, T *c, int ldc, bool subtract)
+{
+    for (int i = 0; i < m; ++i)
+    {
+        const T *aRow = a + static_cast<long>(i) * lda;
+        const T *bRow = b + static_cast<long>(i) * ldb;
+        T *cRow = c + static_cast<long>(i) * ldc;
+        if (subtract)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                cRow[j] = aRow[j] - bRow[j];
+            }
+        }
+        else
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                cRow[j] = aRow[j] + bRow[j];
+            }
+        }
+    }
+}
+
+#endif //EX5_MATRIXKERNELS_H
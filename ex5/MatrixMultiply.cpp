@@ -0,0 +1,279 @@
+
+// ------------------------------ includes ------------------------------
+#include "MatrixMultiply.h"
+#include "MatrixKernels.h"
+#include "ParallelFor.h"
+#include <vector>
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * dst[n x n] = src
+ */
+template<typename T>
+static void copyBlock(int n, const T *src, int lds, T *dst, int ldd)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        std::copy(src + static_cast<long>(i) * lds, src + static_cast<long>(i) * lds + n,
+                  dst + static_cast<long>(i) * ldd);
+    }
+}
+
+/**
+ * C[n x n] = A * B with the strassen-winograd recursion.
+ * the 7 products and 15 sums of a level are scheduled so that, besides the four C quadrants,
+ * only four h x h temporaries are live (h = n / 2).
+ * n must be of the form m * 2^k with m <= cutoff (see multiplyT).
+ */
+template<typename T>
+static void strassen(int n, const T *a, int lda, const T *b, int ldb, T *c, int ldc, int cutoff)
+{
+    if (n <= cutoff || n % 2 != 0)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            std::fill(c + static_cast<long>(i) * ldc, c + static_cast<long>(i) * ldc + n, T(0));
+        }
+        gemmAccumulate(n, n, n, a, lda, b, ldb, c, ldc);
+        return;
+    }
+    int h = n / 2;
+    const T *a11 = a, *a12 = a + h, *a21 = a + static_cast<long>(h) * lda, *a22 = a21 + h;
+    const T *b11 = b, *b12 = b + h, *b21 = b + static_cast<long>(h) * ldb, *b22 = b21 + h;
+    T *c11 = c, *c12 = c + h, *c21 = c + static_cast<long>(h) * ldc, *c22 = c21 + h;
+
+    std::vector<T> temps(4 * static_cast<size_t>(h) * h);
+    T *x = temps.data();
+    T *y = x + static_cast<size_t>(h) * h;
+    T *z = y + static_cast<size_t>(h) * h;
+    T *w = z + static_cast<size_t>(h) * h;
+
+    addKernel(h, h, a21, lda, a22, lda, x, h, false);        // S1 = A21 + A22
+    addKernel(h, h, b12, ldb, b11, ldb, y, h, true);         // T1 = B12 - B11
+    strassen(h, x, h, y, h, c22, ldc, cutoff);               // M5 = S1 * T1
+    addKernel(h, h, x, h, a11, lda, x, h, true);             // S2 = S1 - A11
+    addKernel(h, h, b22, ldb, y, h, y, h, true);             // T2 = B22 - T1
+    strassen(h, x, h, y, h, c12, ldc, cutoff);               // M6 = S2 * T2
+    addKernel(h, h, a12, lda, x, h, x, h, true);             // S4 = A12 - S2
+    strassen(h, x, h, b22, ldb, c11, ldc, cutoff);           // M3 = S4 * B22
+    addKernel(h, h, y, h, b21, ldb, y, h, true);             // T4 = T2 - B21
+    strassen(h, a22, lda, y, h, c21, ldc, cutoff);           // M4 = A22 * T4
+    strassen(h, a11, lda, b11, ldb, z, h, cutoff);           // M1 = A11 * B11
+    addKernel(h, h, z, h, c12, ldc, c12, ldc, false);        // U2 = M1 + M6
+    addKernel(h, h, a11, lda, a21, lda, x, h, true);         // S3 = A11 - A21
+    addKernel(h, h, b22, ldb, b12, ldb, y, h, true);         // T3 = B22 - B12
+    strassen(h, x, h, y, h, w, h, cutoff);                   // M7 = S3 * T3
+    addKernel(h, h, c11, ldc, c12, ldc, c11, ldc, false);    // M3 + U2
+    addKernel(h, h, c11, ldc, c22, ldc, c11, ldc, false);    // U5 = U2 + M5 + M3
+    addKernel(h, h, w, h, c21, ldc, c21, ldc, true);         // M7 - M4
+    addKernel(h, h, c21, ldc, c12, ldc, c21, ldc, false);    // U6 = U2 + M7 - M4 -> C21
+    addKernel(h, h, c22, ldc, w, h, c22, ldc, false);        // M5 + M7
+    addKernel(h, h, c22, ldc, c12, ldc, c22, ldc, false);    // U7 = U2 + M7 + M5 -> C22
+    copyBlock(h, c11, ldc, c12, ldc);                        // U5 -> C12
+    strassen(h, a12, lda, b21, ldb, x, h, cutoff);           // M2 = A12 * B21
+    addKernel(h, h, z, h, x, h, c11, ldc, false);            // U1 = M1 + M2 -> C11
+}
+
+/**
+ * multiply for float and double
+ */
+template<typename T>
+static BasicMatrix<T> multiplyT(const BasicMatrixView<const T> &a, const BasicMatrixView<const T> &b,
+                                MultiplicationAlgorithm algorithm, int cutoff)
+{
+    if (a.getCols() != b.getRows())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    int n = a.getRows();
+    cutoff = std::max(cutoff, 1);
+    bool square = a.getCols() == n && b.getCols() == n;
+    if (algorithm == MultiplicationAlgorithm::Classical || !square || n <= cutoff ||
+        (algorithm == MultiplicationAlgorithm::Auto && n < STRASSEN_AUTO_MIN_SIZE))
+    {
+        return a * b;
+    }
+
+    // pad to m * 2^k with m <= cutoff, so every level splits evenly
+    int levels = 0;
+    int base = n;
+    while (base > cutoff)
+    {
+        base = (base + 1) / 2;
+        ++levels;
+    }
+    int padded = base << levels;
+
+    BasicMatrix<T> res(n, n, MatrixInit::Uninitialized);
+    if (padded == n)
+    {
+        strassen(n, a.data(), a.getStride(), b.data(), b.getStride(), res.data(), n, cutoff);
+        return res;
+    }
+    size_t paddedSize = static_cast<size_t>(padded) * padded;
+    std::vector<T> buf(3 * paddedSize, T(0));
+    T *pa = buf.data();
+    T *pb = pa + paddedSize;
+    T *pc = pb + paddedSize;
+    copyBlock(n, a.data(), a.getStride(), pa, padded);
+    copyBlock(n, b.data(), b.getStride(), pb, padded);
+    strassen(padded, pa, padded, pb, padded, pc, padded, cutoff);
+    copyBlock(n, pc, padded, res.data(), n);
+    return res;
+}
+
+/**
+ * c[i] = a[i] * b[i] for the n x n products [begin, end) of a batch, N = n known at compile time
+ */
+template<int N, typename T>
+static void multiplyBatchedFixed(int begin, int end, const T *a, const T *b, T *c)
+{
+    for (int i = begin; i < end; ++i)
+    {
+        long offset = static_cast<long>(i) * N * N;
+        smallGemmKernel<N, N, N>(a + offset, b + offset, c + offset);
+    }
+}
+
+/**
+ * batched multiply for float and double
+ */
+template<typename T>
+static void multiplyBatchedT(int count, int n, const T *a, const T *b, T *c, int threads)
+{
+    if (count < 0 || n < 1)
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    long size = static_cast<long>(n) * n;
+    threads = resolveThreadCount(threads, count * size * n);
+    parallelFor(0, count, threads, [=](int begin, int end)
+    {
+        switch (n)
+        {
+            case 2:
+                multiplyBatchedFixed<2>(begin, end, a, b, c);
+                break;
+            case 3:
+                multiplyBatchedFixed<3>(begin, end, a, b, c);
+                break;
+            case 4:
+                multiplyBatchedFixed<4>(begin, end, a, b, c);
+                break;
+            default:
+                for (int i = begin; i < end; ++i)
+                {
+                    T *ci = c + i * size;
+                    std::fill(ci, ci + size, T(0));
+                    gemmAccumulate(n, n, n, a + i * size, n, b + i * size, n, ci, n);
+                }
+        }
+    });
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * Matrix multiplication with a selectable algorithm.
+ * Check dimensions valid for operation.
+ * @param a
+ * @param b
+ * @param algorithm
+ * @param cutoff sub problems of this size or smaller use the blocked kernel
+ * @return a * b
+ */
+Matrix multiply(const ConstMatrixView &a, const ConstMatrixView &b, MultiplicationAlgorithm algorithm, int cutoff)
+{
+    return multiplyT(a, b, algorithm, cutoff);
+}
+
+/**
+ * double precision version of multiply
+ * @param a
+ * @param b
+ * @param algorithm
+ * @param cutoff
+ * @return a * b
+ */
+DoubleMatrix multiply(const BasicMatrixView<const double> &a, const BasicMatrixView<const double> &b,
+                      MultiplicationAlgorithm algorithm, int cutoff)
+{
+    return multiplyT(a, b, algorithm, cutoff);
+}
+
+/**
+ * GEMV: y = a * x
+ * @param a
+ * @param x a.getCols() elements
+ * @param y a.getRows() elements, overwritten
+ */
+void gemv(const ConstMatrixView &a, const float *x, float *y)
+{
+    std::fill(y, y + a.getRows(), 0.f);
+    gemvAccumulate(a.getRows(), a.getCols(), a.data(), a.getStride(), x, 1, y);
+}
+
+/**
+ * double precision GEMV
+ * @param a
+ * @param x
+ * @param y
+ */
+void gemv(const BasicMatrixView<const double> &a, const double *x, double *y)
+{
+    std::fill(y, y + a.getRows(), 0.);
+    gemvAccumulate(a.getRows(), a.getCols(), a.data(), a.getStride(), x, 1, y);
+}
+
+/**
+ * transposed GEMV: y = a^T * x
+ * @param a
+ * @param x a.getRows() elements
+ * @param y a.getCols() elements, overwritten
+ */
+void gemvTransposed(const ConstMatrixView &a, const float *x, float *y)
+{
+    std::fill(y, y + a.getCols(), 0.f);
+    gemvTAccumulate(a.getRows(), a.getCols(), a.data(), a.getStride(), x, 1, y);
+}
+
+/**
+ * double precision transposed GEMV
+ * @param a
+ * @param x
+ * @param y
+ */
+void gemvTransposed(const BasicMatrixView<const double> &a, const double *x, double *y)
+{
+    std::fill(y, y + a.getCols(), 0.);
+    gemvTAccumulate(a.getRows(), a.getCols(), a.data(), a.getStride(), x, 1, y);
+}
+
+/**
+ * batched multiplication of small square matrices: c[i] = a[i] * b[i]
+ * @param count
+ * @param n
+ * @param a
+ * @param b
+ * @param c
+ * @param threads
+ */
+void multiplyBatched(int count, int n, const float *a, const float *b, float *c, int threads)
+{
+    multiplyBatchedT(count, n, a, b, c, threads);
+}
+
+/**
+ * double precision batched multiplication
+ * @param count
+ * @param n
+ * @param a
+ * @param b
+ * @param c
+ * @param threads
+ */
+void multiplyBatched(int count, int n, const double *a, const double *b, double *c, int threads)
+{
+    multiplyBatchedT(count, n, a, b, c, threads);
+}
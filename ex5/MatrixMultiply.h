@@ -0,0 +1,135 @@
+
+
+#ifndef EX5_MATRIXMULTIPLY_H
+
+// ------------------------------ includes ------------------------------
+
+#include "Matrix.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_MATRIXMULTIPLY_H
+/**
+ * sub problems of this size (or smaller) are handed to the blocked kernel by strassen
+ */
+#define STRASSEN_CUTOFF 128
+/**
+ * smallest square size MultiplicationAlgorithm::Auto runs strassen on
+ */
+#define STRASSEN_AUTO_MIN_SIZE 1024
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * algorithm used by multiply()
+ */
+enum class MultiplicationAlgorithm
+{
+    /**
+     * the cache blocked O(n^3) kernel behind operator*
+     */
+    Classical,
+    /**
+     * strassen-winograd recursion (7 multiplications and 15 additions per level),
+     * square operands only - anything else runs Classical
+     */
+    Strassen,
+    /**
+     * Strassen for square operands of at least STRASSEN_AUTO_MIN_SIZE, Classical otherwise
+     */
+    Auto
+};
+
+/**
+ * Matrix multiplication with a selectable algorithm.
+ * Check dimensions valid for operation.
+ *
+ * error bounds (u = unit roundoff, 2^-24 for float, n0 = the size the recursion stops at):
+ *  Classical:  |C - C'| <= n u |A||B|                                   (elementwise)
+ *  Strassen:   ||C - C'|| <= [(n/n0)^log2(18) (n0^2 + 6 n0) - 6n] u ||A|| ||B||   (max norm)
+ *              (Higham, Accuracy and Stability of Numerical Algorithms, ch. 23)
+ * i.e the error grows like n^4.17 instead of n and is a normwise, not componentwise, bound -
+ * results are close in norm but small entries of C can lose all their relative accuracy.
+ * a larger cutoff means fewer levels and a smaller error.
+ * @param a
+ * @param b
+ * @param algorithm
+ * @param cutoff sub problems of this size or smaller use the blocked kernel
+ * @return a * b
+ */
+Matrix multiply(const ConstMatrixView &a, const ConstMatrixView &b,
+                MultiplicationAlgorithm algorithm = MultiplicationAlgorithm::Auto, int cutoff = STRASSEN_CUTOFF);
+
+/**
+ * double precision version of multiply (unit roundoff 2^-53)
+ * @param a
+ * @param b
+ * @param algorithm
+ * @param cutoff
+ * @return a * b
+ */
+DoubleMatrix multiply(const BasicMatrixView<const double> &a, const BasicMatrixView<const double> &b,
+                      MultiplicationAlgorithm algorithm = MultiplicationAlgorithm::Auto,
+                      int cutoff = STRASSEN_CUTOFF);
+
+/**
+ * GEMV: y = a * x, written into the caller's buffer (nothing is allocated).
+ * x has a.getCols() elements and y a.getRows(); y is overwritten.
+ * results are identical to a * (x as a column matrix).
+ * @param a
+ * @param x
+ * @param y
+ */
+void gemv(const ConstMatrixView &a, const float *x, float *y);
+
+/**
+ * double precision GEMV
+ * @param a
+ * @param x
+ * @param y
+ */
+void gemv(const BasicMatrixView<const double> &a, const double *x, double *y);
+
+/**
+ * transposed GEMV: y = a^T * x, without materializing the transpose.
+ * x has a.getRows() elements and y a.getCols(); y is overwritten.
+ * @param a
+ * @param x
+ * @param y
+ */
+void gemvTransposed(const ConstMatrixView &a, const float *x, float *y);
+
+/**
+ * double precision transposed GEMV
+ * @param a
+ * @param x
+ * @param y
+ */
+void gemvTransposed(const BasicMatrixView<const double> &a, const double *x, double *y);
+
+/**
+ * batched multiplication of small square matrices: c[i] = a[i] * b[i] for i < count.
+ * every operand is an n x n row major matrix and the batches are stored back to back
+ * (a[i] starts at a + i * n * n). n = 2, 3 and 4 run compile time sized, fully unrolled kernels;
+ * other sizes run the blocked kernel per product.
+ * @param count number of products
+ * @param n size of every matrix
+ * @param a
+ * @param b
+ * @param c count * n * n elements, overwritten
+ * @param threads 0 - defaultThreadCount(), small batches run on the calling thread only
+ */
+void multiplyBatched(int count, int n, const float *a, const float *b, float *c, int threads = 0);
+
+/**
+ * double precision batched multiplication
+ * @param count
+ * @param n
+ * @param a
+ * @param b
+ * @param c
+ * @param threads
+ */
+void multiplyBatched(int count, int n, const double *a, const double *b, double *c, int threads = 0);
+
+#endif //EX5_MATRIXMULTIPLY_H
@@ -0,0 +1,467 @@
+
+// ------------------------------ includes ------------------------------
+#include "MatrixReductions.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// ------------------------------ const & macros -----------------------------
+
+/**
+ * length of the leaves of the pairwise summation tree
+ */
+#define PAIRWISE_BLOCK 256
+/**
+ * independent accumulators of a pairwise leaf (one vector register of floats)
+ */
+#define PAIRWISE_LANES 8
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * splits a view (or two views of the same shape) into the segments reductions work on:
+ * REDUCTION_SEGMENT sized chunks of the element array when everything is contiguous, one segment
+ * per row otherwise.
+ */
+struct Segments
+{
+    bool flat;
+    long total;
+    int count;
+
+    Segments(int rows, int cols, bool contiguous) : flat(contiguous),
+                                                    total(static_cast<long>(rows) * cols),
+                                                    count(contiguous ? static_cast<int>(
+                                                            (total + REDUCTION_SEGMENT - 1) / REDUCTION_SEGMENT)
+                                                                     : rows)
+    {
+
+    }
+
+    /**
+     * first element of segment s of m
+     */
+    template<typename T>
+    const T *begin(const BasicMatrixView<const T> &m, int s) const
+    {
+        return this->flat ? m.data() + static_cast<long>(s) * REDUCTION_SEGMENT : m.row_ptr(s);
+    }
+
+    /**
+     * length of segment s (cols - the row length of the views)
+     */
+    long length(int s, int cols) const
+    {
+        return this->flat ? std::min<long>(REDUCTION_SEGMENT, this->total - static_cast<long>(s) * REDUCTION_SEGMENT)
+                          : cols;
+    }
+};
+
+/**
+ * pairwise sum of term(i) for i in [begin, end).
+ * leaves of PAIRWISE_BLOCK terms use PAIRWISE_LANES interleaved accumulators (the compiler keeps
+ * them in one vector register), leaves are added as a balanced binary tree.
+ */
+template<typename A, typename Term>
+static A pairwiseSum(long begin, long end, const Term &term)
+{
+    long n = end - begin;
+    if (n > PAIRWISE_BLOCK)
+    {
+        long half = (n / 2 + PAIRWISE_LANES - 1) / PAIRWISE_LANES * PAIRWISE_LANES;
+        return pairwiseSum<A>(begin, begin + half, term) + pairwiseSum<A>(begin + half, end, term);
+    }
+    A lanes[PAIRWISE_LANES] = {};
+    long i = begin;
+    for (; i + PAIRWISE_LANES <= end; i += PAIRWISE_LANES)
+    {
+        for (int l = 0; l < PAIRWISE_LANES; ++l)
+        {
+            lanes[l] += term(i + l);
+        }
+    }
+    for (int l = 0; i < end; ++i, ++l)
+    {
+        lanes[l] += term(i);
+    }
+    for (int width = PAIRWISE_LANES / 2; width > 0; width /= 2)
+    {
+        for (int l = 0; l < width; ++l)
+        {
+            lanes[l] += lanes[l + width];
+        }
+    }
+    return lanes[0];
+}
+
+/**
+ * Kahan compensated sum of term(i) for i in [begin, end)
+ */
+template<typename A, typename Term>
+static A kahanSum(long begin, long end, const Term &term)
+{
+    A total = 0;
+    A compensation = 0;
+    for (long i = begin; i < end; ++i)
+    {
+        A y = static_cast<A>(term(i)) - compensation;
+        A t = total + y;
+        compensation = (t - total) - y;
+        total = t;
+    }
+    return total;
+}
+
+/**
+ * sum of term(i) over [begin, end) with the given method
+ */
+template<typename A, typename Term>
+static A methodSum(SummationMethod method, long begin, long end, const Term &term)
+{
+    return method == SummationMethod::Kahan ? kahanSum<A>(begin, end, term) : pairwiseSum<A>(begin, end, term);
+}
+
+/**
+ * sum over the segments of one or two views: every segment is reduced (in parallel) with
+ * segmentSum(s) into a double partial, the partials are summed with the same method.
+ */
+template<typename SegmentSum>
+static double reduceSegments(const Segments &segments, SummationMethod method, int threads,
+                             const SegmentSum &segmentSum)
+{
+    std::vector<double> partial(segments.count);
+    threads = resolveThreadCount(threads, segments.total);
+    parallelFor(0, segments.count, threads, [&](int sBegin, int sEnd)
+    {
+        for (int s = sBegin; s < sEnd; ++s)
+        {
+            partial[s] = segmentSum(s);
+        }
+    });
+    return methodSum<double>(method, 0, segments.count, [&](long s)
+    {
+        return partial[s];
+    });
+}
+
+/**
+ * sum of f(element) over a view
+ */
+template<typename T, typename F>
+static double transformSum(const BasicMatrixView<const T> &m, SummationMethod method, int threads, const F &f)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    Segments segments(m.getRows(), m.getCols(), m.isContiguous());
+    return reduceSegments(segments, method, threads, [&](int s)
+    {
+        const T *p = segments.begin(m, s);
+        return static_cast<double>(methodSum<ScalarType>(method, 0, segments.length(s, m.getCols()), [=](long i)
+        {
+            return f(static_cast<ScalarType>(p[i]));
+        }));
+    });
+}
+
+/**
+ * fold of the elements of a non empty view with pick(a, b) (min / max), rows split between threads
+ */
+template<typename T, typename Pick>
+static T foldElements(const BasicMatrixView<const T> &m, int threads, const Pick &pick)
+{
+    if (m.getRows() == 0 || m.getCols() == 0)
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    threads = resolveThreadCount(threads, static_cast<long>(m.getRows()) * m.getCols());
+    std::vector<T> partial(threads, m.unchecked(0, 0));
+    parallelFor(0, threads, threads, [&](int tBegin, int tEnd)
+    {
+        for (int t = tBegin; t < tEnd; ++t)
+        {
+            int rowBegin = static_cast<int>(static_cast<long>(m.getRows()) * t / threads);
+            int rowEnd = static_cast<int>(static_cast<long>(m.getRows()) * (t + 1) / threads);
+            T best = partial[t];
+            for (int r = rowBegin; r < rowEnd; ++r)
+            {
+                const T *row = m.row_ptr(r);
+                for (int c = 0; c < m.getCols(); ++c)
+                {
+                    best = pick(best, row[c]);
+                }
+            }
+            partial[t] = best;
+        }
+    });
+    T best = partial[0];
+    for (const T &val : partial)
+    {
+        best = pick(best, val);
+    }
+    return best;
+}
+
+/**
+ * largest sum of absolute values along rows (byRows) or columns
+ */
+template<typename T>
+static double maxAbsLineSum(const BasicMatrixView<const T> &m, int threads, bool byRows)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    int lines = byRows ? m.getRows() : m.getCols();
+    std::vector<double> sums(lines, 0.);
+    threads = resolveThreadCount(threads, static_cast<long>(m.getRows()) * m.getCols());
+    if (byRows)
+    {
+        parallelFor(0, m.getRows(), threads, [&](int rowBegin, int rowEnd)
+        {
+            for (int r = rowBegin; r < rowEnd; ++r)
+            {
+                const T *row = m.row_ptr(r);
+                sums[r] = pairwiseSum<ScalarType>(0, m.getCols(), [=](long c)
+                {
+                    return std::abs(static_cast<ScalarType>(row[c]));
+                });
+            }
+        });
+    }
+    else
+    {
+        // column sums: every thread adds whole rows into its own block of columns. the running sums
+        // are double - a float one stops counting exactly at 2^24 (65794 rows of 255) and drifts
+        // with the number of rows, as the pairwise row sums do not
+        parallelFor(0, m.getCols(), threads, [&](int colBegin, int colEnd)
+        {
+            double *acc = sums.data() + colBegin;
+            for (int r = 0; r < m.getRows(); ++r)
+            {
+                const T *row = m.row_ptr(r) + colBegin;
+                for (int c = 0; c < colEnd - colBegin; ++c)
+                {
+                    acc[c] += std::abs(static_cast<double>(row[c]));
+                }
+            }
+        });
+    }
+    return lines == 0 ? 0. : *std::max_element(sums.begin(), sums.end());
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * sum of all elements
+ * @param m
+ * @param method
+ * @param threads
+ * @return sum
+ */
+template<typename T>
+double sum(const BasicMatrixView<const T> &m, SummationMethod method, int threads)
+{
+    return transformSum(m, method, threads, [](typename BasicMatrix<T>::ScalarType x)
+    {
+        return x;
+    });
+}
+
+/**
+ * mean of all elements
+ * @param m
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename T>
+double mean(const BasicMatrixView<const T> &m, SummationMethod method, int threads)
+{
+    if (m.getRows() == 0 || m.getCols() == 0)
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    return sum(m, method, threads) / (static_cast<double>(m.getRows()) * m.getCols());
+}
+
+/**
+ * smallest element
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename T>
+T min(const BasicMatrixView<const T> &m, int threads)
+{
+    return foldElements(m, threads, [](T a, T b)
+    {
+        return b < a ? b : a;
+    });
+}
+
+/**
+ * largest element
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename T>
+T max(const BasicMatrixView<const T> &m, int threads)
+{
+    return foldElements(m, threads, [](T a, T b)
+    {
+        return a < b ? b : a;
+    });
+}
+
+/**
+ * position of the largest element.
+ * the maximum itself is found with the vectorizable max(), only then is it located.
+ * @param m
+ * @param threads
+ * @return (row, col)
+ */
+template<typename T>
+std::pair<int, int> argmax(const BasicMatrixView<const T> &m, int threads)
+{
+    T best = max(m, threads);
+    for (int r = 0; r < m.getRows(); ++r)
+    {
+        const T *row = m.row_ptr(r);
+        for (int c = 0; c < m.getCols(); ++c)
+        {
+            if (!(row[c] < best))
+            {
+                return std::make_pair(r, c);
+            }
+        }
+    }
+    return std::make_pair(0, 0);  // only reached when m holds NaNs
+}
+
+/**
+ * Frobenius norm
+ * @param m
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename T>
+double frobeniusNorm(const BasicMatrixView<const T> &m, SummationMethod method, int threads)
+{
+    return std::sqrt(transformSum(m, method, threads, [](typename BasicMatrix<T>::ScalarType x)
+    {
+        return x * x;
+    }));
+}
+
+/**
+ * induced L1 norm (largest absolute column sum)
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename T>
+double l1Norm(const BasicMatrixView<const T> &m, int threads)
+{
+    return maxAbsLineSum(m, threads, false);
+}
+
+/**
+ * induced L-infinity norm (largest absolute row sum)
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename T>
+double linfNorm(const BasicMatrixView<const T> &m, int threads)
+{
+    return maxAbsLineSum(m, threads, true);
+}
+
+/**
+ * dot (Frobenius inner) product
+ * @param a
+ * @param b
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename T>
+double dot(const BasicMatrixView<const T> &a, const BasicMatrixView<const T> &b, SummationMethod method,
+           int threads)
+{
+    typedef typename BasicMatrix<T>::ScalarType ScalarType;
+    if (a.getRows() != b.getRows() || a.getCols() != b.getCols())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    Segments segments(a.getRows(), a.getCols(), a.isContiguous() && b.isContiguous());
+    return reduceSegments(segments, method, threads, [&](int s)
+    {
+        const T *pa = segments.begin(a, s);
+        const T *pb = segments.begin(b, s);
+        return static_cast<double>(methodSum<ScalarType>(method, 0, segments.length(s, a.getCols()), [=](long i)
+        {
+            return static_cast<ScalarType>(pa[i]) * pb[i];
+        }));
+    });
+}
+
+/**
+ * 256 bin histogram of an 8 bit image
+ * @param image
+ * @param threads
+ * @return count of every pixel value
+ */
+Histogram histogram(const ConstByteMatrixView &image, int threads)
+{
+    threads = resolveThreadCount(threads, static_cast<long>(image.getRows()) * image.getCols());
+    // 4 sub histograms per thread
+    std::vector<long> counts(static_cast<size_t>(threads) * 4 * HISTOGRAM_BINS, 0);
+    parallelFor(0, threads, threads, [&](int tBegin, int tEnd)
+    {
+        for (int t = tBegin; t < tEnd; ++t)
+        {
+            long *sub = counts.data() + static_cast<long>(t) * 4 * HISTOGRAM_BINS;
+            int rowBegin = static_cast<int>(static_cast<long>(image.getRows()) * t / threads);
+            int rowEnd = static_cast<int>(static_cast<long>(image.getRows()) * (t + 1) / threads);
+            for (int r = rowBegin; r < rowEnd; ++r)
+            {
+                const uint8_t *row = image.row_ptr(r);
+                int c = 0;
+                for (; c + 4 <= image.getCols(); c += 4)
+                {
+                    ++sub[row[c]];
+                    ++sub[HISTOGRAM_BINS + row[c + 1]];
+                    ++sub[2 * HISTOGRAM_BINS + row[c + 2]];
+                    ++sub[3 * HISTOGRAM_BINS + row[c + 3]];
+                }
+                for (; c < image.getCols(); ++c)
+                {
+                    ++sub[row[c]];
+                }
+            }
+        }
+    });
+    Histogram res{};
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        res[i % HISTOGRAM_BINS] += counts[i];
+    }
+    return res;
+}
+
+#define INSTANTIATE_MATRIX_REDUCTIONS(T) \
+    template double sum<T>(const BasicMatrixView<const T> &m, SummationMethod method, int threads); \
+    template double mean<T>(const BasicMatrixView<const T> &m, SummationMethod method, int threads); \
+    template T min<T>(const BasicMatrixView<const T> &m, int threads); \
+    template T max<T>(const BasicMatrixView<const T> &m, int threads); \
+    template std::pair<int, int> argmax<T>(const BasicMatrixView<const T> &m, int threads); \
+    template double frobeniusNorm<T>(const BasicMatrixView<const T> &m, SummationMethod method, int threads); \
+    template double l1Norm<T>(const BasicMatrixView<const T> &m, int threads); \
+    template double linfNorm<T>(const BasicMatrixView<const T> &m, int threads); \
+    template double dot<T>(const BasicMatrixView<const T> &a, const BasicMatrixView<const T> &b, \
+                        SummationMethod method, int threads);
+
+INSTANTIATE_MATRIX_REDUCTIONS(float)
+INSTANTIATE_MATRIX_REDUCTIONS(double)
+INSTANTIATE_MATRIX_REDUCTIONS(uint8_t)
+INSTANTIATE_MATRIX_REDUCTIONS(int8_t)
@@ -0,0 +1,271 @@
+
+
+#ifndef EX5_MATRIXREDUCTIONS_H
+
+// ------------------------------ includes ------------------------------
+
+#include <array>
+#include <utility>
+#include "Matrix.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_MATRIXREDUCTIONS_H
+/**
+ * number of bins of an 8 bit histogram
+ */
+#define HISTOGRAM_BINS 256
+/**
+ * contiguous data is reduced in segments of this many elements (one per row otherwise).
+ * segments are the unit of work of the threads and are fixed by the data alone, so results do not
+ * depend on the number of threads.
+ */
+#define REDUCTION_SEGMENT 16384
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * summation algorithm of the sum-like reductions
+ */
+enum class SummationMethod
+{
+    /**
+     * pairwise (cascade) summation: blocks summed with 8 independent (vectorizable) accumulators,
+     * blocks added as a balanced tree. error grows like log2(n) instead of n, at plain loop speed.
+     */
+    Pairwise,
+    /**
+     * Kahan compensated summation: error independent of n, about 4x the work of a plain loop.
+     */
+    Kahan
+};
+
+/**
+ * bin counts of an 8 bit image
+ */
+typedef std::array<long, HISTOGRAM_BINS> Histogram;
+
+/**
+ * sum of all elements
+ * @param m matrix or view
+ * @param method
+ * @param threads 0 - defaultThreadCount(), small matrices run on the calling thread only
+ * @return sum
+ */
+template<typename T>
+double sum(const BasicMatrixView<const T> &m, SummationMethod method = SummationMethod::Pairwise, int threads = 0);
+
+/**
+ * mean of all elements
+ * Check m is not empty.
+ * @param m
+ * @param method
+ * @param threads
+ * @return sum / (rows * cols)
+ */
+template<typename T>
+double mean(const BasicMatrixView<const T> &m, SummationMethod method = SummationMethod::Pairwise, int threads = 0);
+
+/**
+ * smallest element
+ * Check m is not empty.
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename T>
+T min(const BasicMatrixView<const T> &m, int threads = 0);
+
+/**
+ * largest element
+ * Check m is not empty.
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename T>
+T max(const BasicMatrixView<const T> &m, int threads = 0);
+
+/**
+ * position of the largest element (the first one in row major order on ties)
+ * Check m is not empty.
+ * @param m
+ * @param threads
+ * @return (row, col)
+ */
+template<typename T>
+std::pair<int, int> argmax(const BasicMatrixView<const T> &m, int threads = 0);
+
+/**
+ * Frobenius norm: sqrt of the sum of squares of all elements
+ * @param m
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename T>
+double frobeniusNorm(const BasicMatrixView<const T> &m, SummationMethod method = SummationMethod::Pairwise,
+                     int threads = 0);
+
+/**
+ * induced L1 norm: the largest sum of absolute values of a column
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename T>
+double l1Norm(const BasicMatrixView<const T> &m, int threads = 0);
+
+/**
+ * induced L-infinity norm: the largest sum of absolute values of a row
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename T>
+double linfNorm(const BasicMatrixView<const T> &m, int threads = 0);
+
+/**
+ * dot (Frobenius inner) product: sum of a(i,j) * b(i,j)
+ * Check dimensions valid for operation (same shape).
+ * @param a
+ * @param b
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename T>
+double dot(const BasicMatrixView<const T> &a, const BasicMatrixView<const T> &b,
+           SummationMethod method = SummationMethod::Pairwise, int threads = 0);
+
+/**
+ * the overloads below take anything with a read only view of its elements - Matrix, writable
+ * views, FixedMatrix - (template argument deduction does not look through conversions).
+ */
+
+/**
+ * sum of all elements of a matrix (or writable view, FixedMatrix)
+ * @param m
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename M, typename T = typename M::ElementType>
+inline double sum(const M &m, SummationMethod method = SummationMethod::Pairwise, int threads = 0)
+{
+    return sum(BasicMatrixView<const T>(m), method, threads);
+}
+
+/**
+ * mean of all elements of a matrix (or writable view, FixedMatrix)
+ * @param m
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename M, typename T = typename M::ElementType>
+inline double mean(const M &m, SummationMethod method = SummationMethod::Pairwise, int threads = 0)
+{
+    return mean(BasicMatrixView<const T>(m), method, threads);
+}
+
+/**
+ * smallest element of a matrix (or writable view, FixedMatrix)
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename M, typename T = typename M::ElementType>
+inline T min(const M &m, int threads = 0)
+{
+    return min(BasicMatrixView<const T>(m), threads);
+}
+
+/**
+ * largest element of a matrix (or writable view, FixedMatrix)
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename M, typename T = typename M::ElementType>
+inline T max(const M &m, int threads = 0)
+{
+    return max(BasicMatrixView<const T>(m), threads);
+}
+
+/**
+ * position of the largest element of a matrix (or writable view, FixedMatrix)
+ * @param m
+ * @param threads
+ * @return (row, col)
+ */
+template<typename M, typename T = typename M::ElementType>
+inline std::pair<int, int> argmax(const M &m, int threads = 0)
+{
+    return argmax(BasicMatrixView<const T>(m), threads);
+}
+
+/**
+ * Frobenius norm of a matrix (or writable view, FixedMatrix)
+ * @param m
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename M, typename T = typename M::ElementType>
+inline double frobeniusNorm(const M &m, SummationMethod method = SummationMethod::Pairwise,
+                            int threads = 0)
+{
+    return frobeniusNorm(BasicMatrixView<const T>(m), method, threads);
+}
+
+/**
+ * induced L1 norm of a matrix (or writable view, FixedMatrix)
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename M, typename T = typename M::ElementType>
+inline double l1Norm(const M &m, int threads = 0)
+{
+    return l1Norm(BasicMatrixView<const T>(m), threads);
+}
+
+/**
+ * induced L-infinity norm of a matrix (or writable view, FixedMatrix)
+ * @param m
+ * @param threads
+ * @return
+ */
+template<typename M, typename T = typename M::ElementType>
+inline double linfNorm(const M &m, int threads = 0)
+{
+    return linfNorm(BasicMatrixView<const T>(m), threads);
+}
+
+/**
+ * dot product of two matrices (or writable views, FixedMatrix)
+ * @param a
+ * @param b
+ * @param method
+ * @param threads
+ * @return
+ */
+template<typename M, typename T = typename M::ElementType>
+inline double dot(const M &a, const M &b,
+                  SummationMethod method = SummationMethod::Pairwise, int threads = 0)
+{
+    return dot(BasicMatrixView<const T>(a), BasicMatrixView<const T>(b), method, threads);
+}
+
+/**
+ * 256 bin histogram of an 8 bit image.
+ * counts go to 4 interleaved sub histograms (so runs of equal pixels do not serialize on one
+ * counter) that are added at the end; threads count their own rows.
+ * @param image
+ * @param threads
+ * @return count of every pixel value
+ */
+Histogram histogram(const ConstByteMatrixView &image, int threads = 0);
+
+#endif //EX5_MATRIXREDUCTIONS_H
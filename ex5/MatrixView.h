@@ -0,0 +1,449 @@
+
+
+#ifndef EX5_MATRIXVIEW_H
+#define EX5_MATRIXVIEW_H
+
+// ------------------------------ includes ------------------------------
+
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+#include "Matrix.h"
+
+// ------------------------------ functions -----------------------------
+
+/**
+ *  non owning view of a (sub) matrix - pointer, rows, cols and row stride.
+ *  a view never allocates or frees memory, the memory it references must outlive it.
+ *  T may be const qualified (BasicMatrixView<const float>) for read only views,
+ *  a mutable view converts implicitly to a read only one.
+ * @tparam T element type
+ */
+template<typename T>
+class BasicMatrixView
+{
+public:
+    /**
+     * element type without const
+     */
+    typedef typename std::remove_const<T>::type ElementType;
+    /**
+     * read only view of the same elements
+     */
+    typedef BasicMatrixView<const ElementType> ConstView;
+
+private:
+
+    T *_data;
+    int _rows, _cols, _stride;
+
+public:
+    /**
+     * Constructor
+     * view over external memory, row i starts at data + i * stride.
+     * @param data
+     * @param rows
+     * @param cols
+     * @param stride distance (in elements) between the starts of two rows, at least cols
+     */
+    BasicMatrixView(T *data, int rows, int cols, int stride) : _data(data), _rows(rows), _cols(cols), _stride(stride)
+    {
+        if (_rows < 0 || _cols < 0 || _stride < _cols)
+        {
+            matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+        }
+    }
+
+    /**
+     * Constructor
+     * view over contiguous external memory (stride == cols)
+     * @param data
+     * @param rows
+     * @param cols
+     */
+    BasicMatrixView(T *data, int rows, int cols) : BasicMatrixView(data, rows, cols, cols)
+    {
+    }
+
+    /**
+     * mutable -> read only conversion
+     * @param other
+     */
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U *, T *>::value>::type>
+    BasicMatrixView(const BasicMatrixView<U> &other) :
+            _data(other.data()), _rows(other.getRows()), _cols(other.getCols()), _stride(other.getStride())
+    {
+    }
+
+    /**
+     * Returns the amount of rows (int).
+     * @return
+     */
+    int getRows() const
+    {
+        return _rows;
+    }
+
+    /**
+     * Returns the amount of columns (int).
+     * @return
+     */
+    int getCols() const
+    {
+        return _cols;
+    }
+
+    /**
+     * Returns the distance (in elements) between the starts of two consecutive rows
+     * @return
+     */
+    int getStride() const
+    {
+        return _stride;
+    }
+
+    /**
+     * Returns pointer to the first element
+     * @return
+     */
+    T *data() const
+    {
+        return _data;
+    }
+
+    /**
+     * true if rows follow each other with no gap (stride == cols)
+     * @return
+     */
+    bool isContiguous() const
+    {
+        return _stride == _cols || _rows <= 1;
+    }
+
+    /**
+     * Returns pointer to the first element of row i.
+     * unchecked (checked only when MATRIX_DEBUG_CHECKS is on).
+     * @param i
+     * @return
+     */
+    T *row_ptr(int i) const
+    {
+        MATRIX_DEBUG_CHECK(i >= 0 && i < _rows, IDX_OUT_OF_RANGE);
+        return _data + static_cast<long>(i) * _stride;
+    }
+
+    /**
+     * element (i, j) without the bounds check of operator().
+     * checked only when MATRIX_DEBUG_CHECKS is on.
+     * @param i
+     * @param j
+     * @return
+     */
+    T &unchecked(int i, int j) const
+    {
+        MATRIX_DEBUG_CHECK(i >= 0 && j >= 0 && i < _rows && j < _cols, IDX_OUT_OF_RANGE);
+        return _data[static_cast<long>(i) * _stride + j];
+    }
+
+    /**
+     * the rows of the view, for (auto row : v.rows()) { ... }
+     * @return
+     */
+    BasicRowRange<T> rows() const
+    {
+        return BasicRowRange<T>(_data, _rows, _cols, _stride);
+    }
+
+    /**
+     * Parenthesis indexing
+     * Check indexes are in valid ranges.
+     * @param i
+     * @param j
+     * @return ref to the element
+     */
+    T &operator()(int i, int j) const
+    {
+        if (i < 0 || j < 0 || i > (_rows - 1) || j > (_cols - 1))
+        {
+            matrixError<std::out_of_range>(IDX_OUT_OF_RANGE);
+        }
+        return _data[static_cast<long>(i) * _stride + j];
+    }
+
+    /**
+     * sub block of this view, no copy is made.
+     * Check the block is inside the view.
+     * @param row first row of the block
+     * @param col first col of the block
+     * @param rows
+     * @param cols
+     * @return
+     */
+    BasicMatrixView block(int row, int col, int rows, int cols) const
+    {
+        if (row < 0 || col < 0 || rows < 0 || cols < 0 || row + rows > _rows || col + cols > _cols)
+        {
+            matrixError<std::out_of_range>(IDX_OUT_OF_RANGE);
+        }
+        return BasicMatrixView(_data + static_cast<long>(row) * _stride + col, rows, cols, _stride);
+    }
+
+    /**
+     * single row of this view
+     * @param i
+     * @return 1 x cols view
+     */
+    BasicMatrixView row(int i) const
+    {
+        return block(i, 0, 1, _cols);
+    }
+
+    /**
+     * copies src into the viewed elements (only available on writable views).
+     * Check dimensions valid for operation.
+     * @param src
+     */
+    template<typename U = T, typename = typename std::enable_if<!std::is_const<U>::value>::type>
+    void copyFrom(const ConstView &src) const
+    {
+        if (_rows != src.getRows() || _cols != src.getCols())
+        {
+            matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+        }
+        for (int i = 0; i < _rows; ++i)
+        {
+            const ElementType *srcRow = src.data() + static_cast<long>(i) * src.getStride();
+            T *dstRow = _data + static_cast<long>(i) * _stride;
+            for (int j = 0; j < _cols; ++j)
+            {
+                dstRow[j] = srcRow[j];
+            }
+        }
+    }
+
+    /**
+     * Matrix multiplication
+     * Check dimensions valid for operation.
+     * @param rhs
+     * @return new matrix
+     */
+    BasicMatrix<ElementType> operator*(const ConstView &rhs) const;
+
+    /**
+     * Scalar mult. On the right
+     * @param c
+     * @return new matrix
+     */
+    BasicMatrix<ElementType> operator*(typename MatrixElementTraits<ElementType>::AccumType c) const;
+
+    /**
+     * Matrix addition
+     * Check dimensions valid for operation.
+     * @param rhs
+     * @return new matrix
+     */
+    BasicMatrix<ElementType> operator+(const ConstView &rhs) const;
+
+    /**
+     * Equality
+     * @param rhs
+     * @return true if views have the same dimensions and values
+     */
+    bool operator==(const ConstView &rhs) const;
+
+    /**
+     * Not equal
+     * @param rhs
+     * @return true if views differ
+     */
+    bool operator!=(const ConstView &rhs) const;
+};
+
+/**
+ *  iterator over the rows of a matrix or view, dereferences to a 1 x cols view of the row
+ * @tparam T element type (may be const)
+ */
+template<typename T>
+class BasicRowIterator
+{
+private:
+
+    T *_row;
+    int _cols, _stride;
+
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef BasicMatrixView<T> value_type;
+    typedef long difference_type;
+    typedef const BasicMatrixView<T> *pointer;
+    typedef BasicMatrixView<T> reference;
+
+    /**
+     * Constructor
+     * @param row first element of the row pointed to
+     * @param cols
+     * @param stride distance between two rows
+     */
+    BasicRowIterator(T *row, int cols, int stride) : _row(row), _cols(cols), _stride(stride)
+    {
+    }
+
+    /**
+     * @return view of the current row
+     */
+    BasicMatrixView<T> operator*() const
+    {
+        return BasicMatrixView<T>(_row, 1, _cols, _cols);
+    }
+
+    /**
+     * next row
+     * @return
+     */
+    BasicRowIterator &operator++()
+    {
+        _row += _stride;
+        return *this;
+    }
+
+    /**
+     * next row (postfix)
+     * @return
+     */
+    BasicRowIterator operator++(int)
+    {
+        BasicRowIterator prev = *this;
+        _row += _stride;
+        return prev;
+    }
+
+    /**
+     * previous row
+     * @return
+     */
+    BasicRowIterator &operator--()
+    {
+        _row -= _stride;
+        return *this;
+    }
+
+    /**
+     * previous row (postfix)
+     * @return
+     */
+    BasicRowIterator operator--(int)
+    {
+        BasicRowIterator prev = *this;
+        _row -= _stride;
+        return prev;
+    }
+
+    /**
+     * @param rhs
+     * @return true if both point to the same row
+     */
+    bool operator==(const BasicRowIterator &rhs) const
+    {
+        return _row == rhs._row;
+    }
+
+    /**
+     * @param rhs
+     * @return true if they point to different rows
+     */
+    bool operator!=(const BasicRowIterator &rhs) const
+    {
+        return _row != rhs._row;
+    }
+};
+
+/**
+ *  range of the rows of a matrix or view (begin / end), used in range based for loops
+ * @tparam T element type (may be const)
+ */
+template<typename T>
+class BasicRowRange
+{
+private:
+
+    T *_data;
+    int _rows, _cols, _stride;
+
+public:
+    /**
+     * Constructor
+     * @param data
+     * @param rows
+     * @param cols
+     * @param stride
+     */
+    BasicRowRange(T *data, int rows, int cols, int stride) : _data(data), _rows(rows), _cols(cols), _stride(stride)
+    {
+    }
+
+    /**
+     * @return iterator to the first row
+     */
+    BasicRowIterator<T> begin() const
+    {
+        return BasicRowIterator<T>(_data, _cols, _stride);
+    }
+
+    /**
+     * @return iterator past the last row
+     */
+    BasicRowIterator<T> end() const
+    {
+        return BasicRowIterator<T>(_data + static_cast<long>(_rows) * _stride, _cols, _stride);
+    }
+};
+
+/**
+ * the rows of the matrix, for (View row : m.rows()) { ... }
+ * @return
+ */
+template<typename T>
+inline BasicRowRange<T> BasicMatrix<T>::rows()
+{
+    return BasicRowRange<T>(_mat, _rows, _cols, _cols);
+}
+
+/**
+ * the rows of the matrix as read only views
+ * @return
+ */
+template<typename T>
+inline BasicRowRange<const T> BasicMatrix<T>::rows() const
+{
+    return BasicRowRange<const T>(_mat, _rows, _cols, _cols);
+}
+
+/**
+ * Output stream, same format as Matrix
+ * @param rhs
+ * @return updated output stream
+ */
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicMatrixView<T> &rhs);
+
+/**
+ * writable view of a float matrix
+ */
+typedef BasicMatrixView<float> MatrixView;
+
+/**
+ * read only view of a float matrix
+ */
+typedef BasicMatrixView<const float> ConstMatrixView;
+
+/**
+ * writable view of an 8 bit image
+ */
+typedef BasicMatrixView<uint8_t> ByteMatrixView;
+
+/**
+ * read only view of an 8 bit image
+ */
+typedef BasicMatrixView<const uint8_t> ConstByteMatrixView;
+
+#endif //EX5_MATRIXVIEW_H
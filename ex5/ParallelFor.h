@@ -0,0 +1,109 @@
+
+
+#ifndef EX5_PARALLELFOR_H
+
+// ------------------------------ includes ------------------------------
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_PARALLELFOR_H
+/**
+ * below this many elements of work a loop is not worth splitting between threads
+ */
+#define PARALLEL_MIN_WORK 32768
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * number of threads to use when the caller asks for the default (0)
+ * @return hardware concurrency, at least 1
+ */
+inline int defaultThreadCount()
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+/**
+ * resolves a requested thread count: 0 (or less) means defaultThreadCount(), and small jobs run
+ * on the calling thread only.
+ * @param threads requested threads
+ * @param work amount of work (elements, non zeros...) the loop does
+ * @return threads to use, at least 1
+ */
+inline int resolveThreadCount(int threads, long work)
+{
+    if (threads <= 0)
+    {
+        threads = defaultThreadCount();
+    }
+    if (work < PARALLEL_MIN_WORK)
+    {
+        return 1;
+    }
+    return static_cast<int>(std::min<long>(threads, std::max<long>(1, work / (PARALLEL_MIN_WORK / 4))));
+}
+
+/**
+ * splits [begin, end) into `threads` contiguous chunks and calls body(chunkBegin, chunkEnd) for
+ * each, one chunk on the calling thread and the rest on std::threads. returns when all are done.
+ * chunks are disjoint, so bodies writing only to their own rows need no locking.
+ * an exception thrown by a body is rethrown here after every thread was joined.
+ * @param begin
+ * @param end
+ * @param threads number of chunks (already resolved, >= 1)
+ * @param body callable(int chunkBegin, int chunkEnd)
+ */
+template<typename Body>
+void parallelFor(int begin, int end, int threads, const Body &body)
+{
+    int count = end - begin;
+    threads = std::max(1, std::min(threads, count));
+    if (threads == 1)
+    {
+        if (count > 0)
+        {
+            body(begin, end);
+        }
+        return;
+    }
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    auto run = [&](int t)
+    {
+        int chunkBegin = begin + static_cast<int>(static_cast<long>(count) * t / threads);
+        int chunkEnd = begin + static_cast<int>(static_cast<long>(count) * (t + 1) / threads);
+        try
+        {
+            body(chunkBegin, chunkEnd);
+        }
+        catch (...)
+        {
+            errors[t] = std::current_exception();
+        }
+    };
+    for (int t = 1; t < threads; ++t)
+    {
+        workers.emplace_back(run, t);
+    }
+    run(0);
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+#endif //EX5_PARALLELFOR_H
@@ -0,0 +1,430 @@
+
+// ------------------------------ includes ------------------------------
+#include "SparseMatrix.h"
+#include "ParallelFor.h"
+#include <algorithm>
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * y[row] = sum of the non zeros of CSR rows [rowBegin, rowEnd) times x
+ */
+template<typename T, typename A>
+static void csrRowsTimesVector(int rowBegin, int rowEnd, const long *offsets, const int *indices,
+                               const T *values, const T *x, T *y)
+{
+    for (int r = rowBegin; r < rowEnd; ++r)
+    {
+        A sum = 0;
+        for (long p = offsets[r]; p < offsets[r + 1]; ++p)
+        {
+            sum += static_cast<A>(values[p]) * x[indices[p]];
+        }
+        y[r] = static_cast<T>(sum);
+    }
+}
+
+/**
+ * res[row, :] = sum of value * b[col, :] over the non zeros of CSR rows [rowBegin, rowEnd)
+ */
+template<typename T>
+static void csrRowsTimesDense(int rowBegin, int rowEnd, const long *offsets, const int *indices,
+                              const T *values, const BasicMatrixView<const T> &b, BasicMatrix<T> &res)
+{
+    int n = b.getCols();
+    for (int r = rowBegin; r < rowEnd; ++r)
+    {
+        T *resRow = res.row_ptr(r);
+        for (long p = offsets[r]; p < offsets[r + 1]; ++p)
+        {
+            const T v = values[p];
+            const T *bRow = b.row_ptr(indices[p]);
+            for (int j = 0; j < n; ++j)
+            {
+                resRow[j] += v * bRow[j];
+            }
+        }
+    }
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * number of compressed lines (rows for CSR, columns for CSC)
+ */
+template<typename T>
+int BasicSparseMatrix<T>::_lineCount() const
+{
+    return this->_format == SparseFormat::CSR ? this->_rows : this->_cols;
+}
+
+/**
+ * Constructor
+ * Constructs an all zero rows * cols sparse matrix (no non zeros stored).
+ * @param rows
+ * @param cols
+ * @param format
+ */
+template<typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(int rows, int cols, SparseFormat format) : _rows(rows), _cols(cols),
+                                                                                   _format(format)
+{
+    if (rows < 0 || cols < 0)
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    this->_offsets.assign(this->_lineCount() + 1, 0);
+}
+
+/**
+ * Constructor
+ * compresses a dense matrix (or view), keeping the elements that are not 0.
+ * two passes: count the non zeros of every line, then place them.
+ * @param dense
+ * @param format
+ */
+template<typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(const BasicMatrixView<const T> &dense, SparseFormat format) :
+        BasicSparseMatrix(dense.getRows(), dense.getCols(), format)
+{
+    bool csr = format == SparseFormat::CSR;
+    for (int i = 0; i < this->_rows; ++i)
+    {
+        const T *row = dense.row_ptr(i);
+        for (int j = 0; j < this->_cols; ++j)
+        {
+            if (row[j] != T(0))
+            {
+                ++this->_offsets[(csr ? i : j) + 1];
+            }
+        }
+    }
+    for (int l = 0; l < this->_lineCount(); ++l)
+    {
+        this->_offsets[l + 1] += this->_offsets[l];
+    }
+    this->_indices.resize(this->_offsets.back());
+    this->_values.resize(this->_offsets.back());
+
+    std::vector<long> next(this->_offsets.begin(), this->_offsets.end() - 1);
+    for (int i = 0; i < this->_rows; ++i)
+    {
+        const T *row = dense.row_ptr(i);
+        for (int j = 0; j < this->_cols; ++j)
+        {
+            if (row[j] != T(0))
+            {
+                long p = next[csr ? i : j]++;
+                this->_indices[p] = csr ? j : i;
+                this->_values[p] = row[j];
+            }
+        }
+    }
+}
+
+/**
+ * @return amount of rows
+ */
+template<typename T>
+int BasicSparseMatrix<T>::getRows() const
+{
+    return this->_rows;
+}
+
+/**
+ * @return amount of cols
+ */
+template<typename T>
+int BasicSparseMatrix<T>::getCols() const
+{
+    return this->_cols;
+}
+
+/**
+ * @return storage format
+ */
+template<typename T>
+SparseFormat BasicSparseMatrix<T>::getFormat() const
+{
+    return this->_format;
+}
+
+/**
+ * @return number of stored (non zero) elements
+ */
+template<typename T>
+long BasicSparseMatrix<T>::nonZeros() const
+{
+    return static_cast<long>(this->_values.size());
+}
+
+/**
+ * @return offsets, lines + 1 entries
+ */
+template<typename T>
+const long *BasicSparseMatrix<T>::offsets() const
+{
+    return this->_offsets.data();
+}
+
+/**
+ * @return column (CSR) / row (CSC) of every stored value
+ */
+template<typename T>
+const int *BasicSparseMatrix<T>::indices() const
+{
+    return this->_indices.data();
+}
+
+/**
+ * @return the stored values
+ */
+template<typename T>
+const T *BasicSparseMatrix<T>::values() const
+{
+    return this->_values.data();
+}
+
+/**
+ * the transpose, in the same format.
+ * counting sort of the non zeros by their index: walking the lines in order keeps every output
+ * line sorted.
+ * @return
+ */
+template<typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::transpose() const
+{
+    BasicSparseMatrix res(this->_cols, this->_rows, this->_format);
+    int lines = this->_lineCount();
+    int resLines = res._lineCount();
+    for (int idx : this->_indices)
+    {
+        ++res._offsets[idx + 1];
+    }
+    for (int l = 0; l < resLines; ++l)
+    {
+        res._offsets[l + 1] += res._offsets[l];
+    }
+    res._indices.resize(this->_values.size());
+    res._values.resize(this->_values.size());
+    std::vector<long> next(res._offsets.begin(), res._offsets.end() - 1);
+    for (int l = 0; l < lines; ++l)
+    {
+        for (long p = this->_offsets[l]; p < this->_offsets[l + 1]; ++p)
+        {
+            long q = next[this->_indices[p]]++;
+            res._indices[q] = l;
+            res._values[q] = this->_values[p];
+        }
+    }
+    return res;
+}
+
+/**
+ * the same matrix in the given format.
+ * the CSC arrays of A are the CSR arrays of A^T (and vice versa), so converting is a transpose of
+ * the arrays with the dimensions kept.
+ * @param format
+ * @return
+ */
+template<typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::convert(SparseFormat format) const
+{
+    if (format == this->_format)
+    {
+        return *this;
+    }
+    BasicSparseMatrix res = this->transpose();
+    res._rows = this->_rows;
+    res._cols = this->_cols;
+    res._format = format;
+    return res;
+}
+
+/**
+ * expands back to a dense matrix
+ * @return
+ */
+template<typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::toDense() const
+{
+    BasicMatrix<T> res(this->_rows, this->_cols);
+    bool csr = this->_format == SparseFormat::CSR;
+    for (int l = 0; l < this->_lineCount(); ++l)
+    {
+        for (long p = this->_offsets[l]; p < this->_offsets[l + 1]; ++p)
+        {
+            if (csr)
+            {
+                res.unchecked(l, this->_indices[p]) = this->_values[p];
+            }
+            else
+            {
+                res.unchecked(this->_indices[p], l) = this->_values[p];
+            }
+        }
+    }
+    return res;
+}
+
+/**
+ * SpMV: y = this * x
+ * with several threads every thread takes a contiguous range of rows holding about the same number
+ * of non zeros (binary search in the offsets), and writes only its own part of y.
+ * @param x getCols() elements
+ * @param y getRows() elements, overwritten
+ * @param threads
+ */
+template<typename T>
+void BasicSparseMatrix<T>::multiply(const T *x, T *y, int threads) const
+{
+    const long *offsets = this->_offsets.data();
+    const int *indices = this->_indices.data();
+    const T *values = this->_values.data();
+    if (this->_format == SparseFormat::CSC)
+    {
+        std::vector<ScalarType> acc(this->_rows, ScalarType(0));
+        for (int c = 0; c < this->_cols; ++c)
+        {
+            const ScalarType xc = x[c];
+            for (long p = offsets[c]; p < offsets[c + 1]; ++p)
+            {
+                acc[indices[p]] += values[p] * xc;
+            }
+        }
+        std::copy(acc.begin(), acc.end(), y);
+        return;
+    }
+    long nnz = this->nonZeros();
+    int rows = this->_rows;
+    threads = resolveThreadCount(threads, nnz + rows);
+    parallelFor(0, threads, threads, [=](int tBegin, int tEnd)
+    {
+        for (int t = tBegin; t < tEnd; ++t)
+        {
+            int rowBegin = static_cast<int>(std::upper_bound(offsets, offsets + rows, nnz * t / threads) - offsets) - 1;
+            int rowEnd = static_cast<int>(std::upper_bound(offsets, offsets + rows, nnz * (t + 1) / threads) -
+                                          offsets) - 1;
+            rowBegin = t == 0 ? 0 : rowBegin;
+            rowEnd = t == threads - 1 ? rows : rowEnd;
+            csrRowsTimesVector<T, ScalarType>(rowBegin, rowEnd, offsets, indices, values, x, y);
+        }
+    });
+}
+
+/**
+ * SpMM: this * b
+ * CSR rows are split between threads, each producing its own rows of the result.
+ * @param b
+ * @param threads
+ * @return dense result
+ */
+template<typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::multiply(const BasicMatrixView<const T> &b, int threads) const
+{
+    if (this->_cols != b.getRows())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    BasicMatrix<T> res(this->_rows, b.getCols());
+    if (b.getCols() == 1 && b.isContiguous())
+    {
+        this->multiply(b.data(), res.data(), threads);
+        return res;
+    }
+    if (this->_format == SparseFormat::CSC)
+    {
+        for (int c = 0; c < this->_cols; ++c)
+        {
+            const T *bRow = b.row_ptr(c);
+            for (long p = this->_offsets[c]; p < this->_offsets[c + 1]; ++p)
+            {
+                const T v = this->_values[p];
+                T *resRow = res.row_ptr(this->_indices[p]);
+                for (int j = 0; j < b.getCols(); ++j)
+                {
+                    resRow[j] += v * bRow[j];
+                }
+            }
+        }
+        return res;
+    }
+    const long *offsets = this->_offsets.data();
+    const int *indices = this->_indices.data();
+    const T *values = this->_values.data();
+    threads = resolveThreadCount(threads, this->nonZeros() * b.getCols());
+    parallelFor(0, this->_rows, threads, [&](int rowBegin, int rowEnd)
+    {
+        csrRowsTimesDense(rowBegin, rowEnd, offsets, indices, values, b, res);
+    });
+    return res;
+}
+
+/**
+ * SpMV / SpMM
+ * Check dimensions valid for operation.
+ * @param b
+ * @return this * b
+ */
+template<typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator*(const BasicMatrixView<const T> &b) const
+{
+    return this->multiply(b);
+}
+
+/**
+ * Matrix addition
+ * both operands have sorted lines, so every result line is a single merge.
+ * @param rhs
+ * @return this + rhs
+ */
+template<typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::operator+(const BasicSparseMatrix &rhs) const
+{
+    if (this->_rows != rhs._rows || this->_cols != rhs._cols)
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    if (rhs._format != this->_format)
+    {
+        return *this + rhs.convert(this->_format);
+    }
+    BasicSparseMatrix res(this->_rows, this->_cols, this->_format);
+    res._indices.reserve(this->_values.size() + rhs._values.size());
+    res._values.reserve(this->_values.size() + rhs._values.size());
+    for (int l = 0; l < this->_lineCount(); ++l)
+    {
+        long p = this->_offsets[l], pEnd = this->_offsets[l + 1];
+        long q = rhs._offsets[l], qEnd = rhs._offsets[l + 1];
+        while (p < pEnd || q < qEnd)
+        {
+            int idx;
+            T val;
+            if (q == qEnd || (p < pEnd && this->_indices[p] < rhs._indices[q]))
+            {
+                idx = this->_indices[p];
+                val = this->_values[p++];
+            }
+            else if (p == pEnd || rhs._indices[q] < this->_indices[p])
+            {
+                idx = rhs._indices[q];
+                val = rhs._values[q++];
+            }
+            else
+            {
+                idx = this->_indices[p];
+                val = this->_values[p++] + rhs._values[q++];
+            }
+            if (val != T(0))
+            {
+                res._indices.push_back(idx);
+                res._values.push_back(val);
+            }
+        }
+        res._offsets[l + 1] = static_cast<long>(res._values.size());
+    }
+    return res;
+}
+
+template class BasicSparseMatrix<float>;
+template class BasicSparseMatrix<double>;
@@ -0,0 +1,191 @@
+
+
+#ifndef EX5_SPARSEMATRIX_H
+
+// ------------------------------ includes ------------------------------
+
+#include <vector>
+#include "Matrix.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_SPARSEMATRIX_H
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * storage order of a sparse matrix
+ */
+enum class SparseFormat
+{
+    /**
+     * compressed sparse rows: the non zeros of every row are stored together (sorted by column).
+     * the natural format for A * x and A * B - every output row is produced by one thread.
+     */
+    CSR,
+    /**
+     * compressed sparse columns: the non zeros of every column are stored together (sorted by row).
+     * cheap column access and the CSR form of the transpose.
+     */
+    CSC
+};
+
+/**
+ *  sparse matrix in CSR or CSC form.
+ *  only the non zero elements are stored:
+ *   values  - the non zeros, one compressed line (row for CSR, column for CSC) after the other
+ *   indices - the column (CSR) / row (CSC) of each value, increasing within a line
+ *   offsets - line l holds values [offsets[l], offsets[l + 1]), offsets has lines + 1 entries
+ *  so memory and the cost of every operation are O(non zeros) rather than O(rows * cols).
+ *  T is float or double.
+ */
+template<typename T>
+class BasicSparseMatrix
+{
+public:
+    /**
+     * type of a single element
+     */
+    typedef T ElementType;
+    /**
+     * type products are accumulated in
+     */
+    typedef typename MatrixElementTraits<T>::AccumType ScalarType;
+
+private:
+
+    int _rows, _cols;
+    SparseFormat _format;
+    std::vector<long> _offsets;
+    std::vector<int> _indices;
+    std::vector<T> _values;
+
+    /**
+     * number of compressed lines (rows for CSR, columns for CSC)
+     */
+    int _lineCount() const;
+
+public:
+    /**
+     * Constructor
+     * Constructs an all zero rows * cols sparse matrix (no non zeros stored).
+     * @param rows
+     * @param cols
+     * @param format
+     */
+    BasicSparseMatrix(int rows, int cols, SparseFormat format = SparseFormat::CSR);
+
+    /**
+     * Constructor
+     * compresses a dense matrix (or view), keeping the elements that are not 0.
+     * @param dense
+     * @param format
+     */
+    explicit BasicSparseMatrix(const BasicMatrixView<const T> &dense, SparseFormat format = SparseFormat::CSR);
+
+    /**
+     * @return amount of rows
+     */
+    int getRows() const;
+
+    /**
+     * @return amount of cols
+     */
+    int getCols() const;
+
+    /**
+     * @return storage format
+     */
+    SparseFormat getFormat() const;
+
+    /**
+     * @return number of stored (non zero) elements
+     */
+    long nonZeros() const;
+
+    /**
+     * line l (row for CSR, column for CSC) has its non zeros at [offsets()[l], offsets()[l + 1])
+     * @return offsets, lines + 1 entries
+     */
+    const long *offsets() const;
+
+    /**
+     * @return column (CSR) / row (CSC) of every stored value
+     */
+    const int *indices() const;
+
+    /**
+     * @return the stored values
+     */
+    const T *values() const;
+
+    /**
+     * the same matrix in the given format (a copy when it already is in that format).
+     * converting is a counting sort over the non zeros: O(rows + cols + non zeros).
+     * @param format
+     * @return
+     */
+    BasicSparseMatrix convert(SparseFormat format) const;
+
+    /**
+     * the transpose, in the same format
+     * @return
+     */
+    BasicSparseMatrix transpose() const;
+
+    /**
+     * expands back to a dense matrix
+     * @return
+     */
+    BasicMatrix<T> toDense() const;
+
+    /**
+     * SpMV: y = this * x
+     * x has getCols() elements and y getRows(); y is overwritten.
+     * CSR rows are split between threads by number of non zeros, so skewed rows (graph hubs) do not
+     * leave threads idle. CSC scatters into y and always runs on the calling thread.
+     * @param x
+     * @param y
+     * @param threads 0 - defaultThreadCount(), small products run on the calling thread only
+     */
+    void multiply(const T *x, T *y, int threads = 0) const;
+
+    /**
+     * SpMM: this * b for a dense matrix (or view) b.
+     * Check dimensions valid for operation.
+     * every non zero scales a whole row of b into the result row, so rows are streamed.
+     * @param b
+     * @param threads 0 - defaultThreadCount(), 1 - calling thread only
+     * @return dense result
+     */
+    BasicMatrix<T> multiply(const BasicMatrixView<const T> &b, int threads = 0) const;
+
+    /**
+     * SpMV / SpMM, see multiply
+     * @param b dense matrix or view (a column for SpMV)
+     * @return this * b
+     */
+    BasicMatrix<T> operator*(const BasicMatrixView<const T> &b) const;
+
+    /**
+     * Matrix addition, merges the sorted lines of both operands.
+     * the result is in the format of this (rhs is converted if needed); elements that cancel out
+     * are not stored.
+     * Check dimensions valid for operation.
+     * @param rhs
+     * @return this + rhs
+     */
+    BasicSparseMatrix operator+(const BasicSparseMatrix &rhs) const;
+};
+
+/**
+ * single precision sparse matrix, the counterpart of Matrix
+ */
+typedef BasicSparseMatrix<float> SparseMatrix;
+
+/**
+ * double precision sparse matrix
+ */
+typedef BasicSparseMatrix<double> DoubleSparseMatrix;
+
+#endif //EX5_SPARSEMATRIX_H
@@ -0,0 +1,631 @@
+
+// ------------------------------ includes ------------------------------
+#include "TiledMatrix.h"
+#include "MatrixIO.h"
+#include "MatrixKernels.h"
+#include "ParallelFor.h"
+#include "Filters.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ------------------------------ const & macros -----------------------------
+
+/**
+ * magic bytes opening every tiled matrix file
+ */
+#define TILED_MATRIX_MAGIC "EX5T"
+/**
+ * error - a tile index outside the grid
+ */
+#define TILE_OUT_OF_RANGE "Tile index out of range.\n"
+/**
+ * error - writing through a read only mapping
+ */
+#define READ_ONLY_MAPPING "Tiled matrix is mapped read only.\n"
+
+// ------------------------------ helpers -----------------------------
+
+/**
+ * header of a tiled matrix file (the rest of TILED_MATRIX_HEADER_SIZE is zeros)
+ */
+struct TiledMatrixHeader
+{
+    char magic[4];
+    int32_t type;
+    int32_t rows, cols;
+    int32_t tileRows, tileCols;
+};
+
+/**
+ * element type code of the header: 1 - float, 2 - double (same codes as the binary format)
+ */
+template<typename T>
+static int32_t tiledTypeCode()
+{
+    return sizeof(T) == sizeof(float) ? 1 : 2;
+}
+
+/**
+ * bytes taken by the header and a rows x cols matrix of tileRows x tileCols tiles (all positive).
+ * the dimensions may come from an untrusted header, so every product is checked before it is
+ * formed: false if the file would not fit off_t, or the grid of whole tiles would reach past the
+ * int range the tile coordinates are computed in.
+ * @param rows
+ * @param cols
+ * @param tileRows
+ * @param tileCols
+ * @param size the file size
+ * @return false on overflow
+ */
+template<typename T>
+static bool tiledFileSize(int rows, int cols, int tileRows, int tileCols, size_t &size)
+{
+    const long intMax = std::numeric_limits<int>::max();
+    const size_t sizeMax = static_cast<size_t>(std::numeric_limits<off_t>::max());
+    long gridRows = (rows - 1) / tileRows + 1, gridCols = (cols - 1) / tileCols + 1;
+    if (gridRows > intMax / tileRows || gridCols > intMax / tileCols)
+    {
+        return false;
+    }
+    size_t tileBytes = static_cast<size_t>(tileRows) * static_cast<size_t>(tileCols);
+    if (tileBytes > sizeMax / sizeof(T))
+    {
+        return false;
+    }
+    tileBytes *= sizeof(T);
+    size_t grid = static_cast<size_t>(gridRows) * static_cast<size_t>(gridCols);
+    if (grid > (sizeMax - TILED_MATRIX_HEADER_SIZE) / tileBytes)
+    {
+        return false;
+    }
+    size = TILED_MATRIX_HEADER_SIZE + grid * tileBytes;
+    return true;
+}
+
+// ------------------------------ class TiledMatrix -----------------------------
+
+/**
+ * maps an open file descriptor (closes it)
+ */
+template<typename T>
+void BasicTiledMatrix<T>::_map_file(int fd, size_t size, bool writable)
+{
+    _mapSize = size;
+    _writable = writable;
+    _map = mmap(nullptr, _mapSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (_map == MAP_FAILED)
+    {
+        matrixError<std::runtime_error>(CANNOT_OPEN_FILE);
+    }
+    // tiles are visited out of file order - no read ahead along the file, prefetchTile asks instead
+    madvise(_map, _mapSize, MADV_RANDOM);
+}
+
+/**
+ * Constructor
+ * creates the file and maps it read-write.
+ * @param path
+ * @param rows
+ * @param cols
+ * @param tileRows
+ * @param tileCols
+ */
+template<typename T>
+BasicTiledMatrix<T>::BasicTiledMatrix(const std::string &path, int rows, int cols, int tileRows, int tileCols) :
+        _map(nullptr), _mapSize(0), _rows(rows), _cols(cols), _tileRows(tileRows), _tileCols(tileCols),
+        _writable(true)
+{
+    size_t size = 0;
+    if (rows <= 0 || cols <= 0 || tileRows <= 0 || tileCols <= 0 ||
+        !tiledFileSize<T>(rows, cols, tileRows, tileCols, size))
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        matrixError<std::runtime_error>(CANNOT_OPEN_FILE);
+    }
+    TiledMatrixHeader header{};
+    std::memcpy(header.magic, TILED_MATRIX_MAGIC, sizeof(header.magic));
+    header.type = tiledTypeCode<T>();
+    header.rows = rows;
+    header.cols = cols;
+    header.tileRows = tileRows;
+    header.tileCols = tileCols;
+    // ftruncate makes a sparse file of zeros, only the header is written now
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0 || pwrite(fd, &header, sizeof(header), 0) != sizeof(header))
+    {
+        close(fd);
+        matrixError<std::runtime_error>(CANNOT_OPEN_FILE);
+    }
+    _map_file(fd, size, true);
+}
+
+/**
+ * Constructor
+ * maps an existing file and validates its header.
+ * @param path
+ * @param mode
+ */
+template<typename T>
+BasicTiledMatrix<T>::BasicTiledMatrix(const std::string &path, MappingMode mode) :
+        _map(nullptr), _mapSize(0), _rows(0), _cols(0), _tileRows(0), _tileCols(0), _writable(false)
+{
+    bool writable = mode == MappingMode::ReadWrite;
+    int fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+    {
+        matrixError<std::runtime_error>(CANNOT_OPEN_FILE);
+    }
+    struct stat info;
+    TiledMatrixHeader header{};
+    if (fstat(fd, &info) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header))
+    {
+        close(fd);
+        matrixError<std::runtime_error>(INVALID_MATRIX_FILE);
+    }
+    size_t size = 0;
+    bool valid = std::memcmp(header.magic, TILED_MATRIX_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.type == tiledTypeCode<T>() && header.rows > 0 && header.cols > 0 &&
+                 header.tileRows > 0 && header.tileCols > 0 &&
+                 tiledFileSize<T>(header.rows, header.cols, header.tileRows, header.tileCols, size) &&
+                 static_cast<size_t>(info.st_size) >= size;
+    if (!valid)
+    {
+        close(fd);
+        matrixError<std::runtime_error>(INVALID_MATRIX_FILE);
+    }
+    _rows = header.rows;
+    _cols = header.cols;
+    _tileRows = header.tileRows;
+    _tileCols = header.tileCols;
+    _map_file(fd, size, writable);
+}
+
+/**
+ * Destructor
+ * unmaps the file
+ */
+template<typename T>
+BasicTiledMatrix<T>::~BasicTiledMatrix()
+{
+    munmap(_map, _mapSize);
+}
+
+/**
+ * @return amount of rows
+ */
+template<typename T>
+int BasicTiledMatrix<T>::getRows() const
+{
+    return _rows;
+}
+
+/**
+ * @return amount of cols
+ */
+template<typename T>
+int BasicTiledMatrix<T>::getCols() const
+{
+    return _cols;
+}
+
+/**
+ * @return rows of a (full) tile
+ */
+template<typename T>
+int BasicTiledMatrix<T>::getTileRows() const
+{
+    return _tileRows;
+}
+
+/**
+ * @return cols of a (full) tile
+ */
+template<typename T>
+int BasicTiledMatrix<T>::getTileCols() const
+{
+    return _tileCols;
+}
+
+/**
+ * @return number of tile rows in the grid
+ */
+template<typename T>
+int BasicTiledMatrix<T>::gridRows() const
+{
+    return (_rows - 1) / _tileRows + 1;
+}
+
+/**
+ * @return number of tile cols in the grid
+ */
+template<typename T>
+int BasicTiledMatrix<T>::gridCols() const
+{
+    return (_cols - 1) / _tileCols + 1;
+}
+
+/**
+ * first element of tile (ti, tj)
+ */
+template<typename T>
+T *BasicTiledMatrix<T>::_tileData(int ti, int tj) const
+{
+    if (ti < 0 || tj < 0 || ti >= gridRows() || tj >= gridCols())
+    {
+        matrixError<std::out_of_range>(TILE_OUT_OF_RANGE);
+    }
+    size_t index = static_cast<size_t>(ti) * gridCols() + tj;
+    char *tiles = static_cast<char *>(_map) + TILED_MATRIX_HEADER_SIZE;
+    return reinterpret_cast<T *>(tiles + index * _tileRows * _tileCols * sizeof(T));
+}
+
+/**
+ * madvise over the pages of tile (ti, tj)
+ */
+template<typename T>
+void BasicTiledMatrix<T>::_adviseTile(int ti, int tj, int advice) const
+{
+    static const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(_tileData(ti, tj));
+    uintptr_t end = begin + static_cast<size_t>(_tileRows) * _tileCols * sizeof(T);
+    // madvise takes page aligned ranges; DONTNEED only drops pages fully inside the tile
+    if (advice == MADV_DONTNEED)
+    {
+        begin = (begin + page - 1) & ~(page - 1);
+        end &= ~(page - 1);
+    }
+    else
+    {
+        begin &= ~(page - 1);
+    }
+    if (end > begin)
+    {
+        madvise(reinterpret_cast<void *>(begin), end - begin, advice);
+    }
+}
+
+/**
+ * writable view of tile (ti, tj)
+ * @param ti
+ * @param tj
+ * @return
+ */
+template<typename T>
+typename BasicTiledMatrix<T>::View BasicTiledMatrix<T>::tile(int ti, int tj)
+{
+    if (!_writable)
+    {
+        matrixError<std::runtime_error>(READ_ONLY_MAPPING);
+    }
+    T *data = _tileData(ti, tj);
+    int rows = std::min(_tileRows, _rows - ti * _tileRows);
+    int cols = std::min(_tileCols, _cols - tj * _tileCols);
+    return View(data, rows, cols, _tileCols);
+}
+
+/**
+ * read only view of tile (ti, tj)
+ * @param ti
+ * @param tj
+ * @return
+ */
+template<typename T>
+typename BasicTiledMatrix<T>::ConstView BasicTiledMatrix<T>::tile(int ti, int tj) const
+{
+    const T *data = _tileData(ti, tj);
+    int rows = std::min(_tileRows, _rows - ti * _tileRows);
+    int cols = std::min(_tileCols, _cols - tj * _tileCols);
+    return ConstView(data, rows, cols, _tileCols);
+}
+
+/**
+ * read ahead of tile (ti, tj)
+ * @param ti
+ * @param tj
+ */
+template<typename T>
+void BasicTiledMatrix<T>::prefetchTile(int ti, int tj) const
+{
+    _adviseTile(ti, tj, MADV_WILLNEED);
+}
+
+/**
+ * drops the pages of tile (ti, tj) from this process
+ * @param ti
+ * @param tj
+ */
+template<typename T>
+void BasicTiledMatrix<T>::evictTile(int ti, int tj) const
+{
+    _adviseTile(ti, tj, MADV_DONTNEED);
+}
+
+/**
+ * writes the changed tiles back to the file
+ */
+template<typename T>
+void BasicTiledMatrix<T>::flush()
+{
+    if (_writable && msync(_map, _mapSize, MS_SYNC) != 0)
+    {
+        matrixError<std::runtime_error>(CANNOT_OPEN_FILE);
+    }
+}
+
+/**
+ * copies a dense matrix (or view) into the tiles
+ * @param src
+ */
+template<typename T>
+void BasicTiledMatrix<T>::load(const BasicMatrixView<const T> &src)
+{
+    if (src.getRows() != _rows || src.getCols() != _cols)
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    for (int ti = 0; ti < gridRows(); ++ti)
+    {
+        for (int tj = 0; tj < gridCols(); ++tj)
+        {
+            View dst = tile(ti, tj);
+            dst.copyFrom(src.block(ti * _tileRows, tj * _tileCols, dst.getRows(), dst.getCols()));
+        }
+    }
+}
+
+/**
+ * @return the whole matrix as a dense Matrix
+ */
+template<typename T>
+BasicMatrix<T> BasicTiledMatrix<T>::toMatrix() const
+{
+    BasicMatrix<T> res(_rows, _cols, MatrixInit::Uninitialized);
+    for (int ti = 0; ti < gridRows(); ++ti)
+    {
+        for (int tj = 0; tj < gridCols(); ++tj)
+        {
+            ConstView src = tile(ti, tj);
+            res.view().block(ti * _tileRows, tj * _tileCols, src.getRows(), src.getCols()).copyFrom(src);
+        }
+    }
+    return res;
+}
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * true if a and b have the same shape and tiles
+ */
+template<typename T>
+static bool sameLayout(const BasicTiledMatrix<T> &a, const BasicTiledMatrix<T> &b)
+{
+    return a.getRows() == b.getRows() && a.getCols() == b.getCols() && a.getTileRows() == b.getTileRows() &&
+           a.getTileCols() == b.getTileCols();
+}
+
+/**
+ * out of core multiplication: c = a * b
+ * @param a
+ * @param b
+ * @param c
+ * @param threads
+ */
+template<typename T>
+void multiply(const BasicTiledMatrix<T> &a, const BasicTiledMatrix<T> &b, BasicTiledMatrix<T> &c, int threads)
+{
+    if (a.getCols() != b.getRows() || c.getRows() != a.getRows() || c.getCols() != b.getCols() ||
+        a.getTileCols() != b.getTileRows() || c.getTileRows() != a.getTileRows() ||
+        c.getTileCols() != b.getTileCols())
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    // an output tile is cleared before the input tiles of its row and column are read
+    if (&c == &a || &c == &b)
+    {
+        matrixError<std::invalid_argument>(TILED_MATRIX_ALIASED);
+    }
+    int gridCols = c.gridCols();
+    int tiles = c.gridRows() * gridCols;
+    int steps = a.gridCols();
+    // every output tile costs tileRows * tileCols * a.cols multiply-adds
+    long work = static_cast<long>(c.getRows()) * c.getCols() * a.getCols();
+    parallelFor(0, tiles, resolveThreadCount(threads, work), [&](int begin, int end)
+    {
+        for (int t = begin; t < end; ++t)
+        {
+            int ti = t / gridCols, tj = t % gridCols;
+            typename BasicTiledMatrix<T>::View out = c.tile(ti, tj);
+            for (int i = 0; i < out.getRows(); ++i)
+            {
+                std::fill(out.row_ptr(i), out.row_ptr(i) + out.getCols(), T(0));
+            }
+            a.prefetchTile(ti, 0);
+            b.prefetchTile(0, tj);
+            for (int k = 0; k < steps; ++k)
+            {
+                if (k + 1 < steps)
+                {
+                    a.prefetchTile(ti, k + 1);
+                    b.prefetchTile(k + 1, tj);
+                }
+                typename BasicTiledMatrix<T>::ConstView at = a.tile(ti, k);
+                typename BasicTiledMatrix<T>::ConstView bt = b.tile(k, tj);
+                gemmAccumulate(out.getRows(), out.getCols(), at.getCols(), at.data(), at.getStride(), bt.data(),
+                               bt.getStride(), out.data(), out.getStride());
+            }
+            // tiles of b are read again by the next output tile of this row - only the result leaves
+            c.evictTile(ti, tj);
+        }
+    });
+}
+
+/**
+ * element-wise pass over the tiles of c, op(out, tile of a, tile of b)
+ */
+template<typename T, typename Op>
+static void tileWise(const BasicTiledMatrix<T> &a, const BasicTiledMatrix<T> &b, BasicTiledMatrix<T> &c,
+                     int threads, Op op)
+{
+    if (!sameLayout(a, c) || !sameLayout(b, c))
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    int gridCols = c.gridCols();
+    int tiles = c.gridRows() * gridCols;
+    long work = static_cast<long>(c.getRows()) * c.getCols();
+    parallelFor(0, tiles, resolveThreadCount(threads, work), [&](int begin, int end)
+    {
+        for (int t = begin; t < end; ++t)
+        {
+            int ti = t / gridCols, tj = t % gridCols;
+            if (t + 1 < end)
+            {
+                a.prefetchTile((t + 1) / gridCols, (t + 1) % gridCols);
+                b.prefetchTile((t + 1) / gridCols, (t + 1) % gridCols);
+            }
+            typename BasicTiledMatrix<T>::View out = c.tile(ti, tj);
+            op(out, a.tile(ti, tj), b.tile(ti, tj));
+            a.evictTile(ti, tj);
+            b.evictTile(ti, tj);
+            c.evictTile(ti, tj);
+        }
+    });
+}
+
+/**
+ * out of core addition: c = a + b
+ * @param a
+ * @param b
+ * @param c
+ * @param threads
+ */
+template<typename T>
+void add(const BasicTiledMatrix<T> &a, const BasicTiledMatrix<T> &b, BasicTiledMatrix<T> &c, int threads)
+{
+    typedef typename BasicTiledMatrix<T>::View View;
+    typedef typename BasicTiledMatrix<T>::ConstView ConstView;
+    tileWise(a, b, c, threads, [](const View &out, const ConstView &x, const ConstView &y)
+    {
+        addKernel(out.getRows(), out.getCols(), x.data(), x.getStride(), y.data(), y.getStride(), out.data(),
+                  out.getStride(), false);
+    });
+}
+
+/**
+ * out of core scalar multiplication: c = a * s
+ * @param a
+ * @param s
+ * @param c
+ * @param threads
+ */
+template<typename T>
+void scale(const BasicTiledMatrix<T> &a, T s, BasicTiledMatrix<T> &c, int threads)
+{
+    typedef typename BasicTiledMatrix<T>::View View;
+    typedef typename BasicTiledMatrix<T>::ConstView ConstView;
+    tileWise(a, a, c, threads, [s](const View &out, const ConstView &x, const ConstView &)
+    {
+        for (int i = 0; i < out.getRows(); ++i)
+        {
+            const T *src = x.row_ptr(i);
+            T *dst = out.row_ptr(i);
+            for (int j = 0; j < out.getCols(); ++j)
+            {
+                dst[j] = src[j] * s;
+            }
+        }
+    });
+}
+
+/**
+ * out of core convolution
+ * @param image
+ * @param kernel
+ * @param res
+ * @param threads
+ */
+void convolution(const TiledMatrix &image, const ConstMatrixView &kernel, TiledMatrix &res, int threads)
+{
+    if (!sameLayout(image, res))
+    {
+        matrixError<std::invalid_argument>(INVALID_MAT_DIMENSIONS);
+    }
+    if (&image == &res)
+    {
+        matrixError<std::invalid_argument>(TILED_MATRIX_ALIASED);
+    }
+    // a pixel reads rows r - (kr - 1 - kr / 2) ... r + kr / 2 (same for cols)
+    int haloTop = kernel.getRows() - 1 - kernel.getRows() / 2, haloBottom = kernel.getRows() / 2;
+    int haloLeft = kernel.getCols() - 1 - kernel.getCols() / 2, haloRight = kernel.getCols() / 2;
+    int tileRows = image.getTileRows(), tileCols = image.getTileCols();
+    int gridCols = image.gridCols();
+    int tiles = image.gridRows() * gridCols;
+    long work = static_cast<long>(image.getRows()) * image.getCols() * kernel.getRows() * kernel.getCols();
+    // the threads go to the tiles first; a tile's convolution only gets the ones left over (the FFT
+    // path of large kernels is threaded too - tile workers must not each start a full set)
+    threads = resolveThreadCount(threads, work);
+    int tileThreads = std::min(threads, tiles);
+    int innerThreads = std::max(1, threads / tileThreads);
+    parallelFor(0, tiles, tileThreads, [&](int begin, int end)
+    {
+        // the tile and its halo, clipped to the image - pixels at the image border then see
+        // exactly what the in memory convolution sees, inner ones get their neighbours
+        Matrix region(tileRows + haloTop + haloBottom, tileCols + haloLeft + haloRight, MatrixInit::Uninitialized);
+        for (int t = begin; t < end; ++t)
+        {
+            int ti = t / gridCols, tj = t % gridCols;
+            int top = std::max(0, ti * tileRows - haloTop);
+            int bottom = std::min(image.getRows(), (ti + 1) * tileRows + haloBottom);
+            int left = std::max(0, tj * tileCols - haloLeft);
+            int right = std::min(image.getCols(), (tj + 1) * tileCols + haloRight);
+            MatrixView gathered = region.view().block(0, 0, bottom - top, right - left);
+            // copy the overlapping part of every tile the region touches
+            for (int si = top / tileRows; si <= (bottom - 1) / tileRows; ++si)
+            {
+                for (int sj = left / tileCols; sj <= (right - 1) / tileCols; ++sj)
+                {
+                    ConstMatrixView src = image.tile(si, sj);
+                    int r0 = std::max(top, si * tileRows), r1 = std::min(bottom, si * tileRows + src.getRows());
+                    int c0 = std::max(left, sj * tileCols), c1 = std::min(right, sj * tileCols + src.getCols());
+                    gathered.block(r0 - top, c0 - left, r1 - r0, c1 - c0).copyFrom(
+                            src.block(r0 - si * tileRows, c0 - sj * tileCols, r1 - r0, c1 - c0));
+                }
+            }
+            if (t + 1 < end)
+            {
+                image.prefetchTile((t + 1) / gridCols, (t + 1) % gridCols);
+            }
+            Matrix filtered = convolution(ConstMatrixView(gathered), kernel, BorderMode::Zero, innerThreads);
+            MatrixView out = res.tile(ti, tj);
+            out.copyFrom(filtered.view().block(ti * tileRows - top, tj * tileCols - left, out.getRows(),
+                                             out.getCols()));
+            res.evictTile(ti, tj);
+        }
+    });
+}
+
+// ------------------------------ instantiations -----------------------------
+
+/**
+ * instantiates the tiled matrix for one element type
+ */
+#define INSTANTIATE_TILED_MATRIX(T) \
+    template class BasicTiledMatrix<T>; \
+    template void multiply(const BasicTiledMatrix<T> &a, const BasicTiledMatrix<T> &b, BasicTiledMatrix<T> &c, \
+                           int threads); \
+    template void add(const BasicTiledMatrix<T> &a, const BasicTiledMatrix<T> &b, BasicTiledMatrix<T> &c, \
+                      int threads); \
+    template void scale(const BasicTiledMatrix<T> &a, T s, BasicTiledMatrix<T> &c, int threads);
+
+INSTANTIATE_TILED_MATRIX(float)
+INSTANTIATE_TILED_MATRIX(double)
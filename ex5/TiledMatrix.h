@@ -0,0 +1,283 @@
+
+
+#ifndef EX5_TILEDMATRIX_H
+
+// ------------------------------ includes ------------------------------
+
+#include <string>
+#include <cstddef>
+#include "Matrix.h"
+
+// ------------------------------ const & macros -----------------------------
+
+#define EX5_TILEDMATRIX_H
+/**
+ * default tile edge - a 256 x 256 float tile is 256KB, fits L2 and is a whole number of pages
+ */
+#define TILED_MATRIX_TILE 256
+/**
+ * bytes before the first tile (header, padded so tiles start on a page boundary)
+ */
+#define TILED_MATRIX_HEADER_SIZE 4096
+/**
+ * error - multiply() and convolution() read other tiles than the one they write, so the result
+ * can not be an input
+ */
+#define TILED_MATRIX_ALIASED "Result tiled matrix is also an input.\n"
+
+// ------------------------------ class TiledMatrix -----------------------------
+
+/**
+ * how a tiled matrix file is mapped
+ */
+enum class MappingMode
+{
+    /**
+     * tiles are read only
+     */
+    ReadOnly,
+    /**
+     * tiles can be written, changes go back to the file
+     */
+    ReadWrite
+};
+
+/**
+ *  out of core matrix: a file, memory mapped, holding the matrix as a grid of tiles.
+ *  the file is
+ *   [ header - "EX5T", element type, rows, cols, tile rows, tile cols, padded to
+ *     TILED_MATRIX_HEADER_SIZE ] then the tiles, grid row by grid row, every tile a contiguous
+ *     tileRows x tileCols row major block (edge tiles are stored full size, the extra part unused).
+ *  numbers are in native byte order since the tiles are used in place.
+ *  only the pages of the tiles being worked on need to be in memory, so matrices far larger than
+ *  RAM can be processed: every tile is an ordinary (strided) view, and the operations below walk
+ *  the tiles in order, asking the kernel to read the next tiles ahead (madvise WILLNEED) and to drop
+ *  the finished ones (DONTNEED). the mapping itself is MADV_RANDOM, so the kernel does not read
+ *  ahead along the file, which for tiles would mostly be the wrong data.
+ *  T is float or double.
+ */
+template<typename T>
+class BasicTiledMatrix
+{
+public:
+    /**
+     * type of a single element
+     */
+    typedef T ElementType;
+    /**
+     * writable view of a tile
+     */
+    typedef BasicMatrixView<T> View;
+    /**
+     * read only view of a tile
+     */
+    typedef BasicMatrixView<const T> ConstView;
+
+private:
+
+    void *_map;
+    size_t _mapSize;
+    int _rows, _cols;
+    int _tileRows, _tileCols;
+    bool _writable;
+
+    /**
+     * maps an open file descriptor (closes it)
+     */
+    void _map_file(int fd, size_t size, bool writable);
+
+    /**
+     * first element of tile (ti, tj)
+     */
+    T *_tileData(int ti, int tj) const;
+
+    /**
+     * byte range of tile (ti, tj) for madvise
+     */
+    void _adviseTile(int ti, int tj, int advice) const;
+
+public:
+    /**
+     * Constructor
+     * creates (or truncates) the file `path` holding a rows x cols matrix of zeros and maps it
+     * read-write. the file is sparse, so no disk space is used until tiles are written.
+     * @param path
+     * @param rows
+     * @param cols
+     * @param tileRows
+     * @param tileCols
+     */
+    BasicTiledMatrix(const std::string &path, int rows, int cols, int tileRows = TILED_MATRIX_TILE,
+                     int tileCols = TILED_MATRIX_TILE);
+
+    /**
+     * Constructor
+     * maps an existing tiled matrix file and validates its header.
+     * @param path
+     * @param mode
+     */
+    explicit BasicTiledMatrix(const std::string &path, MappingMode mode = MappingMode::ReadOnly);
+
+    /**
+     * Destructor
+     * unmaps the file (written tiles reach the file by the kernel's write back, or flush())
+     */
+    ~BasicTiledMatrix();
+
+    /**
+     * a mapping owns its pages, it can not be copied
+     */
+    BasicTiledMatrix(const BasicTiledMatrix &) = delete;
+
+    /**
+     * a mapping owns its pages, it can not be copied
+     */
+    BasicTiledMatrix &operator=(const BasicTiledMatrix &) = delete;
+
+    /**
+     * @return amount of rows
+     */
+    int getRows() const;
+
+    /**
+     * @return amount of cols
+     */
+    int getCols() const;
+
+    /**
+     * @return rows of a (full) tile
+     */
+    int getTileRows() const;
+
+    /**
+     * @return cols of a (full) tile
+     */
+    int getTileCols() const;
+
+    /**
+     * @return number of tile rows in the grid
+     */
+    int gridRows() const;
+
+    /**
+     * @return number of tile cols in the grid
+     */
+    int gridCols() const;
+
+    /**
+     * writable view of tile (ti, tj) - edge tiles are smaller. valid while this object lives.
+     * Check the indices and that the mapping is writable.
+     * @param ti
+     * @param tj
+     * @return
+     */
+    View tile(int ti, int tj);
+
+    /**
+     * read only view of tile (ti, tj)
+     * @param ti
+     * @param tj
+     * @return
+     */
+    ConstView tile(int ti, int tj) const;
+
+    /**
+     * asks the kernel to start reading tile (ti, tj) in the background (MADV_WILLNEED)
+     * @param ti
+     * @param tj
+     */
+    void prefetchTile(int ti, int tj) const;
+
+    /**
+     * tells the kernel tile (ti, tj) is not needed for now (MADV_DONTNEED): its pages leave this
+     * process (written data stays in the page cache and is written back to the file)
+     * @param ti
+     * @param tj
+     */
+    void evictTile(int ti, int tj) const;
+
+    /**
+     * writes the changed tiles back to the file and waits for it
+     */
+    void flush();
+
+    /**
+     * copies a dense matrix (or view) into the tiles, tile by tile
+     * Check dimensions valid for operation.
+     * @param src
+     */
+    void load(const BasicMatrixView<const T> &src);
+
+    /**
+     * @return the whole matrix as a dense in memory Matrix (for matrices that fit)
+     */
+    BasicMatrix<T> toMatrix() const;
+};
+
+/**
+ * tiled float matrix
+ */
+typedef BasicTiledMatrix<float> TiledMatrix;
+
+/**
+ * tiled double matrix
+ */
+typedef BasicTiledMatrix<double> DoubleTiledMatrix;
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * out of core multiplication: c = a * b.
+ * c is produced one tile at a time: the tile is cleared, then a(ti, k) * b(k, tj) is accumulated
+ * for every k with the blocked kernel while the next pair of tiles is prefetched; the finished tile
+ * is evicted. output tiles are split between threads.
+ * Check dimensions valid for operation: a.cols == b.rows, c is a.rows x b.cols, and the tiles line
+ * up (a.tileCols == b.tileRows, c has a.tileRows x b.tileCols tiles).
+ * c must be a different file than a and b: throws std::invalid_argument if it is the same object
+ * (a second mapping of the same file is not detected).
+ * @param a
+ * @param b
+ * @param c writable
+ * @param threads 0 - defaultThreadCount()
+ */
+template<typename T>
+void multiply(const BasicTiledMatrix<T> &a, const BasicTiledMatrix<T> &b, BasicTiledMatrix<T> &c, int threads = 0);
+
+/**
+ * out of core addition: c = a + b, tile by tile.
+ * Check dimensions valid for operation (same shape and tiles).
+ * @param a
+ * @param b
+ * @param c writable, may be a or b
+ * @param threads 0 - defaultThreadCount()
+ */
+template<typename T>
+void add(const BasicTiledMatrix<T> &a, const BasicTiledMatrix<T> &b, BasicTiledMatrix<T> &c, int threads = 0);
+
+/**
+ * out of core scalar multiplication: c = a * s, tile by tile.
+ * @param a
+ * @param s
+ * @param c writable, may be a
+ * @param threads 0 - defaultThreadCount()
+ */
+template<typename T>
+void scale(const BasicTiledMatrix<T> &a, T s, BasicTiledMatrix<T> &c, int threads = 0);
+
+/**
+ * out of core convolution (same result as convolution() in Filters.h on the whole image).
+ * every output tile is computed from its input tile plus a halo of kernel radius taken from the
+ * neighbouring tiles (however many the halo reaches). tiles are split between threads; a large
+ * kernel's FFT only gets the threads left over, so the total stays at threads.
+ * Check dimensions valid for operation (same shape and tiles).
+ * res must be a different file than image (a tile's halo is read from neighbours another thread
+ * may already have written): throws std::invalid_argument if it is the same object (a second
+ * mapping of the same file is not detected).
+ * @param image
+ * @param kernel
+ * @param res writable
+ * @param threads 0 - defaultThreadCount()
+ */
+void convolution(const TiledMatrix &image, const ConstMatrixView &kernel, TiledMatrix &res, int threads = 0);
+
+#endif //EX5_TILEDMATRIX_H